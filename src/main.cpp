@@ -1,1748 +1,10757 @@
-#include <sys/time.h>
-#include <sys/stat.h>
-#include <unistd.h>
-#include <errno.h>
-#include <cstdlib>
-#include <cstdio>
-#include <vector>
-#include <string>
-#include <algorithm>
-#include <sstream>
-#include <iostream>
-#include <fstream>
-#include <cmath>
-#include <GL/gl.h>
-#include <GL/glu.h>
-#include <SDL/SDL.h>
-#include <SDL/SDL_thread.h>
-#include <jack/jack.h>
-#include <flux.h>
-
-using namespace std;
-
-double gTime, startTime;
-
-
-double getTime()
-{
-	timeval tv;
-	gettimeofday(&tv, 0);
-	return tv.tv_sec + tv.tv_usec*0.000001;
-}
-
-
-inline bool checkglerror(bool fatal= false)
-{
-    int err= glGetError();
-    if(err)
-    {
-    	printf("GL Error: %s\n", gluErrorString(err));
-        if(fatal) abort();
-        else return false;
-    }
-    return true;
-}
-
-
-bool setVideoMode(int w, int h)
-{
-	SDL_Init(SDL_INIT_VIDEO);
-	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
-	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0);
-	SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, 0);
-	if(!SDL_SetVideoMode(w, h, 0, SDL_OPENGL|SDL_RESIZABLE))
-    {
-        printf("SDL_SetVideoMode failed: %s\n", SDL_GetError());
-        return false;
-    }
-	int doubleBuf, depthSize, swapControl;
-	SDL_GL_GetAttribute(SDL_GL_DOUBLEBUFFER, &doubleBuf);
-	SDL_GL_GetAttribute(SDL_GL_DEPTH_SIZE, &depthSize);
-	SDL_GL_GetAttribute(SDL_GL_SWAP_CONTROL, &swapControl);
-	SDL_WM_SetCaption("Scope", 0);
-	SDL_ShowCursor(false);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-    glOrtho(0, w, h, 0, -1000, 1000);
-    glViewport(0,0, w,h);
-	glDisable(GL_DITHER);
-	flux_screenresize(w, h);
-	return true;
-}
-
-
-void flux_tick()
-{
-	aq_exec();
-	run_timers();
-
-	redraw_rect(&viewport);
-	redraw_cursor();
-
-	checkglerror();
-}
-
-int SDLMouseButtonToFluxMouseButton(int button)
-{
-	if(button>3) return button-1;
-	else return (button==1? 0: button==3? 1: 2);
-}
-
-class SDLScopedLock
-{
-	public:
-		SDLScopedLock(SDL_mutex *m): myMutex(m)
-		{
-			SDL_LockMutex(myMutex);
-		}
-
-		~SDLScopedLock()
-		{
-			SDL_UnlockMutex(myMutex);
-		}
-
-	private:
-		SDL_mutex *myMutex;
-};
-
-enum SDLUserEvent
-{
-	SDL_USER_ADDJACKBUFFER= 0,
-};
-
-
-class configHandler
-{
-	private:
-		vector<class configOptionHandler *> configOptionHandlers;
-
-	public:
-		void addConfigOptionHandler(class configOptionHandler *cs)
-		{ configOptionHandlers.push_back(cs); }
-
-		void removeConfigOptionHandler(class configOptionHandler *cs)
-		{
-			vector<class configOptionHandler*>::iterator it=
-				find(configOptionHandlers.begin(), configOptionHandlers.end(), cs);
-			if(it!=configOptionHandlers.end()) configOptionHandlers.erase(it);
-		}
-
-		bool writeToFile(const char *filename);
-		bool readFromFile(const char *filename);
-};
-
-configHandler gConfigHandler;
-
-class configOptionHandler
-{
-	private:
-		enum optionType
-		{
-			OT_FLOAT= 0,
-			OT_BOOL
-		};
-		struct configOption
-		{
-			optionType type;
-			std::string name;
-			void *address;
-
-			std::string getString()
-			{
-				std::ostringstream s;
-				switch(type)
-				{
-					case OT_FLOAT:
-						s << *(float*)address;
-						return s.str();
-					case OT_BOOL:
-						s << *(bool*)address;
-						return s.str();
-					default:
-						return std::string("unknown option type!");
-				}
-			}
-
-			void putString(const std::string &str)
-			{
-				std::istringstream s(str);
-				switch(type)
-				{
-					case OT_FLOAT:
-						s >> *(float*)address;
-						break;
-					case OT_BOOL:
-						s >> *(bool*)address;
-						break;
-					default:
-						puts("unknown option type!");
-				}
-			}
-		};
-		vector<configOption> configOptions;
-		std::string name;
-
-		void addConfigOption(const char *name, optionType type, void *address)
-		{ configOptions.push_back( (configOption) { type, std::string(name), address } ); }
-
-	protected:
-		configOptionHandler(const char *_name):
-			name(_name)
-		{ gConfigHandler.addConfigOptionHandler(this); }
-
-		virtual ~configOptionHandler()
-		{ gConfigHandler.removeConfigOptionHandler(this); }
-
-		void addConfigOption(const char *name, float *address)
-		{ addConfigOption(name, OT_FLOAT, address); }
-
-		void addConfigOption(const char *name, bool *address)
-		{ addConfigOption(name, OT_BOOL, address); }
-
-		#define ADD_CONFIG_OPTION(var) addConfigOption(#var, &var)
-
-	public:
-		const std::string &getName()
-		{ return name; }
-
-		std::string writeToString()
-		{
-			std::string ret;
-			for(vector<configOption>::iterator i= configOptions.begin(); i!=configOptions.end(); i++)
-				ret.append(name + "." + i->name + "=" + i->getString() + "\n");
-			return ret;
-		}
-
-		bool writeToFile(const char *filename)
-		{
-			FILE *f= fopen(filename, "a");
-			if(!f) return false;
-			std::string s= writeToString();
-			if(fwrite(s.c_str(), 1, s.length(), f)!=s.length())
-			{ fclose(f); return false; }
-			fclose(f);
-			return true;
-		}
-
-		bool readItem(const char *itemName, const char *itemValue)
-		{
-			for(vector<configOption>::iterator i= configOptions.begin(); i!=configOptions.end(); i++)
-			{
-				if(i->name==itemName)
-				{
-					i->putString(itemValue);
-					return true;
-				}
-			}
-			return false;
-		}
-
-		static bool parseLine(char *line, char *&name, char *&itemName, char *&itemValue)
-		{
-			name= line;
-			while(isspace(*name)) name++;
-			char *s= name; while(*s && !isspace(*s) && *s!='.') s++;
-			if(!*s) { *name= 0; itemName= itemValue= name; return true; }	// empty line
-			*s++= 0; while(*s && isspace(*s)) s++;
-			if(!*s) return false;
-			itemName= s;
-			while(*s && !isspace(*s) && *s!='=') s++;
-			if(!*s) return false;
-			*s++= 0; while(*s && isspace(*s)) s++;
-			if(!*s) return false;
-			itemValue= s;
-			return true;
-		}
-
-		bool readFromString(std::string src)
-		{
-			char line[1024];
-			int i= 1;
-			for(std::stringstream stream(src); !stream.eof(); i++)
-			{
-				stream.getline(line, sizeof(line));
-				char *name, *itemName, *itemValue;
-				if(!parseLine(line, name, itemName, itemValue))
-					printf("parse error at line %d\n", i);
-				else if(name==this->name)
-					readItem(itemName, itemValue);
-			}
-			return true;
-		}
-
-		bool readFromFile(const char *filename)
-		{
-			ifstream f;
-			f.open(filename, ios_base::in);
-			if(f.fail()) return false;
-			stringbuf sbuf;
-			f.get(sbuf, 0);
-			string str;
-			readFromString(sbuf.str());
-			return true;
-		}
-};
-
-
-bool configHandler::writeToFile(const char *filename)
-{
-	bool ok= true;
-	for(vector<configOptionHandler*>::iterator it= configOptionHandlers.begin(); it!=configOptionHandlers.end(); it++)
-		if(!(*it)->writeToFile(filename)) ok= false;
-	return ok;
-}
-
-bool configHandler::readFromFile(const char *filename)
-{
-	char *name, *itemName, *itemValue;
-	std::string lastName;
-	configOptionHandler *handler= 0;
-	char line[1024];
-
-	ifstream f;
-	f.open(filename, ios_base::in);
-	if(f.fail()) return false;
-	while(!f.eof())
-	{
-		f.getline(line, 1024);
-		if(f.fail() && !f.eof()) return false;
-		if(configOptionHandler::parseLine(line, name, itemName, itemValue))
-		{
-			if(lastName!=name)
-			{
-				handler= 0;
-				for(uint32_t i= 0; i<configOptionHandlers.size(); i++)
-				{
-					if(configOptionHandlers[i]->getName()==name)
-					{
-						handler= configOptionHandlers[i];
-						lastName= name;
-						break;
-					}
-				}
-				if(!handler) continue;
-			}
-			if(handler)
-                handler->readItem(itemName, itemValue);
-            else
-                printf("configOptionHandler for %s not found\n", name);
-		}
-		else printf("bad config line\n");
-	}
-	return true;
-}
-
-// event data structure which is passed from the jack realtime thread to the main thread
-struct JackBufferData
-{
-	jack_default_audio_sample_t **data;
-	int nFrames;
-	int nChannels;
-
-	JackBufferData(int nChannels, int nFrames)
-	{
-		data= new jack_default_audio_sample_t* [nChannels];
-		for(int i= 0; i<nChannels; i++)
-			data[i]= new jack_default_audio_sample_t[nFrames];
-		this->nChannels= nChannels;
-		this->nFrames= nFrames;
-	}
-	~JackBufferData()
-	{
-		for(int i= 0; i<nChannels; i++)
-			delete[] data[i];
-		delete[] data;
-	}
-};
-
-// interface to jack audio
-class JackInterface
-{
-	public:
-		JackInterface(): client(0), eventData(0), running(false)
-		{
-		}
-
-		~JackInterface()
-		{
-			if(running) jack_client_close(client);
-			if(eventData) delete(eventData);
-		}
-
-		bool initialize(int nChannels)
-		{
-			const char *client_name = "fluxscope";
-			const char *server_name = NULL;
-			jack_options_t options = JackNoStartServer;
-			jack_status_t status;
-
-			client= jack_client_open (client_name, options, &status, server_name);
-			if (client == NULL) {
-				fprintf (stderr, "jack_client_open() failed, "
-					 "status = 0x%2.0x\n", status);
-				if (status & JackServerFailed) {
-					fprintf (stderr, "Unable to connect to JACK server\n");
-				}
-				return false;
-			}
-			if (status & JackServerStarted) {
-				fprintf (stderr, "JACK server started\n");
-			}
-			if (status & JackNameNotUnique) {
-				client_name = jack_get_client_name(client);
-				fprintf (stderr, "unique name `%s' assigned\n", client_name);
-			}
-
-			/* tell the JACK server to call `process()' whenever
-			   there is work to be done.
-			*/
-			jack_set_process_callback(client, jackProcess, this);
-
-			/* tell the JACK server to call `jack_shutdown()' if
-			   it ever shuts down, either entirely, or if it
-			   just decides to stop calling us.
-			*/
-			jack_on_info_shutdown (client, jackInfoShutdownCB, this);
-
-			/* display the current sample rate.
-			 */
-			printf("engine sample rate: %d\n", jack_get_sample_rate(client));
-
-			/* create ports */
-			inputPorts.reserve(nChannels);
-			for(int i= 0; i<nChannels; i++)
-			{
-				char portName[64];
-				snprintf(portName, 64, "input%02d", i);
-				jack_port_t *inputPort= jack_port_register (client, portName,
-															JACK_DEFAULT_AUDIO_TYPE,
-															JackPortIsInput, 0);
-				if ((inputPort == NULL)) {
-					fprintf(stderr, "no more JACK ports available\n");
-					return false;
-				}
-				inputPorts.push_back(inputPort);
-			}
-
-			// allocate event data structure
-			if(eventData) delete(eventData), eventData= 0;
-			eventData= new JackBufferData(nChannels, jack_get_buffer_size(client));
-
-			/* Tell the JACK server that we are ready to roll.  Our
-			 * process() callback will start running now. */
-			if (jack_activate (client)) {
-				fprintf (stderr, "cannot activate client");
-				return false;
-			}
-
-			return (running= true);
-		}
-
-		void shutdown()
-		{
-		    if(!running) return;
-		    jack_deactivate(client);
-		    jack_client_close(client);
-		    running= false;
-		}
-
-		int getSamplingRate()
-		{
-			if(running)
-				return jack_get_sample_rate(client);
-			else
-				return 48000;
-		}
-
-		bool isRunning()
-		{
-			return running;
-		}
-
-	private:
-		vector<jack_port_t *> inputPorts;
-		jack_client_t *client;
-		JackBufferData *eventData;
-		bool running;
-
-		int process(jack_nframes_t nframes)
-		{
-			for(uint32_t i= 0; i<inputPorts.size(); i++)
-			{
-				memcpy(eventData->data[i],
-					   jack_port_get_buffer(inputPorts[i], nframes),
-					   nframes*sizeof(jack_default_audio_sample_t));
-			}
-
-			SDL_UserEvent event;
-			event.type= SDL_USEREVENT;
-			event.code= SDL_USER_ADDJACKBUFFER;
-			event.data1= (void*)eventData;
-			SDL_PushEvent((SDL_Event*)&event);
-
-			return 0;
-		}
-
-		static int jackProcess(jack_nframes_t nframes, void *arg)
-		{
-			return reinterpret_cast<JackInterface*>(arg)->process(nframes);
-		}
-
-		void jackInfoShutdown(jack_status_t code, const char *reason)
-		{
-			printf("JACK shutdown: %s\n", reason);
-			running= false;
-		}
-
-		static void jackInfoShutdownCB(jack_status_t code, const char *reason, void *arg)
-		{
-			reinterpret_cast<JackInterface*>(arg)->jackInfoShutdown(code, reason);
-		}
-};
-
-
-class fluxWindowBase
-{
-	private:
-		static void basePaintCB(prop_t arg, struct primitive *self, rect *abspos, const rectlist *dirty_rects)
-		{
-			reinterpret_cast<fluxWindowBase*>(arg)->cbPaint(self, abspos, dirty_rects);
-		}
-
-		static int baseMouseCB(prop_t arg, struct primitive *self, int type, int x, int y, int btn)
-		{
-			reinterpret_cast<fluxWindowBase*>(arg)->cbMouse(self, type, x, y, btn);
-			return 1;
-		}
-
-	protected:
-		uint32_t fluxHandle;
-
-		enum
-		{
-//			CB_KEYBD_FLAG= (1<<CB_KEYBD),
-			CB_MOUSE_FLAG= (1<<primitive::CB_MOUSE),
-			CB_PAINT_FLAG= (1<<primitive::CB_PAINT),
-//			CB_PROPS_FLAG= (1<<CB_PROPS),
-//			CB_STATUS_FLAG= (1<<CB_STATUS)
-		};
-
-		fluxWindowBase(int x, int y, int w, int h, uint32_t callbackFlags, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP)
-		{
-			fluxHandle= create_rect(parent, x,y, w,h, COL_WINDOW, alignment);
-			if(callbackFlags&CB_PAINT_FLAG) wnd_set_paint_callback(fluxHandle, basePaintCB, reinterpret_cast<prop_t>(this));
-			if(callbackFlags&CB_MOUSE_FLAG) wnd_set_mouse_callback(fluxHandle, baseMouseCB, reinterpret_cast<prop_t>(this));
-			wnd_setresizable(fluxHandle, false);
-		}
-
-		virtual ~fluxWindowBase()
-		{
-			if(fluxHandle!=NOWND) wnd_destroy(fluxHandle);
-			fluxHandle= NOWND;
-		}
-
-		virtual void cbPaint(primitive *self, rect *abspos, const rectlist *dirty_rects) { }
-		virtual void cbMouse(primitive *self, int type, int x, int y, int btn) { }
-};
-
-
-
-class CFilterButterworth24db
-{
-public:
-    CFilterButterworth24db(void);
-    ~CFilterButterworth24db(void);
-    void SetSampleRate(float fs);
-    void Set(float cutoff, float q);
-    float Run(float input);
-
-private:
-    float t0, t1, t2, t3;
-    float coef0, coef1, coef2, coef3;
-    float history1, history2, history3, history4;
-    float gain;
-    float min_cutoff, max_cutoff;
-};
-
-// FilterButterworth24db.cpp
-
-#define BUDDA_Q_SCALE 1.f
-
-CFilterButterworth24db::CFilterButterworth24db(void)
-{
-    this->history1 = 0.f;
-    this->history2 = 0.f;
-    this->history3 = 0.f;
-    this->history4 = 0.f;
-
-    this->SetSampleRate(44100.f);
-    this->Set(22050.f, 0.0);
-}
-
-CFilterButterworth24db::~CFilterButterworth24db(void)
-{
-}
-
-void CFilterButterworth24db::SetSampleRate(float fs)
-{
-    float pi = 4.f * atanf(1.f);
-
-    this->t0 = 4.f * fs * fs;
-    this->t1 = 8.f * fs * fs;
-    this->t2 = 2.f * fs;
-    this->t3 = pi / fs;
-
-    this->min_cutoff = fs * 0.01f;
-    this->max_cutoff = fs * 0.45f;
-}
-
-void CFilterButterworth24db::Set(float cutoff, float q)
-{
-    if (cutoff < this->min_cutoff)
-        cutoff = this->min_cutoff;
-    else if(cutoff > this->max_cutoff)
-        cutoff = this->max_cutoff;
-
-    if(q < 0.f)
-        q = 0.f;
-    else if(q > 1.f)
-        q = 1.f;
-
-    float wp = this->t2 * tanf(this->t3 * cutoff);
-    float bd, bd_tmp, b1, b2;
-
-    q *= BUDDA_Q_SCALE;
-    q += 1.f;
-
-    b1 = (0.765367f / q) / wp;
-    b2 = 1.f / (wp * wp);
-
-    bd_tmp = this->t0 * b2 + 1.f;
-
-    bd = 1.f / (bd_tmp + this->t2 * b1);
-
-    this->gain = bd * 0.5f;
-
-    this->coef2 = (2.f - this->t1 * b2);
-
-    this->coef0 = this->coef2 * bd;
-    this->coef1 = (bd_tmp - this->t2 * b1) * bd;
-
-    b1 = (1.847759f / q) / wp;
-
-    bd = 1.f / (bd_tmp + this->t2 * b1);
-
-    this->gain *= bd;
-    this->coef2 *= bd;
-    this->coef3 = (bd_tmp - this->t2 * b1) * bd;
-}
-
-float CFilterButterworth24db::Run(float input)
-{
-    float output = input * this->gain;
-    float new_hist;
-
-    output -= this->history1 * this->coef0;
-    new_hist = output - this->history2 * this->coef1;
-
-    output = new_hist + this->history1 * 2.f;
-    output += this->history2;
-
-    this->history2 = this->history1;
-    this->history1 = new_hist;
-
-    output -= this->history3 * this->coef2;
-    new_hist = output - this->history4 * this->coef3;
-
-    output = new_hist + this->history3 * 2.f;
-    output += this->history4;
-
-    this->history4 = this->history3;
-    this->history3 = new_hist;
-
-    return output;
-}
-
-// something from http://www.musicdsp.org/showArchiveComment.php?ArchiveID=227
-class Butterworth
-{
-    public:
-        Butterworth():
-            State0(0), State1(0), State2(0), State3(0)
-        {
-            memset(this, 0, sizeof(*this));
-            setFrequency(5000, 44100);
-        }
-
-        void setFrequency(double Frequency, double Samplerate)
-        {
-            const double Q= 1.0;
-
-            // First calculate the prewarped digital frequency:
-            double K = tan(M_PI * Frequency / Samplerate);
-
-            // Now calc some intermediate variables: (see 'Factors of Polynoms' at http://en.wikipedia.org/wiki/Butterworth_filter, especially if you want a higher order like 48dB/Oct)
-            double a = 0.76536686473 * Q * K;
-            double b = 1.84775906502 * Q * K;
-
-            K = K*K;    // (to optimize it a little bit)
-
-            // Calculate the first biquad:
-
-            A0_I = 1.0/(K+a+1);
-            A1 = 2*(1-K);
-            A2 =(a-K-1);
-            B0 = K;
-            B1 = 2*B0;
-            B2 = B0;
-
-            // Calculate the second biquad:
-
-            A3_I = 1.0/(K+b+1);
-            A4 = 2*(1-K);
-            A5 = (b-K-1);
-            B3 = K;
-            B4 = 2*B3;
-            B5 = B3;
-        }
-
-        double run(double Input)
-        {
-            double Stage1 = B0*Input + State0;
-            State0 = B1*Input + A1*A0_I*Stage1 + State1;
-            State1 = B2*Input + A2*A0_I*Stage1;
-
-            double Output = B3*Stage1 + State2;
-            State2 = B4*Stage1 + A4*A3_I*Output + State3;
-            State3 = B5*Stage1 + A5*A3_I*Output;
-
-            return Output;
-        }
-
-    private:
-        double A0_I, A1, A2, A3_I, A4, A5,
-               B0, B1, B2, B3, B4, B5;
-        double State0, State1, State2, State3;
-};
-
-
-class PeakTracker
-{
-    public:
-        enum { MAXSAMPLES= 16 };
-
-        PeakTracker(): peak(0), peakFiltered(0), sampleIndex(0)
-        { memset(buf, 0, sizeof(buf)); setNumSamples(1); }
-
-        void setNumSamples(double n)
-        {
-            if(n>128) n= 128;
-            peakStep= 1.0/pow(n, 1.5);
-            peakStep2= 10*peakStep; if(peakStep2>1.0) peakStep2= 1.0;
-            n= (n>MAXSAMPLES-1? MAXSAMPLES-1: n<1? 1: n);
-            nSamples= n+0.5;
-        }
-
-        float run(float value)
-        {
-            buf[sampleIndex&(MAXSAMPLES-1)]= value;
-            peak= 0;
-            for(int i= nSamples-1; i>=0; i--)
-            {
-                float sample= buf[(sampleIndex+MAXSAMPLES-i) & (MAXSAMPLES-1)];
-                float sAbs= fabs(sample);
-                if(sAbs>peak)
-                    peak= sAbs;
-            }
-            sampleIndex++;
-            peakFiltered+= (peak-peakFiltered) * (peak>peakFiltered? peakStep2: peakStep);
-            return peakFiltered;
-        }
-
-    private:
-        float peak;
-        double peakFiltered;
-        float peakStep, peakStep2;
-        unsigned nSamples, sampleIndex;
-        float buf[MAXSAMPLES];
-};
-
-class fluxOscWindow: public fluxWindowBase, public configOptionHandler
-{
-	public:
-		fluxOscWindow(int x, int y, int w, int h, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
-			fluxWindowBase(x,y, w,h, CB_MOUSE_FLAG|CB_PAINT_FLAG, parent, alignment),
-			configOptionHandler("OscWindow"),
-			nChannels(2), sampleBufferFillIndex(0), triggerLevel(0.2), triggerEnabled(true), triggerPositive(true),
-			verticalScaling(1.0), samplingRate(48000), draggingHorizScale(false), cursorPos(-1), cursorChannel(0),
-			configPane(false)
-		{
-			setDisplayTime(0.01);
-
-			ADD_CONFIG_OPTION(displayTime);
-			ADD_CONFIG_OPTION(triggerLevel);
-			ADD_CONFIG_OPTION(triggerPositive);
-			ADD_CONFIG_OPTION(triggerEnabled);
-			ADD_CONFIG_OPTION(verticalScaling);
-		}
-
-		~fluxOscWindow()
-		{
-		}
-
-		void setConfigPane(class fluxOscWindowConfigPane *myConfigPane)
-		{
-			configPane= myConfigPane;
-		}
-
-		void setDisplayTime(double time)
-		{ setDisplaySamples(int(time*samplingRate)); }
-
-		double getDisplayTime()
-		{ return displayTime; }
-
-		void setDisplaySamples(int nFrames)
-		{
-			if(nFrames<10) nFrames= 10;
-			else if(nFrames>samplingRate*10) nFrames= samplingRate*10;
-			sampleBuffers.resize(nChannels);
-			for(unsigned i= 0; i<nChannels; i++)
-				sampleBuffers[i].resize(nFrames);
-			displayTime= double(nFrames)/samplingRate;
-			refreshGlLineCoords();
-		}
-
-		void enableTrigger(bool enabled)
-		{ triggerEnabled= enabled; }
-
-		void setTriggerLevel(float level)
-		{ triggerLevel= level; }
-
-		void setTriggerDir(bool positive)
-		{ triggerPositive= positive; }
-
-		float getVerticalScaling()
-		{ return verticalScaling; }
-
-		void setVerticalScaling(float s)
-		{ verticalScaling= (s<0.1? 0.1: s>100? 100: s); }
-
-		void setSamplingRate(float s)
-		{ samplingRate= s; }
-
-		bool isTriggerEnabled()
-		{ return triggerEnabled; }
-
-		bool isTriggerPositive()
-		{ return triggerPositive; }
-
-		float getTriggerLevel()
-		{ return triggerLevel; }
-
-		void addBuffers(jack_default_audio_sample_t **data, uint32_t nFrames, uint32_t nChannels)
-		{
-            int srcPos= 0;
-            double samplesPerStep= double(sampleBuffers[0].size()) / glCoords[0].size();
-            for(unsigned i= 0; i<nChannels; i++)
-                filters[i].setNumSamples(samplesPerStep);
-            lineDisplayPeaks= (samplesPerStep>2.5);
-			if(triggerEnabled)
-			{
-				while(nFrames)
-				{
-					int blockSize= min( nFrames, sampleBuffers[0].size()-sampleBufferFillIndex);
-					int triggerPos= (sampleBufferFillIndex<sampleBuffers[0].size()? -1:
-                                     findTriggerPos(data[0]+srcPos, nFrames-srcPos));
-					if(triggerPos>=0) blockSize= min(blockSize, triggerPos);
-					unsigned idx;
-					for(unsigned ch= 0; ch<nChannels; ch++)
-                    {
-                        SampleVector &samples= sampleBuffers[ch];
-                        PeakTracker &filter= filters[ch];
-                        jack_default_audio_sample_t *chanData= data[ch];
-                        idx= sampleBufferFillIndex;
-                        if(lineDisplayPeaks)
-                            for(int i= 0; i<blockSize && idx<sampleBuffers[0].size(); i++, idx++)
-                                samples[idx]= filter.run(chanData[srcPos+i]);
-                        else
-                            for(int i= 0; i<blockSize && idx<sampleBuffers[0].size(); i++, idx++)
-                                samples[idx]= chanData[srcPos+i];
-                    }
-                    sampleBufferFillIndex= idx;
-					if(blockSize+srcPos<=triggerPos)
-						sampleBufferFillIndex= 0,
-						nFrames-= triggerPos;
-					else
-						nFrames-= (blockSize? blockSize: nFrames);
-				}
-                refreshGlLineCoords();
-			}
-			else    // trigger disabled
-            {
-				while(nFrames)
-				{
-					int blockSize= min(nFrames, sampleBuffers[0].size()-sampleBufferFillIndex);
-                    unsigned idx;
-                    for(unsigned ch= 0; ch<nChannels; ch++)
-                    {
-                        SampleVector &samples= sampleBuffers[ch];
-                        PeakTracker &filter= filters[ch];
-                        jack_default_audio_sample_t *chanData= data[ch];
-                        idx= sampleBufferFillIndex;
-                        if(lineDisplayPeaks)
-                            for(int i= 0; i<blockSize; i++, idx++)
-                                samples[idx]= filter.run(chanData[srcPos+i]);
-                        else
-                            for(int i= 0; i<blockSize; i++, idx++)
-                                samples[idx]= chanData[srcPos+i];
-                    }
-                    sampleBufferFillIndex= idx;
-					if(sampleBufferFillIndex>=sampleBuffers[0].size())
-                        sampleBufferFillIndex= 0;
-                    nFrames-= (blockSize? blockSize: nFrames);
-				}
-                refreshGlLineCoords();
-            }
-		}
-
-	private:
-		typedef vector<jack_default_audio_sample_t> SampleVector;
-		vector<SampleVector> sampleBuffers;
-		unsigned nChannels;
-		uint32_t sampleBufferFillIndex;
-		struct gl2DCoords { float x, y; float x1, y1; };
-		vector< vector<gl2DCoords> > glCoords;
-		struct gl3fColor { float r, g, b; float r1, g1, b1; };
-		vector< vector<gl3fColor> > glColors;
-		bool lineDisplayPeaks;
-		float triggerLevel;
-		bool triggerEnabled;
-		bool triggerPositive;
-		jack_default_audio_sample_t prevTriggerSample;
-		float verticalScaling;
-		float samplingRate;
-		float displayTime;
-		bool draggingHorizScale;
-		int horizScaleClickPos;
-		int cursorPos;
-		unsigned cursorChannel;
-		class fluxOscWindowConfigPane *configPane;
-		PeakTracker filters[8];
-
-		int findTriggerPos(float *data, uint32_t nFrames)
-		{
-			if(triggerEnabled) for(uint32_t i= 0; i<nFrames; i++)
-			{
-				float sample= data[i];
-				if( (triggerPositive && (prevTriggerSample<=triggerLevel && sample>=triggerLevel)) ||
-					((!triggerPositive) && (prevTriggerSample>=triggerLevel && sample<=triggerLevel)) )
-				{
-					prevTriggerSample= sample;
-					return i;
-				}
-				prevTriggerSample= sample;
-			}
-			return -1;
-		}
-
-		double getValueAtSamplePos(int channel, double pos)
-		{
-//			uint32_t idx0= uint32_t(pos),
-//				     idx1= (idx0<sampleBuffers[channel].size()-1? idx0+1: sampleBuffers[channel].size()-1);
-//			double a= pos-idx0;
-//			return sampleBuffers[channel][idx0] + (sampleBuffers[channel][idx1]-sampleBuffers[channel][idx0])*a;
-            return sampleBuffers[channel][pos];
-		}
-
-		double getValueAtCursorPos()
-		{
-		    if(cursorPos<0 || cursorChannel>sampleBuffers.size())
-                return 0;
-            if(triggerEnabled)
-                return glCoords[cursorChannel][cursorPos].y;
-            else
-            {
-                int offset= sampleBufferFillIndex*glCoords[cursorChannel].size()/sampleBuffers[0].size() + cursorPos;
-                offset%= glCoords[0].size();
-                return glCoords[cursorChannel][offset].y;
-            }
-		}
-
-		void updateGuiParam(void *paramAddress);
-
-		void refreshGlLineCoords()
-		{
-			rect absPos;
-			wnd_get_abspos(fluxHandle, &absPos);
-			uint32_t windowWidth= absPos.rgt - absPos.x;
-
-			if(!windowWidth) return;
-
-			if(glCoords.size()!=nChannels)
-                glCoords.resize(nChannels),
-                glColors.resize(nChannels);
-			for(unsigned i= 0; i<glCoords.size(); i++)
-            {
-                if(glCoords[i].size() != windowWidth)
-                    glCoords[i].resize(windowWidth);
-                if(glColors[i].size() != windowWidth)
-                    glColors[i].resize(windowWidth);
-            }
-
-			double sampleStep= double(sampleBuffers[0].size())/glCoords[0].size();
-			float cr0= 0.1, cg0= 1.0, cb0= 0.2;
-			float cr1= 0.1, cg1= 1.0, cb1= .8;
-			float ct= 0.5;
-			for(unsigned i= 0; i<nChannels; i++)
-            {
-                int coordIdx= 0;
-                vector<gl2DCoords> &coords= glCoords[i];
-                vector<gl3fColor> &colors= glColors[i];
-                for(double sampleIdx= 0; sampleIdx<(int)sampleBuffers[i].size() && coordIdx<(int)windowWidth;
-                    sampleIdx+= sampleStep, coordIdx++)
-                {
-                    float value= getValueAtSamplePos(i, sampleIdx);
-                    coords[coordIdx].x= coordIdx;
-                    coords[coordIdx].y= value;
-                    coords[coordIdx].x1= coordIdx;
-                    coords[coordIdx].y1= 0;
-
-                    float c= fabs(value);
-                    float cr= (c-.75)*4;
-                    if(cr<0) cr= 0;
-                    else if(cr>.75) cr= .75;
-                    c= c*(1.0-ct)+ct;
-                    colors[coordIdx].r1= c*cr1; colors[coordIdx].g1= c*cg1; colors[coordIdx].b1= c*cb1;
-                    colors[coordIdx].r= ct*cr0+cr; colors[coordIdx].g= ct*cg0; colors[coordIdx].b= ct*cb0;
-                }
-            }
-		}
-
-
-        void paintLineSegments(int steps= 16)
-        {
-            glDisable(GL_LINE_SMOOTH);
-
-			glBegin(GL_LINES);
-
-			// draw segments
-			for(int i= 1; i<steps; i++)
-			{
-				float y= i*2.0/steps-1;
-				if(!(i&1)) glColor4f(1,1,1,.3);
-				else glColor4f(1,1,1,.2);
-
-				glVertex2f(0, y);
-				glVertex2f(1, y);
-
-				float x= double(i)/steps;
-				glVertex2f(x, -1);
-				glVertex2f(x, +1);
-			}
-
-			// draw center line
-			glColor4f(1,1,1,.5);
-			glVertex2f(0, 0);
-			glVertex2f(1, 0);
-
-			glEnd();
-        }
-
-        void paintLineModeCursor(int windowWidth, int windowHeight, int channelIndex)
-        {
-			if(cursorPos>=0 && cursorPos<windowWidth)
-			{
-                glDisable(GL_LINE_SMOOTH);
-				double windowPos= double(cursorPos)/windowWidth;
-				double cW= 4.0/windowWidth, cH= 8.0/windowHeight;
-
-				glLineWidth(1);
-
-				glColor4f(1,.9,.2, .8);
-				glBegin(GL_LINES);
-				glVertex2f(windowPos, -1);
-				glVertex2f(windowPos, 1);
-				glEnd();
-
-				glLineWidth(2);
-
-				double valueAtCursor= getValueAtCursorPos()*verticalScaling;
-				glEnable(GL_LINE_SMOOTH);
-				glBegin(GL_LINES);
-				glVertex2f(windowPos-cW, valueAtCursor-cH);
-				glVertex2f(windowPos+cW, valueAtCursor+cH);
-				glVertex2f(windowPos+cW, valueAtCursor-cH);
-				glVertex2f(windowPos-cW, valueAtCursor+cH);
-				glEnd();
-				glDisable(GL_LINE_SMOOTH);
-
-				glLineWidth(1);
-			}
-        }
-
-        void paintSignalLines(int channel)
-        {
-            glColor4f(.1,1,.25,.75);
-            if(lineDisplayPeaks) glDisable(GL_LINE_SMOOTH);
-            else glEnable(GL_LINE_SMOOTH);
-            glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
-            glLineWidth(1.0);
-            glEnable(GL_VERTEX_ARRAY);
-
-            if(lineDisplayPeaks)
-            {
-                glEnable(GL_COLOR_ARRAY);
-            }
-
-            int glCoordStride= (lineDisplayPeaks? 2*4: 4*4);
-
-            if(triggerEnabled)
-            {
-                // draw everything when trigger is on
-                glVertexPointer(2, GL_FLOAT, glCoordStride, (void*)&glCoords[channel][0]);
-                if(lineDisplayPeaks)
-                {
-                    glColorPointer(3, GL_FLOAT, 0, &glColors[channel][0]);
-                    glDrawArrays(GL_LINES, 0, glCoords[channel].size()*2);
-                    glScalef(1, -1, 1);
-                    glDrawArrays(GL_LINES, 0, glCoords[channel].size()*2);
-                }
-                else glDrawArrays(GL_LINE_STRIP, 0, glCoords[channel].size());
-            }
-            else
-            {
-                // trigger disabled: scroll
-                int endIndex= sampleBufferFillIndex*glCoords[channel].size()/sampleBuffers[0].size()+1;
-                while(endIndex>(int)glCoords[channel].size()) endIndex-= glCoords[channel].size();
-                int right= glCoords[channel].size()-endIndex;
-
-                glTranslatef(right, 0, 0);
-
-                glVertexPointer(2, GL_FLOAT, glCoordStride, (void*)&glCoords[channel][0]);
-                if(lineDisplayPeaks)
-                {
-                    glColorPointer(3, GL_FLOAT, 0, &glColors[channel][0]);
-                    glDrawArrays(GL_LINES, 0, endIndex*2);
-                    glScalef(1, -1, 1);
-                    glDrawArrays(GL_LINES, 0, endIndex*2);
-                    glScalef(1, -1, 1);
-                }
-                else glDrawArrays(GL_LINE_STRIP, 0, endIndex);
-
-                glTranslatef(-right-endIndex, 0, 0);
-
-                glVertexPointer(2, GL_FLOAT, glCoordStride, (void*)&glCoords[channel][endIndex]);
-                if(lineDisplayPeaks)
-                {
-                    glColorPointer(3, GL_FLOAT, 0, &glColors[channel][endIndex]);
-                    glDrawArrays(GL_LINES, 0, right*2);
-                    glScalef(1, -1, 1);
-                    glDrawArrays(GL_LINES, 0, right*2);
-                    glScalef(1, -1, 1);
-                }
-                else glDrawArrays(GL_LINE_STRIP, 0, right);
-            }
-
-            glDisable(GL_VERTEX_ARRAY);
-            glDisable(GL_COLOR_ARRAY);
-            glLineWidth(1);
-        }
-
-
-		void cbPaint(primitive *self, rect *absPos, const rectlist *dirtyRects)
-		{
-			unsigned windowWidth= absPos->rgt - absPos->x;
-			int windowHeight= absPos->btm - absPos->y;
-
-			if(glCoords.size()!=nChannels || glCoords[0].size() != windowWidth)
-				refreshGlLineCoords();
-
-			if(!windowWidth) return;
-
-			fill_rect(absPos, 0);
-
-			glEnable(GL_SCISSOR_TEST);
-			glEnable(GL_BLEND);
-			glDisable(GL_LINE_SMOOTH);
-			glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-            glMatrixMode(GL_MODELVIEW);
-
-			for(unsigned channel= 0; channel<nChannels; channel++)
-            {
-                int width= windowWidth,
-                    height= windowHeight/nChannels,
-                    x= absPos->x, y= absPos->y + height*channel;
-
-                glPushMatrix();
-
-                glTranslatef(x, y + height*.5, 0);
-                glScalef(width, -height*.5, 1);
-
-                glDisable(GL_LINE_SMOOTH);
-                glColor3f(.5,.5,.5);
-                glBegin(GL_LINES);
-                glVertex2f(0,1);
-                glVertex2f(1,1);
-                glEnd();
-
-                glScissor(x, viewport.btm-(y+height), width, height);
-
-                paintLineSegments();
-
-                if(channel==cursorChannel)
-                    paintLineModeCursor(width, height, channel);
-
-                glScaled(1.0/width, verticalScaling, 1);
-
-                if(channel==0 && triggerEnabled)
-                {
-                    // draw trigger
-                    glBegin(GL_LINES);
-                    glColor4f(0,1,1,.5);
-                    glVertex2f(0, triggerLevel);
-                    glVertex2f(width, triggerLevel);
-                    glEnd();
-                }
-
-                paintSignalLines(channel);
-
-                glPopMatrix();
-            }
-
-			if(cursorPos>=0 && cursorPos<absPos->rgt-absPos->x)
-			{
-				char cursorText[128];
-				double windowPos= double(cursorPos)/windowWidth;
-				double valueAtCursor= getValueAtCursorPos();
-				double timeIdx= windowPos*sampleBuffers[cursorChannel].size()/samplingRate;
-				snprintf(cursorText, 128, "+%.2fms Value: %7.4f %s", timeIdx*1000, valueAtCursor, lineDisplayPeaks? "(peak)": "");
-				draw_text(_font_getloc(FONT_DEFAULT), cursorText, 4,absPos->btm-4-13, *absPos, 0x10f008);
-			}
-
-			glDisable(GL_SCISSOR_TEST);
-		}
-
-		void cbMouse(primitive *self, int type, int x, int y, int btn)
-		{
-			if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELUP)
-				setVerticalScaling(verticalScaling*1.1),
-				updateGuiParam(&verticalScaling);
-			else if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELDOWN)
-				setVerticalScaling(verticalScaling*0.9),
-				updateGuiParam(&verticalScaling);
-			else if(type==MOUSE_DOWN && btn==MOUSE_BTNRIGHT)
-			{
-				draggingHorizScale= true;
-				horizScaleClickPos= x;
-				cursorPos= -1;
-			}
-			else if( btn==1 && triggerEnabled )
-			{
-				if(type==MOUSE_DOWN)
-					wnd_set_mouse_capture(fluxHandle);
-				rect absPos;
-				wnd_get_abspos(fluxHandle, &absPos);
-				int channelHeight= (absPos.btm-absPos.y)/nChannels;
-				if(y<=channelHeight)
-                {
-                    int y1= y%channelHeight;
-                    triggerLevel= double(channelHeight/2-y1)/verticalScaling/channelHeight*2;
-                    float triggerMinMax= 1.0/verticalScaling;
-                    if(triggerLevel>triggerMinMax) triggerLevel= triggerMinMax;
-                    if(triggerLevel<-triggerMinMax) triggerLevel= -triggerMinMax;
-                    updateGuiParam(&triggerLevel);
-                    cursorPos= -1;
-                }
-			}
-			else if(type==MOUSE_UP)
-			{
-				draggingHorizScale= false;
-				wnd_set_mouse_capture(NOWND);
-			}
-			else if(type==MOUSE_OVER && draggingHorizScale)
-			{
-				setDisplayTime(displayTime+(horizScaleClickPos-x)*0.0001);
-				updateGuiParam(&displayTime);
-				horizScaleClickPos= x;
-			}
-			else if(type==MOUSE_OVER)
-			{
-				cursorPos= x;
-				cursorChannel= y/(wnd_geth(fluxHandle)/nChannels);
-				if(cursorChannel>=nChannels) cursorChannel= nChannels-1;
-			}
-			else if(type==MOUSE_OUT)
-			{
-				cursorPos= -1;
-			}
-		}
-};
-
-// receives callbacks when some kind of object has changed
-class changeListener
-{
-	public:
-		// this is called when some object has changed.
-		// override this in the subclass
-		virtual void valueChanged(class changeNotifier *which)
-		{ }
-};
-
-// calls back a changeListener when it has changed
-class changeNotifier
-{
-	private:
-		changeListener *myChangeListener;
-
-	public:
-		changeNotifier(changeListener *_myChangeListener):
-			myChangeListener(_myChangeListener)
-		{ }
-
-		// call this to notify the changeListener that this object has changed
-		void notifyChange()
-		{
-			if(myChangeListener) myChangeListener->valueChanged(this);
-		}
-};
-
-// base class for a label that can be changed in some way.
-// it just creates the text window and underlines it when the mouse enters the window.
-class fluxChangableLabelBase: public fluxWindowBase, public changeNotifier
-{
-	protected:
-		uint32_t labelHandle, lineHandle;
-
-		void cbMouse(primitive *self, int type, int x, int y, int btn)
-		{
-			if(type==MOUSE_IN)
-				wnd_show(lineHandle, true);
-			else if(type==MOUSE_OUT)
-				wnd_show(lineHandle, false);
-		}
-
-
-	public:
-		fluxChangableLabelBase(changeListener *_myChangeListener,
-							   int x, int y, uint32_t callbackFlags,
-							   int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
-			fluxWindowBase(x,y, 0,0, callbackFlags|CB_MOUSE_FLAG, parent, alignment),
-			changeNotifier(_myChangeListener)
-		{
-			labelHandle= create_text(fluxHandle, 0,0, 0,0, "text", COL_TEXT, FONT_DEFAULT, ALIGN_LEFT|ALIGN_RIGHT|ALIGN_TOP|ALIGN_BOTTOM);
-			lineHandle= create_rect(fluxHandle, 0,0, 0,1, COL_TEXT, ALIGN_LEFT|ALIGN_RIGHT|ALIGN_BOTTOM);
-			wnd_show(lineHandle, false);
-			rect_setcolor(fluxHandle, TRANSL_NOPAINT);
-			setText("Label");
-		}
-
-		~fluxChangableLabelBase()
-		{
-			wnd_destroy(labelHandle);
-			wnd_destroy(lineHandle);
-		}
-
-		void setText(const char *text)
-		{
-			text_settext(labelHandle, text);
-			wnd_setsize(fluxHandle, font_gettextwidth(FONT_DEFAULT, text), font_gettextheight(FONT_DEFAULT, text));
-		}
-};
-
-class fluxDraggableLabel: public fluxChangableLabelBase
-{
-	public:
-		enum DisplayMode
-		{
-			DM_PLAIN= 0,
-			DM_SECONDS,
-			DM_PERCENTAGE
-		};
-
-		fluxDraggableLabel(changeListener *_myChangeListener, int x, int y, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
-			fluxChangableLabelBase(_myChangeListener, x,y, 0, parent, alignment),
-			isDragging(false)
-		{
-			enableRelativeMode(true);
-			enableVerticalMode(false);
-			setRelativeModeSpeed(0.01);
-			setMinimumValue(0.01);
-			setMaximumValue(10);
-			setValue((minimumValue+maximumValue)/2, false);
-			setDisplayMode(DM_PLAIN);
-		}
-
-		void setRelativeModeSpeed(float speed)
-		{ relativeModeSpeed= speed; }
-
-		float getRelativeModeSpeed()
-		{ return relativeModeSpeed; }
-
-		void enableRelativeMode(bool enabled)
-		{ relativeModeEnabled= enabled; }
-
-		bool isRelativeModeEnabled()
-		{ return relativeModeEnabled; }
-
-		void setMinimumValue(float min)
-		{ minimumValue= min; }
-
-		void setMaximumValue(float max)
-		{ maximumValue= max; }
-
-		void setValue(float val, bool doNotify= true)
-		{
-			if(val<minimumValue) val= minimumValue;
-			else if(val>maximumValue) val= maximumValue;
-			value= val;
-			if(doNotify) notifyChange();
-			updateDisplay();
-		}
-
-		float getValue()
-		{ return value; }
-
-		void enableVerticalMode(bool enabled)
-		{ verticalMode= enabled; }
-
-		void setDisplayMode(DisplayMode mode, int precision= 3)
-		{ displayMode= mode; displayPrecision= precision; updateDisplay(); }
-
-	protected:
-		virtual void doDrag(int dx, int dy)
-		{
-			if(relativeModeEnabled)
-				setValue(value + (verticalMode? -dy: dx) * relativeModeSpeed);
-		}
-
-		virtual void updateDisplay()
-		{
-			char ch[128];
-			switch(displayMode)
-			{
-				case DM_PLAIN: snprintf(ch, 128, "%.*f", displayPrecision, value); break;
-				case DM_SECONDS: snprintf(ch, 128, "%.*fs", displayPrecision, value); break;
-				case DM_PERCENTAGE: snprintf(ch, 128, "%.*f%%", displayPrecision, value*100); break;
-			}
-			setText(ch);
-		}
-
-
-	private:
-		float relativeModeSpeed;
-		bool relativeModeEnabled;
-		float minimumValue;
-		float maximumValue;
-		float value;
-		bool isDragging;
-		int dragStartX, dragStartY;
-		bool verticalMode;
-		enum DisplayMode displayMode;
-		int displayPrecision;
-
-		void cbMouse(primitive *self, int type, int x, int y, int btn)
-		{
-			fluxChangableLabelBase::cbMouse(self, type, x, y, btn);
-			if(type==MOUSE_DOWN && btn==MOUSE_BTNLEFT)
-			{
-				isDragging= true;
-				wnd_set_mouse_capture(fluxHandle);
-				dragStartX= x; dragStartY= y;
-			}
-			else if(type==MOUSE_UP)
-			{
-				isDragging= false;
-				wnd_set_mouse_capture(NOWND);
-			}
-			else if(type==MOUSE_OVER && isDragging)
-			{
-				rect abspos;
-				wnd_get_abspos(fluxHandle, &abspos);
-				SDL_WarpMouse(abspos.x+dragStartX, abspos.y+dragStartY);
-				doDrag(x-dragStartX, y-dragStartY);
-			}
-		}
-};
-
-
-class fluxChoiceLabel: public fluxChangableLabelBase
-{
-	public:
-		fluxChoiceLabel(changeListener *_myChangeListener, int x, int y, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
-			fluxChangableLabelBase(_myChangeListener, x,y, 0, parent, alignment)
-		{
-			setText("Choice");
-		}
-
-		virtual void selectChoice(int choice, bool doNotify= true)
-		{
-			if(!choiceList.size()) return;
-			while(choice<0) choice+= choiceList.size();
-			choiceIndex= choice%choiceList.size();
-			setText(choiceList[choiceIndex].c_str());
-			if(doNotify) notifyChange();
-		}
-
-		void addChoice(const char *choiceText)
-		{
-			choiceList.push_back(string(choiceText));
-			if(choiceList.size()==1) selectChoice(0, false);
-		}
-
-		int getChoiceIndex()
-		{ return choiceIndex; }
-
-		std::string getChoiceText()
-		{ return (choiceIndex<choiceList.size()? choiceList[choiceIndex]: "None"); }
-
-	protected:
-		vector<string> choiceList;
-		uint32_t choiceIndex;
-
-	private:
-		void cbMouse(primitive *self, int type, int x, int y, int btn)
-		{
-			fluxChangableLabelBase::cbMouse(self, type, x, y, btn);
-
-			if(type==MOUSE_DOWN)
-			{
-				if(btn==MOUSE_BTN1 || btn==MOUSE_BTNWHEELUP)
-					selectChoice(++choiceIndex);
-				else if(btn==MOUSE_BTN2 || btn==MOUSE_BTNWHEELDOWN)
-					selectChoice(--choiceIndex);
-			}
-		}
-};
-
-
-class fluxOscWindowConfigPane: public fluxWindowBase, public changeListener
-{
-	private:
-		fluxOscWindow &oscWindow;
-		fluxChoiceLabel *triggerTypeChoiceLabel;
-		uint32_t triggerTypeText;
-		fluxDraggableLabel *displayTimeLabel;
-		uint32_t displayTimeText;
-		fluxDraggableLabel *verticalScalingLabel;
-		uint32_t verticalScalingText;
-		fluxDraggableLabel *triggerLevelLabel;
-		uint32_t triggerLevelText;
-
-	public:
-		fluxOscWindowConfigPane(fluxOscWindow &myOscWindow, int x, int y, int w, int h,
-								uint32_t parent= NOPARENT, int alignment= ALIGN_BOTTOM|ALIGN_LEFT|ALIGN_RIGHT):
-			fluxWindowBase(x,y, w,h, 0, parent, alignment),
-			oscWindow(myOscWindow)
-		{
-			uint32_t textColor= 0xc8c8c8;
-			int textWidth= 85;
-
-			triggerTypeText= create_text(fluxHandle, 8,8, 100,20, "Trigger Type: ", textColor, FONT_DEFAULT);
-			triggerTypeChoiceLabel= new fluxChoiceLabel(this, 8+textWidth,8, fluxHandle);
-			triggerTypeChoiceLabel->addChoice("Off");
-			triggerTypeChoiceLabel->addChoice("Rising Edge");
-			triggerTypeChoiceLabel->addChoice("Falling Edge");
-			triggerTypeChoiceLabel->selectChoice(!oscWindow.isTriggerEnabled()? 0: oscWindow.isTriggerPositive()? 1: 2);
-
-			triggerLevelText= create_text(fluxHandle, 8,24, 100,20, "Trigger Level: ", textColor, FONT_DEFAULT);
-			triggerLevelLabel= new fluxDraggableLabel(this, 8+textWidth,24, fluxHandle);
-			triggerLevelLabel->setMinimumValue(-50);
-			triggerLevelLabel->setMaximumValue(+50);
-			triggerLevelLabel->setRelativeModeSpeed(0.001);
-			triggerLevelLabel->enableVerticalMode(true);
-			triggerLevelLabel->setValue(oscWindow.getTriggerLevel());
-
-			textWidth= 80;
-			displayTimeText= create_text(fluxHandle, 190,8, 100,20, "Display Time: ", textColor, FONT_DEFAULT);
-			displayTimeLabel= new fluxDraggableLabel(this, 190+textWidth,8, fluxHandle);
-			displayTimeLabel->setMinimumValue(0.0005);
-			displayTimeLabel->setMaximumValue(10);
-			displayTimeLabel->setRelativeModeSpeed(0.001);
-			displayTimeLabel->setDisplayMode(fluxDraggableLabel::DM_SECONDS);
-			displayTimeLabel->setValue(oscWindow.getDisplayTime());
-
-			verticalScalingText= create_text(fluxHandle, 190,24, 100,20, "Vert. Scaling: ", textColor, FONT_DEFAULT);
-			verticalScalingLabel= new fluxDraggableLabel(this, 190+textWidth,24, fluxHandle);
-			verticalScalingLabel->setMinimumValue(0.1);
-			verticalScalingLabel->setMaximumValue(100.0);
-			verticalScalingLabel->setRelativeModeSpeed(0.005);
-			verticalScalingLabel->enableVerticalMode(true);
-			verticalScalingLabel->setDisplayMode(fluxDraggableLabel::DM_PERCENTAGE, 0);
-			verticalScalingLabel->setValue(oscWindow.getVerticalScaling());
-		}
-
-		void updateTriggerLevelDisplay(float newTriggerLevel)
-		{ triggerLevelLabel->setValue(newTriggerLevel, false); }
-		void updateVerticalScalingDisplay(float newVertScale)
-		{ verticalScalingLabel->setValue(newVertScale, false); }
-		void updateDisplayTimeDisplay(float newDisplayTime)
-		{ displayTimeLabel->setValue(newDisplayTime, false); }
-
-		void valueChanged(changeNotifier *which)
-		{
-			if(which==triggerTypeChoiceLabel)
-			{
-				switch(triggerTypeChoiceLabel->getChoiceIndex())
-				{
-					case 0:
-						oscWindow.enableTrigger(false);
-						break;
-					case 1:
-						oscWindow.setTriggerDir(true);
-						oscWindow.enableTrigger(true);
-						break;
-					case 2:
-						oscWindow.setTriggerDir(false);
-						oscWindow.enableTrigger(true);
-						break;
-				}
-			}
-			else if(which==triggerLevelLabel)
-				oscWindow.setTriggerLevel(triggerLevelLabel->getValue());
-			else if(which==displayTimeLabel)
-				oscWindow.setDisplayTime(displayTimeLabel->getValue());
-			else if(which==verticalScalingLabel)
-				oscWindow.setVerticalScaling(verticalScalingLabel->getValue());
-		}
-};
-
-// update the GUI to reflect a parameter change of the oscillator window
-void fluxOscWindow::updateGuiParam(void *paramAddress)
-{
-	if(!configPane) return;
-
-	if(paramAddress==&triggerLevel)
-		configPane->updateTriggerLevelDisplay(triggerLevel);
-	else if(paramAddress==&verticalScaling)
-		configPane->updateVerticalScalingDisplay(verticalScaling);
-	else if(paramAddress==&displayTime)
-		configPane->updateDisplayTimeDisplay(displayTime);
-}
-
-
-const char *getHomeDir()
-{
-	return getenv("HOME");
-}
-
-string getConfigDir()
-{
-	return string(getHomeDir()) + "/.fluxscope";
-}
-
-string getConfigFilename()
-{
-	return getConfigDir() + "/prefs";
-}
-
-bool createConfigDir()
-{
-	string cfgdir= getConfigDir();
-	struct stat st;
-	mkdir(cfgdir.c_str(), 0700);
-	int err= stat(cfgdir.c_str(), &st);
-	if(err==0 && st.st_mode&S_IFDIR)
-		return true;
-	else
-		return false;
-}
-
-bool createConfigFile()
-{
-	if(!createConfigDir()) return false;
-	FILE *f= fopen(getConfigFilename().c_str(), "w");
-	if(!f) return false;
-	fclose(f);
-	return true;
-}
-
-int main(int argc, char* argv[])
-{
-	bool doQuit= false;
-	double time, lastTime= getTime(), lastJackTry;
-	JackInterface JackIF;
-	if(!setVideoMode(640, 400)) exit(1);
-
-	fluxOscWindow oscWindow(0,0, 0,64, NOPARENT, ALIGN_LEFT|ALIGN_RIGHT|ALIGN_TOP|ALIGN_BOTTOM);
-	if(!gConfigHandler.readFromFile(getConfigFilename().c_str()))
-		printf("couldn't read config file %s\n", getConfigFilename().c_str());
-	fluxOscWindowConfigPane configPane(oscWindow, 0,0, 0,64, NOPARENT, ALIGN_BOTTOM|ALIGN_LEFT|ALIGN_RIGHT);
-	oscWindow.setConfigPane(&configPane);
-	JackIF.initialize(2);
-	lastJackTry= getTime();
-	oscWindow.setSamplingRate(JackIF.getSamplingRate());
-
-	while(!doQuit)
-	{
-		time= getTime();
-		gTime+= time-lastTime;
-		lastTime= time;
-
-		SDL_Event ev;
-		while(SDL_PollEvent(&ev))
-		{
-			switch(ev.type)
-			{
-				case SDL_KEYDOWN:
-					if(ev.key.keysym.sym==SDLK_ESCAPE)
-						doQuit= true;
-					else
-						flux_keyboard_event(true, ev.key.keysym.scancode, ev.key.keysym.sym);
-					break;
-				case SDL_QUIT:
-					doQuit= true;
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					flux_mouse_button_event(SDLMouseButtonToFluxMouseButton(ev.button.button), ev.button.state);
-					break;
-				case SDL_MOUSEBUTTONUP:
-					flux_mouse_button_event(SDLMouseButtonToFluxMouseButton(ev.button.button), ev.button.state);
-					break;
-				case SDL_MOUSEMOTION:
-					flux_mouse_move_event(ev.motion.xrel, ev.motion.yrel);
-					break;
-				case SDL_VIDEORESIZE:
-					setVideoMode(ev.resize.w, ev.resize.h);
-					break;
-
-				case SDL_USEREVENT:
-					switch(ev.user.code)
-					{
-						case SDL_USER_ADDJACKBUFFER:
-						{
-							// todo: use lock-free ringbuffer from jack/ringbuffer.h
-							const JackBufferData *eventData= (JackBufferData*)ev.user.data1;
-							oscWindow.addBuffers(eventData->data, eventData->nFrames, eventData->nChannels);
-							break;
-						}
-					}
-			}
-		}
-
-		if(!JackIF.isRunning() && time-lastJackTry>5.0)
-		{
-			lastJackTry= time;
-			JackIF.initialize(2);
-		}
-
-		flux_tick();
-		glFinish();
-		SDL_GL_SwapBuffers();
-
-		double frametime= getTime() - time;
-		double delay= (1.0/100) - frametime;
-		if(delay<0.001) delay= 0.001;
-		usleep(useconds_t(delay*1000000));
-	}
-
-	createConfigFile();
-	if(!gConfigHandler.writeToFile(getConfigFilename().c_str()))
-		printf("couldn't write to config file %s\n", getConfigFilename().c_str());
-
-	JackIF.shutdown();
-	flux_shutdown();
-	SDL_Quit();
-    return 0;
-}
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <new>
+#include <sstream>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <ctime>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#if defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+#include <GL/gl.h>
+#include <GL/glu.h>
+#include <GL/glext.h>
+#include <SDL/SDL.h>
+#include <SDL/SDL_thread.h>
+#include <jack/jack.h>
+#include <flux.h>
+
+using namespace std;
+
+double gTime, startTime;
+
+
+double getTime()
+{
+	timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec*0.000001;
+}
+
+
+inline bool checkglerror(bool fatal= false)
+{
+    int err= glGetError();
+    if(err)
+    {
+    	printf("GL Error: %s\n", gluErrorString(err));
+        if(fatal) abort();
+        else return false;
+    }
+    return true;
+}
+
+
+bool setVideoMode(int w, int h, bool vsync= false)
+{
+	SDL_Init(SDL_INIT_VIDEO);
+	SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+	SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 0);
+	SDL_GL_SetAttribute(SDL_GL_SWAP_CONTROL, vsync);
+	if(!SDL_SetVideoMode(w, h, 0, SDL_OPENGL|SDL_RESIZABLE))
+    {
+        printf("SDL_SetVideoMode failed: %s\n", SDL_GetError());
+        return false;
+    }
+	int doubleBuf, depthSize, swapControl;
+	SDL_GL_GetAttribute(SDL_GL_DOUBLEBUFFER, &doubleBuf);
+	SDL_GL_GetAttribute(SDL_GL_DEPTH_SIZE, &depthSize);
+	SDL_GL_GetAttribute(SDL_GL_SWAP_CONTROL, &swapControl);
+	SDL_WM_SetCaption("Scope", 0);
+	SDL_ShowCursor(false);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glLoadIdentity();
+    glOrtho(0, w, h, 0, -1000, 1000);
+    glViewport(0,0, w,h);
+	glDisable(GL_DITHER);
+	flux_screenresize(w, h);
+	return true;
+}
+
+
+// run queued GUI events and timers
+void flux_tick()
+{
+	aq_exec();
+	run_timers();
+}
+
+void flux_redraw()
+{
+	redraw_rect(&viewport);
+	redraw_cursor();
+
+	checkglerror();
+}
+
+int SDLMouseButtonToFluxMouseButton(int button)
+{
+	if(button>3) return button-1;
+	else return (button==1? 0: button==3? 1: 2);
+}
+
+class SDLScopedLock
+{
+	public:
+		SDLScopedLock(SDL_mutex *m): myMutex(m)
+		{
+			SDL_LockMutex(myMutex);
+		}
+
+		~SDLScopedLock()
+		{
+			SDL_UnlockMutex(myMutex);
+		}
+
+	private:
+		SDL_mutex *myMutex;
+};
+
+class configHandler
+{
+	private:
+		vector<class configOptionHandler *> configOptionHandlers;
+
+	public:
+		void addConfigOptionHandler(class configOptionHandler *cs)
+		{ configOptionHandlers.push_back(cs); }
+
+		void removeConfigOptionHandler(class configOptionHandler *cs)
+		{
+			vector<class configOptionHandler*>::iterator it=
+				find(configOptionHandlers.begin(), configOptionHandlers.end(), cs);
+			if(it!=configOptionHandlers.end()) configOptionHandlers.erase(it);
+		}
+
+		bool writeToFile(const char *filename);
+		bool readFromFile(const char *filename);
+};
+
+configHandler gConfigHandler;
+
+class configOptionHandler
+{
+	private:
+		enum optionType
+		{
+			OT_FLOAT= 0,
+			OT_BOOL,
+			OT_INT
+		};
+		struct configOption
+		{
+			optionType type;
+			std::string name;
+			void *address;
+
+			std::string getString()
+			{
+				std::ostringstream s;
+				switch(type)
+				{
+					case OT_FLOAT:
+						s << *(float*)address;
+						return s.str();
+					case OT_BOOL:
+						s << *(bool*)address;
+						return s.str();
+					case OT_INT:
+						s << *(int*)address;
+						return s.str();
+					default:
+						return std::string("unknown option type!");
+				}
+			}
+
+			void putString(const std::string &str)
+			{
+				std::istringstream s(str);
+				switch(type)
+				{
+					case OT_FLOAT:
+						s >> *(float*)address;
+						break;
+					case OT_BOOL:
+						s >> *(bool*)address;
+						break;
+					case OT_INT:
+						s >> *(int*)address;
+						break;
+					default:
+						puts("unknown option type!");
+				}
+			}
+		};
+		vector<configOption> configOptions;
+		std::string name;
+
+		void addConfigOption(const char *name, optionType type, void *address)
+		{ configOptions.push_back( (configOption) { type, std::string(name), address } ); }
+
+	protected:
+		configOptionHandler(const char *_name):
+			name(_name)
+		{ gConfigHandler.addConfigOptionHandler(this); }
+
+		virtual ~configOptionHandler()
+		{ gConfigHandler.removeConfigOptionHandler(this); }
+
+		void addConfigOption(const char *name, float *address)
+		{ addConfigOption(name, OT_FLOAT, address); }
+
+		void addConfigOption(const char *name, bool *address)
+		{ addConfigOption(name, OT_BOOL, address); }
+
+		void addConfigOption(const char *name, int *address)
+		{ addConfigOption(name, OT_INT, address); }
+
+		#define ADD_CONFIG_OPTION(var) addConfigOption(#var, &var)
+
+	public:
+		const std::string &getName()
+		{ return name; }
+
+		std::string writeToString()
+		{
+			std::string ret;
+			for(vector<configOption>::iterator i= configOptions.begin(); i!=configOptions.end(); i++)
+				ret.append(name + "." + i->name + "=" + i->getString() + "\n");
+			return ret;
+		}
+
+		bool writeToFile(const char *filename)
+		{
+			FILE *f= fopen(filename, "a");
+			if(!f) return false;
+			std::string s= writeToString();
+			if(fwrite(s.c_str(), 1, s.length(), f)!=s.length())
+			{ fclose(f); return false; }
+			fclose(f);
+			return true;
+		}
+
+		bool readItem(const char *itemName, const char *itemValue)
+		{
+			for(vector<configOption>::iterator i= configOptions.begin(); i!=configOptions.end(); i++)
+			{
+				if(i->name==itemName)
+				{
+					i->putString(itemValue);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static bool parseLine(char *line, char *&name, char *&itemName, char *&itemValue)
+		{
+			name= line;
+			while(isspace(*name)) name++;
+			char *s= name; while(*s && !isspace(*s) && *s!='.') s++;
+			if(!*s) { *name= 0; itemName= itemValue= name; return true; }	// empty line
+			*s++= 0; while(*s && isspace(*s)) s++;
+			if(!*s) return false;
+			itemName= s;
+			while(*s && !isspace(*s) && *s!='=') s++;
+			if(!*s) return false;
+			*s++= 0; while(*s && isspace(*s)) s++;
+			if(!*s) return false;
+			itemValue= s;
+			return true;
+		}
+
+		bool readFromString(std::string src)
+		{
+			char line[1024];
+			int i= 1;
+			for(std::stringstream stream(src); !stream.eof(); i++)
+			{
+				stream.getline(line, sizeof(line));
+				char *name, *itemName, *itemValue;
+				if(!parseLine(line, name, itemName, itemValue))
+					printf("parse error at line %d\n", i);
+				else if(name==this->name)
+					readItem(itemName, itemValue);
+			}
+			return true;
+		}
+
+		bool readFromFile(const char *filename)
+		{
+			ifstream f;
+			f.open(filename, ios_base::in);
+			if(f.fail()) return false;
+			stringbuf sbuf;
+			f.get(sbuf, 0);
+			string str;
+			readFromString(sbuf.str());
+			return true;
+		}
+};
+
+
+bool configHandler::writeToFile(const char *filename)
+{
+	bool ok= true;
+	for(vector<configOptionHandler*>::iterator it= configOptionHandlers.begin(); it!=configOptionHandlers.end(); it++)
+		if(!(*it)->writeToFile(filename)) ok= false;
+	return ok;
+}
+
+bool configHandler::readFromFile(const char *filename)
+{
+	char *name, *itemName, *itemValue;
+	std::string lastName;
+	configOptionHandler *handler= 0;
+	char line[1024];
+
+	ifstream f;
+	f.open(filename, ios_base::in);
+	if(f.fail()) return false;
+	while(!f.eof())
+	{
+		f.getline(line, 1024);
+		if(f.fail() && !f.eof()) return false;
+		if(configOptionHandler::parseLine(line, name, itemName, itemValue))
+		{
+			if(lastName!=name)
+			{
+				handler= 0;
+				for(uint32_t i= 0; i<configOptionHandlers.size(); i++)
+				{
+					if(configOptionHandlers[i]->getName()==name)
+					{
+						handler= configOptionHandlers[i];
+						lastName= name;
+						break;
+					}
+				}
+				if(!handler) continue;
+			}
+			if(handler)
+                handler->readItem(itemName, itemValue);
+            else
+                printf("configOptionHandler for %s not found\n", name);
+		}
+		else printf("bad config line\n");
+	}
+	return true;
+}
+
+// lock-free single producer/single consumer ring buffer for multichannel sample data.
+// channels are stored planar, each in its own power-of-two sized ring, so the consumer can
+// read contiguous runs of samples per channel. the producer side (the jack realtime thread)
+// never allocates, locks or blocks: when there is not enough space for a whole period, the
+// period is dropped and counted in the overflow counters.
+class SampleRingBuffer
+{
+	public:
+		SampleRingBuffer(uint32_t nChannels, uint32_t minFrames):
+			nChannels(nChannels), writePos(0), readPos(0), overflowCount(0), droppedFrames(0), consumerWaiting(0),
+			wakeSerial(0), interrupted(0)
+		{
+			for(capacity= 1; capacity<minFrames; capacity<<= 1);
+			mask= capacity-1;
+			data.resize(nChannels);
+			for(uint32_t i= 0; i<nChannels; i++)
+				data[i].resize(capacity);
+		}
+
+		uint32_t getNumChannels()
+		{ return nChannels; }
+
+		uint32_t getCapacity()
+		{ return capacity; }
+
+		// producer side
+
+		uint32_t getWriteSpace()
+		{ return capacity - (writePos - __atomic_load_n(&readPos, __ATOMIC_ACQUIRE)); }
+
+		// copy nFrames of one channel to the current write position. the frames become
+		// visible to the consumer only after commitWrite() was called for them.
+		void writeChannel(uint32_t channel, const jack_default_audio_sample_t *src, uint32_t nFrames)
+		{
+			uint32_t start= writePos & mask;
+			uint32_t n1= min(nFrames, capacity-start);
+			memcpy(&data[channel][start], src, n1*sizeof(jack_default_audio_sample_t));
+			if(n1<nFrames)
+				memcpy(&data[channel][0], src+n1, (nFrames-n1)*sizeof(jack_default_audio_sample_t));
+		}
+
+		// publish the frames. this only makes a system call if the consumer is asleep in waitForData().
+		void commitWrite(uint32_t nFrames)
+		{
+			// sequentially consistent, so either the consumer sees the new position before it goes to
+			// sleep or this sees that it is waiting
+			__atomic_store_n(&writePos, writePos+nFrames, __ATOMIC_SEQ_CST);
+			if(__atomic_load_n(&consumerWaiting, __ATOMIC_SEQ_CST))
+				wake();
+		}
+
+		// called by the producer instead of writing when getWriteSpace() is too small
+		void countOverflow(uint32_t nFrames)
+		{
+			__atomic_store_n(&overflowCount, overflowCount+1, __ATOMIC_RELAXED);
+			__atomic_store_n(&droppedFrames, droppedFrames+nFrames, __ATOMIC_RELAXED);
+		}
+
+		// consumer side
+
+		uint32_t getReadSpace()
+		{ return __atomic_load_n(&writePos, __ATOMIC_ACQUIRE) - readPos; }
+
+		// get pointers to the longest contiguous run of readable frames, one pointer per channel.
+		// returns the number of frames in the run (0 if the ring is empty).
+		uint32_t getReadPointers(jack_default_audio_sample_t **channelPointers, uint32_t maxFrames= 0xFFFFFFFF)
+		{
+			uint32_t start= readPos & mask;
+			uint32_t nFrames= min(min(getReadSpace(), capacity-start), maxFrames);
+			for(uint32_t i= 0; i<nChannels; i++)
+				channelPointers[i]= &data[i][start];
+			return nFrames;
+		}
+
+		void commitRead(uint32_t nFrames)
+		{ __atomic_store_n(&readPos, readPos+nFrames, __ATOMIC_RELEASE); }
+
+		// sleep until frames are available, interruptWait() was called or the timeout has passed.
+		// returns true if there are frames to read.
+		bool waitForData(uint32_t timeoutMs)
+		{
+			uint32_t serial= __atomic_load_n(&wakeSerial, __ATOMIC_SEQ_CST);
+			if(__atomic_exchange_n(&interrupted, 0, __ATOMIC_SEQ_CST)) return getReadSpace();
+			__atomic_store_n(&consumerWaiting, 1, __ATOMIC_SEQ_CST);
+			if(__atomic_load_n(&writePos, __ATOMIC_SEQ_CST)==readPos)
+			{
+#ifdef __linux__
+				// returns right away if the producer has changed the serial in the meantime
+				timespec timeout= { time_t(timeoutMs/1000), long(timeoutMs%1000)*1000000L };
+				syscall(SYS_futex, &wakeSerial, FUTEX_WAIT_PRIVATE, serial, &timeout, 0, 0);
+#else
+				// no futex, look at the serial every millisecond
+				for(uint32_t waited= 0; __atomic_load_n(&wakeSerial, __ATOMIC_SEQ_CST)==serial && waited<timeoutMs; waited++)
+					usleep(1000);
+#endif
+			}
+			__atomic_store_n(&consumerWaiting, 0, __ATOMIC_RELAXED);
+			return getReadSpace();
+		}
+
+		// make the current or next waitForData() return, from any thread
+		void interruptWait()
+		{
+			__atomic_store_n(&interrupted, 1, __ATOMIC_SEQ_CST);
+			wake();
+		}
+
+		// number of periods the producer had to drop
+		uint32_t getOverflowCount()
+		{ return __atomic_load_n(&overflowCount, __ATOMIC_RELAXED); }
+
+		uint32_t getDroppedFrames()
+		{ return __atomic_load_n(&droppedFrames, __ATOMIC_RELAXED); }
+
+	private:
+		vector< vector<jack_default_audio_sample_t> > data;
+		uint32_t nChannels;
+		uint32_t capacity, mask;
+		uint32_t writePos;  // free-running frame counters, only modified by the producer...
+		uint32_t readPos;   // ...and the consumer respectively
+		uint32_t overflowCount;
+		uint32_t droppedFrames;
+		uint32_t consumerWaiting;   // set while the consumer sleeps in waitForData()
+		uint32_t wakeSerial;        // the consumer sleeps on this until it changes
+		uint32_t interrupted;
+
+		void wake()
+		{
+			__atomic_add_fetch(&wakeSerial, 1, __ATOMIC_SEQ_CST);
+#ifdef __linux__
+			syscall(SYS_futex, &wakeSerial, FUTEX_WAKE_PRIVATE, 1, 0, 0, 0);
+#endif
+		}
+};
+
+// a source of samples, which writes them into a ring buffer from its own thread
+class InputSource
+{
+	public:
+		virtual ~InputSource() { }
+
+		// start delivering samples of nChannels channels. returns false on failure.
+		virtual bool initialize(int nChannels)= 0;
+		virtual void shutdown()= 0;
+		virtual int getSamplingRate()= 0;
+		virtual bool isRunning()= 0;
+		// true for a source which has delivered all of its samples and won't deliver more,
+		// trying to initialize it again is pointless
+		virtual bool isFinished() { return false; }
+		// ring buffer which receives the samples. may be NULL before initialize().
+		virtual SampleRingBuffer *getRingBuffer()= 0;
+};
+
+// interface to jack audio
+class JackInterface: public InputSource
+{
+	public:
+		JackInterface(): client(0), ringBuffer(0), running(false)
+		{
+		}
+
+		~JackInterface()
+		{
+			if(client) jack_client_close(client);
+			if(ringBuffer) delete(ringBuffer);
+		}
+
+		bool initialize(int nChannels)
+		{
+			const char *client_name = "fluxscope";
+			const char *server_name = NULL;
+			jack_options_t options = JackNoStartServer;
+			jack_status_t status;
+
+			// a retry after the server went away starts over with a new client and new ports
+			if(client) jack_client_close(client), client= 0;
+			inputPorts.clear();
+			running= false;
+
+			client= jack_client_open (client_name, options, &status, server_name);
+			if (client == NULL) {
+				fprintf (stderr, "jack_client_open() failed, "
+					 "status = 0x%2.0x\n", status);
+				if (status & JackServerFailed) {
+					fprintf (stderr, "Unable to connect to JACK server\n");
+				}
+				return false;
+			}
+			if (status & JackServerStarted) {
+				fprintf (stderr, "JACK server started\n");
+			}
+			if (status & JackNameNotUnique) {
+				client_name = jack_get_client_name(client);
+				fprintf (stderr, "unique name `%s' assigned\n", client_name);
+			}
+
+			/* tell the JACK server to call `process()' whenever
+			   there is work to be done.
+			*/
+			jack_set_process_callback(client, jackProcess, this);
+
+			/* tell the JACK server to call `jack_shutdown()' if
+			   it ever shuts down, either entirely, or if it
+			   just decides to stop calling us.
+			*/
+			jack_on_info_shutdown (client, jackInfoShutdownCB, this);
+
+			/* display the current sample rate.
+			 */
+			fprintf(stderr, "engine sample rate: %d\n", jack_get_sample_rate(client));
+
+			/* create ports */
+			inputPorts.reserve(nChannels);
+			for(int i= 0; i<nChannels; i++)
+			{
+				char portName[64];
+				snprintf(portName, 64, "input%02d", i);
+				jack_port_t *inputPort= jack_port_register (client, portName,
+															JACK_DEFAULT_AUDIO_TYPE,
+															JackPortIsInput, 0);
+				if ((inputPort == NULL)) {
+					fprintf(stderr, "no more JACK ports available\n");
+					return false;
+				}
+				inputPorts.push_back(inputPort);
+			}
+
+			// allocate the ring buffer, large enough to bridge about half a second of display stalls
+			if(ringBuffer) delete(ringBuffer), ringBuffer= 0;
+			ringBuffer= new SampleRingBuffer(nChannels, max(jack_get_buffer_size(client)*4, jack_get_sample_rate(client)/2));
+
+			/* Tell the JACK server that we are ready to roll.  Our
+			 * process() callback will start running now. */
+			if (jack_activate (client)) {
+				fprintf (stderr, "cannot activate client");
+				return false;
+			}
+
+			return (running= true);
+		}
+
+		void shutdown()
+		{
+		    if(!running) return;
+		    jack_deactivate(client);
+		    jack_client_close(client);
+		    client= 0;
+		    running= false;
+		}
+
+		int getSamplingRate()
+		{
+			if(running)
+				return jack_get_sample_rate(client);
+			else
+				return 48000;
+		}
+
+		bool isRunning()
+		{
+			return running;
+		}
+
+		// ring buffer which receives the samples from the realtime thread. may be NULL before initialize().
+		SampleRingBuffer *getRingBuffer()
+		{
+			return ringBuffer;
+		}
+
+	private:
+		vector<jack_port_t *> inputPorts;
+		jack_client_t *client;
+		SampleRingBuffer *ringBuffer;
+		bool running;
+
+		// realtime thread: only copies into the ring buffer, never blocks or allocates.
+		int process(jack_nframes_t nframes)
+		{
+			if(ringBuffer->getWriteSpace()<nframes)
+			{
+				ringBuffer->countOverflow(nframes);
+				return 0;
+			}
+
+			uint32_t n= min(uint32_t(inputPorts.size()), ringBuffer->getNumChannels());
+			for(uint32_t i= 0; i<n; i++)
+				ringBuffer->writeChannel(i, (jack_default_audio_sample_t*)jack_port_get_buffer(inputPorts[i], nframes), nframes);
+			ringBuffer->commitWrite(nframes);
+
+			return 0;
+		}
+
+		static int jackProcess(jack_nframes_t nframes, void *arg)
+		{
+			return reinterpret_cast<JackInterface*>(arg)->process(nframes);
+		}
+
+		void jackInfoShutdown(jack_status_t code, const char *reason)
+		{
+			printf("JACK shutdown: %s\n", reason);
+			running= false;
+		}
+
+		static void jackInfoShutdownCB(jack_status_t code, const char *reason, void *arg)
+		{
+			reinterpret_cast<JackInterface*>(arg)->jackInfoShutdown(code, reason);
+		}
+};
+
+// replays a WAV file (16/24/32 bit integer or 32/64 bit float PCM, RIFF or RF64) or a file of raw interleaved
+// 32 bit floats. the file is memory-mapped and a thread feeds it into the ring buffer in periods, the same way
+// the jack callback does. the replay speed is a multiple of realtime; like jack, a realtime replay drops
+// periods when the ring buffer is full. speed 0 replays as fast as the processing consumes the samples and
+// waits for ring buffer space instead, so every sample is processed and the result is deterministic.
+class FileInputSource: public InputSource
+{
+	public:
+		FileInputSource(const char *filename): filename(filename), speed(1), loop(false), rawRate(48000), rawChannels(1),
+			map(0), mapSize(0), ringBuffer(0), thread(0), quit(false), running(false), finished(false)
+		{
+		}
+
+		~FileInputSource()
+		{
+			shutdown();
+			if(map) munmap(map, mapSize);
+			if(ringBuffer) delete(ringBuffer);
+		}
+
+		// multiple of realtime, 0 for as fast as possible
+		void setSpeed(double s)
+		{ speed= max(s, 0.0); }
+
+		// start over at the end of the file instead of finishing
+		void setLoop(bool l)
+		{ loop= l; }
+
+		// format of raw files, which have no header
+		void setRawFormat(int rate, int channels)
+		{ rawRate= rate; rawChannels= channels; }
+
+		// file channels are mapped to the input channels in turn, so a file with few channels can feed many inputs
+		bool initialize(int nChannels)
+		{
+			shutdown();
+			if(!map && !openFile()) return false;
+			if(ringBuffer) delete(ringBuffer), ringBuffer= 0;
+			ringBuffer= new SampleRingBuffer(nChannels, max(periodFrames*4, uint32_t(rate/2)));
+			position= 0;
+			finished= false;
+			quit= false;
+			running= true;
+			thread= SDL_CreateThread(threadFunc, this);
+			return true;
+		}
+
+		void shutdown()
+		{
+			if(!thread) return;
+			__atomic_store_n(&quit, true, __ATOMIC_RELEASE);
+			SDL_WaitThread(thread, 0);
+			thread= 0;
+			running= false;
+		}
+
+		int getSamplingRate()
+		{ return map? rate: 48000; }
+
+		bool isRunning()
+		{ return __atomic_load_n(&running, __ATOMIC_ACQUIRE); }
+
+		bool isFinished()
+		{ return __atomic_load_n(&finished, __ATOMIC_ACQUIRE); }
+
+		SampleRingBuffer *getRingBuffer()
+		{ return ringBuffer; }
+
+	private:
+		enum SampleFormat { SF_INT16, SF_INT24, SF_INT32, SF_FLOAT32, SF_FLOAT64 };
+		static const uint32_t periodFrames= 256;
+
+		string filename;
+		double speed;
+		bool loop;
+		int rawRate, rawChannels;
+		uint8_t *map;
+		size_t mapSize;
+		// format and location of the samples in the map
+		SampleFormat format;
+		int rate;
+		unsigned fileChannels;
+		uint32_t bytesPerFrame;
+		const uint8_t *frameData;
+		uint64_t nFrames;
+		uint64_t position;
+		SampleRingBuffer *ringBuffer;
+		SDL_Thread *thread;
+		bool quit, running, finished;
+
+		static uint32_t le16(const uint8_t *p)
+		{ return p[0] | (p[1]<<8); }
+
+		static uint32_t le32(const uint8_t *p)
+		{ return p[0] | (p[1]<<8) | (p[2]<<16) | (uint32_t(p[3])<<24); }
+
+		static uint64_t le64(const uint8_t *p)
+		{ return le32(p) | (uint64_t(le32(p+4))<<32); }
+
+		bool openFile()
+		{
+			int fd= open(filename.c_str(), O_RDONLY);
+			if(fd<0)
+			{
+				fprintf(stderr, "couldn't open %s: %s\n", filename.c_str(), strerror(errno));
+				return false;
+			}
+			struct stat st;
+			void *m= MAP_FAILED;
+			if(!fstat(fd, &st) && st.st_size>0)
+				m= mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			close(fd);
+			if(m==MAP_FAILED)
+			{
+				fprintf(stderr, "couldn't map %s\n", filename.c_str());
+				return false;
+			}
+			map= (uint8_t*)m;
+			mapSize= st.st_size;
+			madvise(map, mapSize, MADV_SEQUENTIAL);
+
+			bool ok;
+			if(mapSize>=12 && (!memcmp(map, "RIFF", 4) || !memcmp(map, "RF64", 4)) && !memcmp(map+8, "WAVE", 4))
+				ok= parseWav();
+			else
+			{
+				format= SF_FLOAT32;
+				rate= rawRate;
+				fileChannels= rawChannels;
+				bytesPerFrame= 4*fileChannels;
+				frameData= map;
+				nFrames= mapSize/bytesPerFrame;
+				ok= (nFrames>0);
+				if(!ok) fprintf(stderr, "%s: no samples\n", filename.c_str());
+			}
+			if(!ok)
+			{
+				munmap(map, mapSize);
+				map= 0;
+				return false;
+			}
+			fprintf(stderr, "%s: %u channels, %d Hz, %.1f seconds\n", filename.c_str(), fileChannels, rate, double(nFrames)/rate);
+			return true;
+		}
+
+		bool parseWav()
+		{
+			const uint8_t *p= map+12, *end= map+mapSize;
+			uint64_t rf64DataSize= 0;
+			bool haveFormat= false;
+			while(p+8<=end)
+			{
+				uint64_t size= le32(p+4);
+				const uint8_t *chunk= p+8;
+				if(!memcmp(p, "ds64", 4) && size>=16)
+					rf64DataSize= le64(chunk+8);
+				else if(!memcmp(p, "fmt ", 4) && size>=16)
+				{
+					unsigned tag= le16(chunk);
+					if(tag==0xFFFE && size>=26)     // WAVE_FORMAT_EXTENSIBLE: the format tag starts the subformat GUID
+						tag= le16(chunk+24);
+					fileChannels= le16(chunk+2);
+					rate= le32(chunk+4);
+					bytesPerFrame= le16(chunk+12);
+					unsigned bits= le16(chunk+14);
+					if(tag==1 && bits==16) format= SF_INT16;
+					else if(tag==1 && bits==24) format= SF_INT24;
+					else if(tag==1 && bits==32) format= SF_INT32;
+					else if(tag==3 && bits==32) format= SF_FLOAT32;
+					else if(tag==3 && bits==64) format= SF_FLOAT64;
+					else
+					{
+						fprintf(stderr, "%s: unsupported sample format %u, %u bits\n", filename.c_str(), tag, bits);
+						return false;
+					}
+					haveFormat= (fileChannels>0 && rate>0 && bytesPerFrame>=fileChannels*bits/8);
+				}
+				else if(!memcmp(p, "data", 4) && haveFormat)
+				{
+					if(size==0xFFFFFFFF && rf64DataSize) size= rf64DataSize;
+					frameData= chunk;
+					nFrames= min(size, uint64_t(end-chunk))/bytesPerFrame;
+					if(!nFrames) fprintf(stderr, "%s: no samples\n", filename.c_str());
+					return nFrames>0;
+				}
+				if(size>uint64_t(end-chunk)) break;
+				p= chunk+size+(size&1);
+			}
+			fprintf(stderr, "%s: no %s chunk\n", filename.c_str(), haveFormat? "data": "valid format");
+			return false;
+		}
+
+		// convert n frames of one file channel, starting at frame position, to floats
+		void readChannel(unsigned channel, uint64_t position, uint32_t n, jack_default_audio_sample_t *dest)
+		{
+			const uint8_t *p= frameData+position*bytesPerFrame;
+			switch(format)
+			{
+				case SF_INT16:
+					for(uint32_t i= 0; i<n; i++, p+= bytesPerFrame)
+						dest[i]= int16_t(le16(p+channel*2)) * (1.0f/32768);
+					break;
+				case SF_INT24:
+					for(uint32_t i= 0; i<n; i++, p+= bytesPerFrame)
+					{
+						const uint8_t *s= p+channel*3;
+						dest[i]= (int32_t(s[0]<<8 | s[1]<<16 | uint32_t(s[2])<<24) >> 8) * (1.0f/8388608);
+					}
+					break;
+				case SF_INT32:
+					for(uint32_t i= 0; i<n; i++, p+= bytesPerFrame)
+						dest[i]= int32_t(le32(p+channel*4)) * (1.0f/2147483648.0f);
+					break;
+				case SF_FLOAT32:
+					for(uint32_t i= 0; i<n; i++, p+= bytesPerFrame)
+					{
+						uint32_t bits= le32(p+channel*4);
+						float f;
+						memcpy(&f, &bits, 4);
+						dest[i]= f;
+					}
+					break;
+				case SF_FLOAT64:
+					for(uint32_t i= 0; i<n; i++, p+= bytesPerFrame)
+					{
+						uint64_t bits= le64(p+channel*8);
+						double d;
+						memcpy(&d, &bits, 8);
+						dest[i]= d;
+					}
+					break;
+			}
+		}
+
+		static int threadFunc(void *arg)
+		{
+			reinterpret_cast<FileInputSource*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			uint32_t nChannels= ringBuffer->getNumChannels();
+			unsigned nRead= min(nChannels, fileChannels);
+			vector<jack_default_audio_sample_t> periodData(size_t(nRead)*periodFrames);
+			double startTime= getTime();
+			uint64_t framesFed= 0;
+
+			while(!__atomic_load_n(&quit, __ATOMIC_ACQUIRE))
+			{
+				if(position>=nFrames)
+				{
+					if(!loop) break;
+					position= 0;
+				}
+				uint32_t n= uint32_t(min(uint64_t(periodFrames), nFrames-position));
+
+				if(speed>0)
+				{
+					// the period is due when the replay clock reaches its end, like a jack period
+					double delay= startTime + (framesFed+n)/(rate*speed) - getTime();
+					if(delay>0) usleep(useconds_t(delay*1000000));
+				}
+				else if(ringBuffer->getWriteSpace()<n)
+				{
+					// wait for the processing to catch up
+					usleep(1000);
+					continue;
+				}
+
+				if(ringBuffer->getWriteSpace()<n)
+					ringBuffer->countOverflow(n);
+				else
+				{
+					for(unsigned i= 0; i<nRead; i++)
+						readChannel(i, position, n, &periodData[size_t(i)*periodFrames]);
+					for(uint32_t i= 0; i<nChannels; i++)
+						ringBuffer->writeChannel(i, &periodData[size_t(i%nRead)*periodFrames], n);
+					ringBuffer->commitWrite(n);
+				}
+				position+= n;
+				framesFed+= n;
+			}
+
+			if(position>=nFrames && !loop)
+				__atomic_store_n(&finished, true, __ATOMIC_RELEASE);
+			__atomic_store_n(&running, false, __ATOMIC_RELEASE);
+		}
+};
+
+
+class fluxWindowBase
+{
+	private:
+		static void basePaintCB(prop_t arg, struct primitive *self, rect *abspos, const rectlist *dirty_rects)
+		{
+			reinterpret_cast<fluxWindowBase*>(arg)->cbPaint(self, abspos, dirty_rects);
+		}
+
+		static int baseMouseCB(prop_t arg, struct primitive *self, int type, int x, int y, int btn)
+		{
+			reinterpret_cast<fluxWindowBase*>(arg)->cbMouse(self, type, x, y, btn);
+			return 1;
+		}
+
+	protected:
+		uint32_t fluxHandle;
+
+		enum
+		{
+//			CB_KEYBD_FLAG= (1<<CB_KEYBD),
+			CB_MOUSE_FLAG= (1<<primitive::CB_MOUSE),
+			CB_PAINT_FLAG= (1<<primitive::CB_PAINT),
+//			CB_PROPS_FLAG= (1<<CB_PROPS),
+//			CB_STATUS_FLAG= (1<<CB_STATUS)
+		};
+
+		fluxWindowBase(int x, int y, int w, int h, uint32_t callbackFlags, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP)
+		{
+			fluxHandle= create_rect(parent, x,y, w,h, COL_WINDOW, alignment);
+			if(callbackFlags&CB_PAINT_FLAG) wnd_set_paint_callback(fluxHandle, basePaintCB, reinterpret_cast<prop_t>(this));
+			if(callbackFlags&CB_MOUSE_FLAG) wnd_set_mouse_callback(fluxHandle, baseMouseCB, reinterpret_cast<prop_t>(this));
+			wnd_setresizable(fluxHandle, false);
+		}
+
+		virtual ~fluxWindowBase()
+		{
+			if(fluxHandle!=NOWND) wnd_destroy(fluxHandle);
+			fluxHandle= NOWND;
+		}
+
+		virtual void cbPaint(primitive *self, rect *abspos, const rectlist *dirty_rects) { }
+		virtual void cbMouse(primitive *self, int type, int x, int y, int btn) { }
+};
+
+
+
+class CFilterButterworth24db
+{
+public:
+    CFilterButterworth24db(void);
+    ~CFilterButterworth24db(void);
+    void SetSampleRate(float fs);
+    void Set(float cutoff, float q);
+    float Run(float input);
+
+private:
+    float t0, t1, t2, t3;
+    float coef0, coef1, coef2, coef3;
+    float history1, history2, history3, history4;
+    float gain;
+    float min_cutoff, max_cutoff;
+};
+
+// FilterButterworth24db.cpp
+
+#define BUDDA_Q_SCALE 1.f
+
+CFilterButterworth24db::CFilterButterworth24db(void)
+{
+    this->history1 = 0.f;
+    this->history2 = 0.f;
+    this->history3 = 0.f;
+    this->history4 = 0.f;
+
+    this->SetSampleRate(44100.f);
+    this->Set(22050.f, 0.0);
+}
+
+CFilterButterworth24db::~CFilterButterworth24db(void)
+{
+}
+
+void CFilterButterworth24db::SetSampleRate(float fs)
+{
+    float pi = 4.f * atanf(1.f);
+
+    this->t0 = 4.f * fs * fs;
+    this->t1 = 8.f * fs * fs;
+    this->t2 = 2.f * fs;
+    this->t3 = pi / fs;
+
+    this->min_cutoff = fs * 0.01f;
+    this->max_cutoff = fs * 0.45f;
+}
+
+void CFilterButterworth24db::Set(float cutoff, float q)
+{
+    if (cutoff < this->min_cutoff)
+        cutoff = this->min_cutoff;
+    else if(cutoff > this->max_cutoff)
+        cutoff = this->max_cutoff;
+
+    if(q < 0.f)
+        q = 0.f;
+    else if(q > 1.f)
+        q = 1.f;
+
+    float wp = this->t2 * tanf(this->t3 * cutoff);
+    float bd, bd_tmp, b1, b2;
+
+    q *= BUDDA_Q_SCALE;
+    q += 1.f;
+
+    b1 = (0.765367f / q) / wp;
+    b2 = 1.f / (wp * wp);
+
+    bd_tmp = this->t0 * b2 + 1.f;
+
+    bd = 1.f / (bd_tmp + this->t2 * b1);
+
+    this->gain = bd * 0.5f;
+
+    this->coef2 = (2.f - this->t1 * b2);
+
+    this->coef0 = this->coef2 * bd;
+    this->coef1 = (bd_tmp - this->t2 * b1) * bd;
+
+    b1 = (1.847759f / q) / wp;
+
+    bd = 1.f / (bd_tmp + this->t2 * b1);
+
+    this->gain *= bd;
+    this->coef2 *= bd;
+    this->coef3 = (bd_tmp - this->t2 * b1) * bd;
+}
+
+float CFilterButterworth24db::Run(float input)
+{
+    float output = input * this->gain;
+    float new_hist;
+
+    output -= this->history1 * this->coef0;
+    new_hist = output - this->history2 * this->coef1;
+
+    output = new_hist + this->history1 * 2.f;
+    output += this->history2;
+
+    this->history2 = this->history1;
+    this->history1 = new_hist;
+
+    output -= this->history3 * this->coef2;
+    new_hist = output - this->history4 * this->coef3;
+
+    output = new_hist + this->history3 * 2.f;
+    output += this->history4;
+
+    this->history4 = this->history3;
+    this->history3 = new_hist;
+
+    return output;
+}
+
+// coefficients of a biquad section in transposed direct form II:
+// y= b0*x + s1, s1= b1*x - a1*y + s2, s2= b2*x - a2*y
+struct Biquad
+{
+    float b0, b1, b2, a1, a2;
+};
+
+// something from http://www.musicdsp.org/showArchiveComment.php?ArchiveID=227
+// now with unity gain, a high pass version and any even order. the sections feed the filter bank,
+// run() filters in double precision and serves as the reference for it.
+class Butterworth
+{
+    public:
+        enum { MAXSECTIONS= 4 };
+
+        Butterworth()
+        {
+            memset(this, 0, sizeof(*this));
+            setFrequency(5000, 44100);
+        }
+
+        // order is rounded down to an even number between 2 and 2*MAXSECTIONS
+        void setFrequency(double Frequency, double Samplerate, bool highpass= false, int order= 4)
+        {
+            nSections= (order<2? 1: order>2*MAXSECTIONS? MAXSECTIONS: order/2);
+
+            // First calculate the prewarped digital frequency:
+            double K = tan(M_PI * Frequency / Samplerate);
+
+            for(int i= 0; i<nSections; i++)
+            {
+                // damping of the section (see 'Factors of Polynoms' at http://en.wikipedia.org/wiki/Butterworth_filter),
+                // 0.76536686473 and 1.84775906502 for 24dB/Oct
+                double d = 2*sin(M_PI*(2*i+1)/(4*nSections));
+                double norm = 1.0/(K*K + d*K + 1);
+                double *c = coefs[i];
+                c[0] = (highpass? 1: K*K)*norm;
+                c[1] = (highpass? -2: 2)*c[0];
+                c[2] = c[0];
+                c[3] = 2*(K*K-1)*norm;
+                c[4] = (K*K - d*K + 1)*norm;
+            }
+            memset(state, 0, sizeof(state));
+        }
+
+        int getNumSections()
+        { return nSections; }
+
+        Biquad getSection(int i)
+        {
+            Biquad b= { float(coefs[i][0]), float(coefs[i][1]), float(coefs[i][2]), float(coefs[i][3]), float(coefs[i][4]) };
+            return b;
+        }
+
+        double run(double Input)
+        {
+            double Output = Input;
+            for(int i= 0; i<nSections; i++)
+            {
+                const double *c = coefs[i];
+                double x = Output;
+                Output = c[0]*x + state[i][0];
+                state[i][0] = c[1]*x - c[3]*Output + state[i][1];
+                state[i][1] = c[2]*x - c[4]*Output;
+            }
+            return Output;
+        }
+
+    private:
+        int nSections;
+        double coefs[MAXSECTIONS][5];
+        double state[MAXSECTIONS][2];
+};
+
+
+// tracks the peak level of a signal: the maximum absolute value over the last nSamples samples, smoothed
+// with a fast attack/slow release filter. blocks are processed in passes: the absolute values, then the
+// sliding window maximum by doubling (after k passes each value is the maximum of 2^k samples, and any
+// window is covered by two of those overlapping), both a vector at a time, then the smoothing filter.
+// the filter is a serial recursion, bound by the latency of its arithmetic, so the filters of GROUP
+// channels run side by side in the lanes of two vectors, which keeps that many recursions in flight.
+class PeakTracker
+{
+    public:
+        enum { MAXSAMPLES= 16, CHUNKSIZE= 256, GROUP= 4 };
+
+        PeakTracker(): peakFiltered(0), nSamples(1)
+        { memset(history, 0, sizeof(history)); setNumSamples(1); }
+
+        void setNumSamples(double n)
+        {
+            if(n>128) n= 128;
+            peakStep= 1.0/pow(n, 1.5);
+            peakStep2= 10*peakStep; if(peakStep2>1.0) peakStep2= 1.0;
+            n= (n>MAXSAMPLES-1? MAXSAMPLES-1: n<1? 1: n);
+            nSamples= n+0.5;
+        }
+
+        // process a block of samples of each of nChannels channels, with trackers[ch] for channel ch.
+        // in[ch] and out[ch] may be the same buffer.
+        static void run(PeakTracker *trackers, const float * const *in, float * const *out, unsigned nChannels, uint32_t nFrames)
+        {
+            for(unsigned ch= 0; ch<nChannels; ch+= GROUP)
+                for(uint32_t pos= 0; pos<nFrames; pos+= CHUNKSIZE)
+                    runChunks(trackers+ch, in+ch, out+ch, min(nChannels-ch, (unsigned)GROUP),
+                              pos, min(nFrames-pos, (uint32_t)CHUNKSIZE));
+        }
+
+    private:
+        double peakFiltered;
+        float peakStep, peakStep2;
+        unsigned nSamples;
+        float history[MAXSAMPLES-1];    // absolute values of the last samples, newest last
+
+        // absolute values, with NaNs as 0 so they never become the peak
+        static void absValues(const float *in, float *out, uint32_t n)
+        {
+            uint32_t i= 0;
+#ifdef __SSE2__
+            const __m128 signBit= _mm_set1_ps(-0.0f), zero= _mm_setzero_ps();
+            for(; i+4<=n; i+= 4)
+                _mm_storeu_ps(out+i, _mm_max_ps(_mm_andnot_ps(signBit, _mm_loadu_ps(in+i)), zero));
+#endif
+            for(; i<n; i++)
+            {
+                float sAbs= fabs(in[i]);
+                out[i]= (sAbs>0? sAbs: 0);
+            }
+        }
+
+        // dest[i]= max(a[i], b[i]). dest may be a, with b above it in the same buffer.
+        static void maxValues(float *dest, const float *a, const float *b, uint32_t n)
+        {
+            uint32_t i= 0;
+#ifdef __SSE2__
+            for(; i+4<=n; i+= 4)
+                _mm_storeu_ps(dest+i, _mm_max_ps(_mm_loadu_ps(a+i), _mm_loadu_ps(b+i)));
+#endif
+            for(; i<n; i++)
+                dest[i]= max(a[i], b[i]);
+        }
+
+        // the window maximum for each sample of a chunk, in x or in peaks. x must have room for the window
+        // preceding the chunk plus the chunk, peaks for the chunk.
+        const float *findPeaks(const float *in, uint32_t nFrames, float *x, float *peaks)
+        {
+            // x holds the absolute values of the window preceding the first sample, followed by the chunk
+            const uint32_t w= nSamples, pre= w-1, n= pre+nFrames;
+            memcpy(x, history+(MAXSAMPLES-1-pre), pre*sizeof(float));
+            absValues(in, x+pre, nFrames);
+
+            if(n>=MAXSAMPLES-1)
+                memcpy(history, x+n-(MAXSAMPLES-1), (MAXSAMPLES-1)*sizeof(float));
+            else
+            {
+                memmove(history, history+nFrames, (MAXSAMPLES-1-nFrames)*sizeof(float));
+                memcpy(history+(MAXSAMPLES-1-nFrames), x+pre, nFrames*sizeof(float));
+            }
+
+            // the window of sample i is x[i, i+pre]. span is the largest power of 2 not above its size.
+            if(w==1) return x;
+            uint32_t span= 1;
+            for(; span*2<=w; span*= 2)
+                maxValues(x, x, x+span, n-span*2+1);
+            maxValues(peaks, x, x+w-span, nFrames);
+            return peaks;
+        }
+
+        // process a chunk of up to GROUP channels, samples [pos, pos+nFrames) of each. the lanes of the
+        // missing channels filter a copy of the first one, and their output goes nowhere.
+        static void runChunks(PeakTracker *trackers, const float * const *in, float * const *out, unsigned count,
+                              uint32_t pos, uint32_t nFrames)
+        {
+            float x[GROUP][MAXSAMPLES-1+CHUNKSIZE], peaks[GROUP][CHUNKSIZE], unused[CHUNKSIZE];
+            const float *peak[GROUP];
+            float *dest[GROUP];
+            double filtered[GROUP], step[GROUP], step2[GROUP];
+            for(unsigned k= 0; k<GROUP; k++)
+            {
+                PeakTracker &t= trackers[k<count? k: 0];
+                peak[k]= (k<count? t.findPeaks(in[k]+pos, nFrames, x[k], peaks[k]): peak[0]);
+                dest[k]= (k<count? out[k]+pos: unused);
+                filtered[k]= t.peakFiltered;
+                step[k]= t.peakStep;
+                step2[k]= t.peakStep2;
+            }
+            filter(peak, dest, filtered, step, step2, nFrames);
+            for(unsigned k= 0; k<count; k++)
+                trackers[k].peakFiltered= filtered[k];
+        }
+
+        // the smoothing filter of GROUP channels, one lane each. the lanes do the same double precision
+        // arithmetic as a scalar filter would, so the output is the same.
+        static void filter(const float * const *peak, float * const *dest, double *filtered,
+                           const double *step, const double *step2, uint32_t n)
+        {
+#ifdef __SSE2__
+            const float *p0= peak[0], *p1= peak[1], *p2= peak[2], *p3= peak[3];
+            float *d0= dest[0], *d1= dest[1], *d2= dest[2], *d3= dest[3];
+            __m128d f01= _mm_loadu_pd(filtered), f23= _mm_loadu_pd(filtered+2);
+            const __m128d s01= _mm_loadu_pd(step), s23= _mm_loadu_pd(step+2);
+            const __m128d t01= _mm_loadu_pd(step2), t23= _mm_loadu_pd(step2+2);
+            for(uint32_t i= 0; i<n; i++)
+            {
+                __m128d v01= _mm_set_pd(p1[i], p0[i]), v23= _mm_set_pd(p3[i], p2[i]);
+                __m128d up01= _mm_cmpgt_pd(v01, f01), up23= _mm_cmpgt_pd(v23, f23);
+                f01= _mm_add_pd(f01, _mm_mul_pd(_mm_sub_pd(v01, f01), _mm_or_pd(_mm_and_pd(up01, t01), _mm_andnot_pd(up01, s01))));
+                f23= _mm_add_pd(f23, _mm_mul_pd(_mm_sub_pd(v23, f23), _mm_or_pd(_mm_and_pd(up23, t23), _mm_andnot_pd(up23, s23))));
+                __m128 o01= _mm_cvtpd_ps(f01), o23= _mm_cvtpd_ps(f23);
+                _mm_store_ss(d0+i, o01); _mm_store_ss(d1+i, _mm_shuffle_ps(o01, o01, 1));
+                _mm_store_ss(d2+i, o23); _mm_store_ss(d3+i, _mm_shuffle_ps(o23, o23, 1));
+            }
+            _mm_storeu_pd(filtered, f01);
+            _mm_storeu_pd(filtered+2, f23);
+#else
+            for(unsigned k= 0; k<GROUP; k++)
+                for(uint32_t i= 0; i<n; i++)
+                {
+                    double p= peak[k][i];
+                    filtered[k]+= (p-filtered[k]) * (p>filtered[k]? step2[k]: step[k]);
+                    dest[k][i]= filtered[k];
+                }
+#endif
+        }
+};
+
+// heap allocations through operator new and allocateAligned() so far. the benchmarks check with it that
+// a code path doesn't allocate.
+uint32_t gAllocationCount= 0;
+
+#if __cplusplus<201103L
+void *operator new(size_t bytes) throw(std::bad_alloc)
+#else
+void *operator new(size_t bytes)
+#endif
+{
+	__atomic_add_fetch(&gAllocationCount, 1, __ATOMIC_RELAXED);
+	void *mem= malloc(max(bytes, size_t(1)));
+	if(!mem) throw std::bad_alloc();
+	return mem;
+}
+
+// memory for the sample and display buffers is aligned to cache lines, which also suits the SIMD kernels
+enum { BUFFER_ALIGNMENT= 64 };
+
+void *allocateAligned(size_t bytes)
+{
+	void *mem;
+	__atomic_add_fetch(&gAllocationCount, 1, __ATOMIC_RELAXED);
+	if(posix_memalign(&mem, BUFFER_ALIGNMENT, max(bytes, size_t(1))))
+		throw std::bad_alloc();
+	return mem;
+}
+
+// a resizable array of plain data in aligned memory. unlike a vector it only allocates when it grows past
+// its capacity, copies go into the storage the destination already has, and shrinking keeps the memory.
+// reserve the largest size which is going to be needed up front, and resizing is free of heap traffic.
+template<class T> class AlignedArray
+{
+	public:
+		AlignedArray(): data(0), count(0), capacity(0)
+		{ }
+
+		AlignedArray(const AlignedArray &other): data(0), count(0), capacity(0)
+		{ *this= other; }
+
+		~AlignedArray()
+		{ free(data); }
+
+		AlignedArray &operator=(const AlignedArray &other)
+		{
+			if(this==&other) return *this;
+			reserve(other.capacity);
+			count= other.count;
+			if(count) memcpy(data, other.data, count*sizeof(T));
+			return *this;
+		}
+
+		void reserve(size_t n)
+		{
+			if(n<=capacity) return;
+			T *newData= (T*)allocateAligned(n*sizeof(T));
+			if(count) memcpy(newData, data, count*sizeof(T));
+			free(data);
+			data= newData;
+			capacity= n;
+		}
+
+		// new elements are zero, like those of a vector of plain data
+		void resize(size_t n)
+		{
+			if(n>capacity) reserve(max(n, capacity*2));
+			if(n>count) memset(data+count, 0, (n-count)*sizeof(T));
+			count= n;
+		}
+
+		void assign(size_t n, const T &value)
+		{
+			count= 0;
+			resize(n);
+			for(size_t i= 0; i<n; i++) data[i]= value;
+		}
+
+		size_t size() const
+		{ return count; }
+
+		bool empty() const
+		{ return !count; }
+
+		size_t getCapacity() const
+		{ return capacity; }
+
+		T &operator[](size_t i)
+		{ return data[i]; }
+
+		const T &operator[](size_t i) const
+		{ return data[i]; }
+
+		T *begin()
+		{ return data; }
+
+		const T *begin() const
+		{ return data; }
+
+		T *end()
+		{ return data+count; }
+
+		const T *end() const
+		{ return data+count; }
+
+	private:
+		T *data;
+		size_t count, capacity;
+};
+
+// one aligned block of memory handed out in pieces, for buffers which are set up together and go away
+// together. reset() takes all pieces back at once, and only reserve() ever allocates.
+class AlignedArena
+{
+	public:
+		AlignedArena(): block(0), capacity(0), used(0)
+		{ }
+
+		~AlignedArena()
+		{ free(block); }
+
+		// bytes taken up by a piece of this many bytes
+		static size_t roundUp(size_t bytes)
+		{ return (bytes+BUFFER_ALIGNMENT-1) & ~size_t(BUFFER_ALIGNMENT-1); }
+
+		// make room for at least this many bytes, which takes back all pieces. the memory is not touched
+		// here, large blocks are only faulted in as far as they are used.
+		void reserve(size_t bytes)
+		{
+			used= 0;
+			if(bytes<=capacity) return;
+			free(block);
+			block= 0;
+			capacity= 0;
+			block= (uint8_t*)allocateAligned(bytes);
+			capacity= bytes;
+		}
+
+		void reset()
+		{ used= 0; }
+
+		// returns 0 if it doesn't fit
+		template<class T> T *allocate(size_t n)
+		{
+			size_t bytes= roundUp(n*sizeof(T));
+			if(bytes>capacity-used) return 0;
+			T *p= (T*)(block+used);
+			used+= bytes;
+			return p;
+		}
+
+		size_t getCapacity() const
+		{ return capacity; }
+
+	private:
+		uint8_t *block;
+		size_t capacity, used;
+
+		AlignedArena(const AlignedArena &);
+		AlignedArena &operator=(const AlignedArena &);
+};
+
+// multi-level min/max/rms decimation of a sample buffer. level 0 summarizes blocks of BASEBLOCK samples,
+// each further level halves the resolution. entries are updated incrementally as samples are written,
+// so the cost per sample is amortized O(1), and any column of the display can then be summarized by
+// looking at one or two entries of the right level instead of rescanning the samples.
+class DecimationPyramid
+{
+	public:
+		enum { BASESHIFT= 4, BASEBLOCK= 1<<BASESHIFT };
+
+		struct Entry
+		{
+			float min, max;
+			float sumSquares;
+			uint32_t count;
+
+			void merge(const Entry &e)
+			{
+				if(e.min<min) min= e.min;
+				if(e.max>max) max= e.max;
+				sumSquares+= e.sumSquares;
+				count+= e.count;
+			}
+
+			float rms() const
+			{ return count? sqrtf(sumSquares/count): 0; }
+		};
+
+		DecimationPyramid(): nLevels(0), size(0)
+		{ }
+
+		// bytes of arena memory taken by the entries for nSamples
+		static size_t getArenaBytes(uint32_t nSamples)
+		{
+			size_t bytes= 0;
+			for(uint32_t n= (nSamples+BASEBLOCK-1)>>BASESHIFT; ; n= (n+1)>>1)
+			{
+				bytes+= AlignedArena::roundUp(n*sizeof(Entry));
+				if(n<=1) break;
+			}
+			return bytes;
+		}
+
+		// the entries are taken from the arena. returns false if they don't fit.
+		bool setSize(uint32_t nSamples, AlignedArena &arena)
+		{
+			size= nSamples;
+			nLevels= 0;
+			for(uint32_t n= (nSamples+BASEBLOCK-1)>>BASESHIFT; nLevels<MAXLEVELS; n= (n+1)>>1)
+			{
+				if(!(levels[nLevels]= arena.allocate<Entry>(n))) return false;
+				levelSizes[nLevels++]= n;
+				if(n<=1) break;
+			}
+			return true;
+		}
+
+		// level to use for display columns which are samplesPerColumn wide.
+		// -1 means the columns are narrow enough to scan the samples directly.
+		int getLevel(double samplesPerColumn)
+		{
+			int level= -1;
+			for(double blockSize= BASEBLOCK; blockSize<=samplesPerColumn && level+1<(int)nLevels; blockSize*= 2)
+				level++;
+			return level;
+		}
+
+		// update the entries covering samples [begin, end) of the buffer
+		void update(const jack_default_audio_sample_t *samples, uint32_t begin, uint32_t end)
+		{
+			if(begin>=end || !nLevels) return;
+			uint32_t first= begin>>BASESHIFT, last= (end-1)>>BASESHIFT;
+			for(uint32_t i= first; i<=last; i++)
+			{
+				uint32_t s0= i<<BASESHIFT, s1= min(s0+BASEBLOCK, size);
+				levels[0][i]= scan(samples, s0, s1);
+			}
+			for(uint32_t l= 1; l<nLevels; l++)
+			{
+				first>>= 1; last>>= 1;
+				const Entry *src= levels[l-1];
+				Entry *dst= levels[l];
+				for(uint32_t i= first; i<=last; i++)
+				{
+					dst[i]= src[i*2];
+					if(i*2+1<levelSizes[l-1]) dst[i].merge(src[i*2+1]);
+				}
+			}
+		}
+
+		// summarize samples [begin, end) using entries of the given level. with a level >= 0, the range
+		// is rounded down to block boundaries, so adjacent columns always cover each sample exactly once.
+		Entry query(const jack_default_audio_sample_t *samples, int level, uint32_t begin, uint32_t end)
+		{
+			if(level<0) return scan(samples, begin, end);
+			uint32_t shift= BASESHIFT+level;
+			const Entry *entries= levels[level];
+			uint32_t first= begin>>shift, last= (end>=size? levelSizes[level]: end>>shift);
+			if(first>=last) last= first+1;
+			Entry ret= entries[first];
+			for(uint32_t i= first+1; i<last; i++)
+				ret.merge(entries[i]);
+			return ret;
+		}
+
+	private:
+		enum { MAXLEVELS= 32 };
+		Entry *levels[MAXLEVELS];       // in the arena given to setSize()
+		uint32_t levelSizes[MAXLEVELS];
+		uint32_t nLevels;
+		uint32_t size;
+
+		static Entry scan(const jack_default_audio_sample_t *samples, uint32_t begin, uint32_t end)
+		{
+			Entry e= { samples[begin], samples[begin], 0, end-begin };
+			for(uint32_t i= begin; i<end; i++)
+			{
+				float s= samples[i];
+				if(s<e.min) e.min= s;
+				if(s>e.max) e.max= s;
+				e.sumSquares+= s*s;
+			}
+			return e;
+		}
+};
+
+// band-limited reconstruction between samples for the zoomed in line display: a Blackman windowed sinc
+// with TAPS taps, which is precomputed for PHASES fractional positions between two samples. the nearest
+// phase is used, with 256 of them the timing error is far below what can be seen.
+class SincInterpolator
+{
+	public:
+		enum { TAPS= 16, PHASES= 256 };
+
+		SincInterpolator(): table((PHASES+1)*TAPS)
+		{
+			for(int phase= 0; phase<=PHASES; phase++)
+			{
+				float *taps= &table[phase*TAPS];
+				double sum= 0;
+				for(int k= 0; k<TAPS; k++)
+				{
+					// distance of the tap from the interpolated position
+					double x= k-(TAPS/2-1) - double(phase)/PHASES;
+					double w= 0.42 + 0.5*cos(2*M_PI*x/TAPS) + 0.08*cos(4*M_PI*x/TAPS);
+					taps[k]= (fabs(x)<1e-9? 1: sin(M_PI*x)/(M_PI*x)) * w;
+					sum+= taps[k];
+				}
+				// unity gain at DC for every phase, so flat parts of the signal stay flat
+				for(int k= 0; k<TAPS; k++)
+					taps[k]/= sum;
+			}
+		}
+
+		// the value at fraction 0..1 between samples[TAPS/2-1] and samples[TAPS/2]
+		float interpolate(const float *samples, float fraction) const
+		{
+			const float *taps= &table[int(fraction*PHASES+0.5f)*TAPS];
+			float sum= 0;
+			for(int k= 0; k<TAPS; k++)
+				sum+= samples[k]*taps[k];
+			return sum;
+		}
+
+	private:
+		vector<float> table;
+};
+
+// the instruction sets SIMD kernels are written for
+enum InstructionSet { IS_SSE2, IS_AVX2 };
+
+// whether the CPU we are running on supports an instruction set
+bool cpuSupports(InstructionSet set)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	static const bool initialized= (__builtin_cpu_init(), true);
+	(void)initialized;
+	switch(set)
+	{
+		case IS_SSE2: return __builtin_cpu_supports("sse2");
+		case IS_AVX2: return __builtin_cpu_supports("avx2");
+	}
+#endif
+	(void)set;
+	return false;
+}
+
+// the SIMD kernels come in families of versions for different instruction sets, which all compute the
+// same. the kernel list of a family holds every version compiled in, fastest first, and ends with the
+// scalar version, which runs anywhere.
+template<class Func> struct Kernel
+{
+	const char *name;
+	Func func;
+	bool supported;     // by this CPU
+};
+
+template<class Func> class KernelList: public vector< Kernel<Func> >
+{
+	public:
+		KernelList &add(const char *name, Func func, bool supported)
+		{
+			Kernel<Func> k= { name, func, supported };
+			this->push_back(k);
+			return *this;
+		}
+
+		Func getFastest() const
+		{
+			for(size_t i= 0; i<this->size(); i++)
+				if((*this)[i].supported) return (*this)[i].func;
+			return this->back().func;
+		}
+};
+
+// the fastest kernel of a family which the CPU supports. it is picked once, on the first call; the
+// compiler guards the initialization of the local static, so that call may come from any thread.
+template<class Func, KernelList<Func> (*getKernels)()> Func selectKernel()
+{
+	static const Func func= getKernels().getFastest();
+	return func;
+}
+
+// edge trigger search kernels. each returns the index of the first sample where the signal crosses level
+// in the given direction (prev<=level<=sample for rising edges, prev>=level>=sample for falling ones),
+// where prev is the sample before it, or -1 if there is no crossing. data[-1] is never read; the sample
+// before data[0] is passed in prev. the SIMD versions compare a whole vector of sample pairs at once
+// and are selected at runtime depending on what the CPU supports.
+typedef int (*EdgeSearchFunc)(const float *data, uint32_t nFrames, float prev, float level, bool rising);
+
+int findEdgeScalar(const float *data, uint32_t nFrames, float prev, float level, bool rising)
+{
+	for(uint32_t i= 0; i<nFrames; i++)
+	{
+		float sample= data[i];
+		if( (rising && (prev<=level && sample>=level)) ||
+			((!rising) && (prev>=level && sample<=level)) )
+			return i;
+		prev= sample;
+	}
+	return -1;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+__attribute__((target("sse2")))
+int findEdgeSSE2(const float *data, uint32_t nFrames, float prev, float level, bool rising)
+{
+	if(!nFrames) return -1;
+	if(findEdgeScalar(data, 1, prev, level, rising)==0) return 0;
+	const __m128 vLevel= _mm_set1_ps(level);
+	uint32_t i= 1;
+	for(; i+4<=nFrames; i+= 4)
+	{
+		__m128 cur= _mm_loadu_ps(data+i), before= _mm_loadu_ps(data+i-1);
+		__m128 hit= (rising? _mm_and_ps(_mm_cmple_ps(before, vLevel), _mm_cmpge_ps(cur, vLevel)):
+							 _mm_and_ps(_mm_cmpge_ps(before, vLevel), _mm_cmple_ps(cur, vLevel)));
+		if(int mask= _mm_movemask_ps(hit))
+			return i+__builtin_ctz(mask);
+	}
+	int ret= findEdgeScalar(data+i, nFrames-i, data[i-1], level, rising);
+	return (ret<0? -1: int(i)+ret);
+}
+
+// one load per vector: the samples before are the current vector rotated up by one, with the last sample
+// of the previous vector moved in. a falling edge is a rising edge of the negated signal, so the samples
+// and the level are negated for those instead of branching in the loop.
+__attribute__((target("avx2")))
+int findEdgeAVX2(const float *data, uint32_t nFrames, float prev, float level, bool rising)
+{
+	const __m256 sign= _mm256_set1_ps(rising? 0.0f: -0.0f);
+	const __m256 vLevel= _mm256_xor_ps(_mm256_set1_ps(level), sign);
+	const __m256i rotate= _mm256_setr_epi32(7, 0, 1, 2, 3, 4, 5, 6);
+	__m256 last= _mm256_xor_ps(_mm256_set1_ps(prev), sign);    // element 0 is the sample before the vector
+	uint32_t i= 0;
+	for(; i+8<=nFrames; i+= 8)
+	{
+		__m256 cur= _mm256_xor_ps(_mm256_loadu_ps(data+i), sign);
+		__m256 rotated= _mm256_permutevar8x32_ps(cur, rotate);
+		__m256 before= _mm256_blend_ps(rotated, last, 1);
+		__m256 hit= _mm256_and_ps(_mm256_cmp_ps(before, vLevel, _CMP_LE_OQ), _mm256_cmp_ps(cur, vLevel, _CMP_GE_OQ));
+		if(int mask= _mm256_movemask_ps(hit))
+			return i+__builtin_ctz(mask);
+		last= rotated;
+	}
+	int ret= findEdgeSSE2(data+i, nFrames-i, i? data[i-1]: prev, level, rising);
+	return (ret<0? -1: int(i)+ret);
+}
+#endif
+
+KernelList<EdgeSearchFunc> getEdgeSearchKernels()
+{
+	KernelList<EdgeSearchFunc> kernels;
+#if defined(__i386__) || defined(__x86_64__)
+	kernels.add("AVX2", findEdgeAVX2, cpuSupports(IS_AVX2));
+	kernels.add("SSE2", findEdgeSSE2, cpuSupports(IS_SSE2));
+#endif
+	return kernels.add("scalar", findEdgeScalar, true);
+}
+
+// radix-2 butterfly kernels of the FFT, on separate arrays of real and imaginary parts. for each i, the
+// second input is multiplied by the twiddle factor w[i], then x0= x0+w*x1 and x1= x0-w*x1. the butterflies
+// of a pass are independent of each other, so the SIMD versions just do a whole vector of them at once.
+typedef void (*ButterflyFunc)(float *re0, float *im0, float *re1, float *im1, const float *wRe, const float *wIm, uint32_t n);
+
+void butterflyScalar(float *re0, float *im0, float *re1, float *im1, const float *wRe, const float *wIm, uint32_t n)
+{
+	for(uint32_t i= 0; i<n; i++)
+	{
+		float tr= wRe[i]*re1[i] - wIm[i]*im1[i], ti= wRe[i]*im1[i] + wIm[i]*re1[i];
+		re1[i]= re0[i]-tr; im1[i]= im0[i]-ti;
+		re0[i]+= tr; im0[i]+= ti;
+	}
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+__attribute__((target("sse2")))
+void butterflySSE2(float *re0, float *im0, float *re1, float *im1, const float *wRe, const float *wIm, uint32_t n)
+{
+	uint32_t i= 0;
+	for(; i+4<=n; i+= 4)
+	{
+		__m128 wr= _mm_loadu_ps(wRe+i), wi= _mm_loadu_ps(wIm+i);
+		__m128 r1= _mm_loadu_ps(re1+i), i1= _mm_loadu_ps(im1+i);
+		__m128 r0= _mm_loadu_ps(re0+i), i0= _mm_loadu_ps(im0+i);
+		__m128 tr= _mm_sub_ps(_mm_mul_ps(wr, r1), _mm_mul_ps(wi, i1)),
+			   ti= _mm_add_ps(_mm_mul_ps(wr, i1), _mm_mul_ps(wi, r1));
+		_mm_storeu_ps(re1+i, _mm_sub_ps(r0, tr));
+		_mm_storeu_ps(im1+i, _mm_sub_ps(i0, ti));
+		_mm_storeu_ps(re0+i, _mm_add_ps(r0, tr));
+		_mm_storeu_ps(im0+i, _mm_add_ps(i0, ti));
+	}
+	butterflyScalar(re0+i, im0+i, re1+i, im1+i, wRe+i, wIm+i, n-i);
+}
+
+__attribute__((target("avx2")))
+void butterflyAVX2(float *re0, float *im0, float *re1, float *im1, const float *wRe, const float *wIm, uint32_t n)
+{
+	uint32_t i= 0;
+	for(; i+8<=n; i+= 8)
+	{
+		__m256 wr= _mm256_loadu_ps(wRe+i), wi= _mm256_loadu_ps(wIm+i);
+		__m256 r1= _mm256_loadu_ps(re1+i), i1= _mm256_loadu_ps(im1+i);
+		__m256 r0= _mm256_loadu_ps(re0+i), i0= _mm256_loadu_ps(im0+i);
+		__m256 tr= _mm256_sub_ps(_mm256_mul_ps(wr, r1), _mm256_mul_ps(wi, i1)),
+			   ti= _mm256_add_ps(_mm256_mul_ps(wr, i1), _mm256_mul_ps(wi, r1));
+		_mm256_storeu_ps(re1+i, _mm256_sub_ps(r0, tr));
+		_mm256_storeu_ps(im1+i, _mm256_sub_ps(i0, ti));
+		_mm256_storeu_ps(re0+i, _mm256_add_ps(r0, tr));
+		_mm256_storeu_ps(im0+i, _mm256_add_ps(i0, ti));
+	}
+	butterflySSE2(re0+i, im0+i, re1+i, im1+i, wRe+i, wIm+i, n-i);
+}
+#endif
+
+KernelList<ButterflyFunc> getButterflyKernels()
+{
+	KernelList<ButterflyFunc> kernels;
+#if defined(__i386__) || defined(__x86_64__)
+	kernels.add("AVX2", butterflyAVX2, cpuSupports(IS_AVX2));
+	kernels.add("SSE2", butterflySSE2, cpuSupports(IS_SSE2));
+#endif
+	return kernels.add("scalar", butterflyScalar, true);
+}
+
+// biquad kernels of the filter bank. the data is 8 channels interleaved, one frame after the other, and
+// each channel has its own coefficients and state: coefs holds b0, b1, b2, a1 and a2 for the 8 channels,
+// state holds s1 and s2. the recursion of a single channel is sequential, so the SIMD versions run the
+// channels side by side instead, one lane each.
+typedef void (*BiquadFunc)(float *data, uint32_t nFrames, const float *coefs, float *state);
+
+void biquadScalar(float *data, uint32_t nFrames, const float *coefs, float *state)
+{
+	for(int lane= 0; lane<8; lane++)
+	{
+		float b0= coefs[lane], b1= coefs[8+lane], b2= coefs[16+lane], a1= coefs[24+lane], a2= coefs[32+lane];
+		float s1= state[lane], s2= state[8+lane];
+		for(uint32_t i= 0; i<nFrames; i++)
+		{
+			float x= data[i*8+lane];
+			float y= b0*x + s1;
+			s1= b1*x - a1*y + s2;
+			s2= b2*x - a2*y;
+			data[i*8+lane]= y;
+		}
+		state[lane]= s1;
+		state[8+lane]= s2;
+	}
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+__attribute__((target("sse2")))
+void biquadSSE2(float *data, uint32_t nFrames, const float *coefs, float *state)
+{
+	for(int half= 0; half<8; half+= 4)
+	{
+		__m128 b0= _mm_loadu_ps(coefs+half), b1= _mm_loadu_ps(coefs+8+half), b2= _mm_loadu_ps(coefs+16+half),
+			   a1= _mm_loadu_ps(coefs+24+half), a2= _mm_loadu_ps(coefs+32+half);
+		__m128 s1= _mm_loadu_ps(state+half), s2= _mm_loadu_ps(state+8+half);
+		for(uint32_t i= 0; i<nFrames; i++)
+		{
+			float *p= data+i*8+half;
+			__m128 x= _mm_loadu_ps(p);
+			__m128 y= _mm_add_ps(_mm_mul_ps(b0, x), s1);
+			s1= _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), s2);
+			s2= _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+			_mm_storeu_ps(p, y);
+		}
+		_mm_storeu_ps(state+half, s1);
+		_mm_storeu_ps(state+8+half, s2);
+	}
+}
+
+__attribute__((target("avx2")))
+void biquadAVX2(float *data, uint32_t nFrames, const float *coefs, float *state)
+{
+	__m256 b0= _mm256_loadu_ps(coefs), b1= _mm256_loadu_ps(coefs+8), b2= _mm256_loadu_ps(coefs+16),
+		   a1= _mm256_loadu_ps(coefs+24), a2= _mm256_loadu_ps(coefs+32);
+	__m256 s1= _mm256_loadu_ps(state), s2= _mm256_loadu_ps(state+8);
+	for(uint32_t i= 0; i<nFrames; i++)
+	{
+		__m256 x= _mm256_loadu_ps(data+i*8);
+		__m256 y= _mm256_add_ps(_mm256_mul_ps(b0, x), s1);
+		s1= _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), s2);
+		s2= _mm256_sub_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+		_mm256_storeu_ps(data+i*8, y);
+	}
+	_mm256_storeu_ps(state, s1);
+	_mm256_storeu_ps(state+8, s2);
+}
+#endif
+
+KernelList<BiquadFunc> getBiquadKernels()
+{
+	KernelList<BiquadFunc> kernels;
+#if defined(__i386__) || defined(__x86_64__)
+	kernels.add("AVX2", biquadAVX2, cpuSupports(IS_AVX2));
+	kernels.add("SSE2", biquadSSE2, cpuSupports(IS_SSE2));
+#endif
+	return kernels.add("scalar", biquadScalar, true);
+}
+
+// a cascade of biquad sections for each of a number of channels. the channels are processed in groups
+// of 8: a block of each group is interleaved into a scratch buffer, goes through all the sections there
+// while it is in the cache, and is written back. all channels share the same cascade structure, but
+// each section of each channel has its own coefficients.
+class BiquadBank
+{
+	public:
+		enum { LANES= 8, BLOCK= 256 };
+
+		BiquadBank(): nChannels(0), nSections(0), kernel(selectKernel<BiquadFunc, getBiquadKernels>())
+		{ }
+
+		// all sections start out passing the signal through unchanged
+		void setup(unsigned channels, unsigned sections)
+		{
+			nChannels= channels;
+			nSections= sections;
+			unsigned nGroups= (nChannels+LANES-1)/LANES;
+			coefs.assign(size_t(nGroups)*nSections*LANES*5, 0);
+			for(size_t i= 0; i<coefs.size(); i+= LANES*5)
+				fill(coefs.begin()+i, coefs.begin()+i+LANES, 1.0f);
+			state.assign(size_t(nGroups)*nSections*LANES*2, 0);
+			scratch.assign(BLOCK*LANES, 0);
+		}
+
+		void setSection(unsigned channel, unsigned section, const Biquad &b)
+		{
+			float *c= &coefs[(size_t(channel/LANES)*nSections+section)*LANES*5 + channel%LANES];
+			c[0]= b.b0; c[LANES]= b.b1; c[LANES*2]= b.b2; c[LANES*3]= b.a1; c[LANES*4]= b.a2;
+		}
+
+		void reset()
+		{ fill(state.begin(), state.end(), 0.0f); }
+
+		unsigned getNumChannels()
+		{ return nChannels; }
+
+		unsigned getNumSections()
+		{ return nSections; }
+
+		// used by the benchmark to compare the kernels
+		void setKernel(BiquadFunc func)
+		{ kernel= func; }
+
+		// filter nFrames of each channel from in to out, which may be the same buffers. only every step-th
+		// frame is written to out, starting with frame phase, which is updated so that the next call
+		// continues where this one left off. returns the number of frames written.
+		uint32_t process(const float * const *in, float * const *out, uint32_t nFrames, unsigned step, unsigned &phase)
+		{
+			uint32_t nOut= 0;
+			unsigned nextPhase= phase;
+			for(unsigned group= 0; group*LANES<nChannels; group++)
+			{
+				unsigned first= group*LANES, nLanes= min(nChannels-first, unsigned(LANES));
+				float *groupCoefs= &coefs[size_t(group)*nSections*LANES*5], *groupState= &state[size_t(group)*nSections*LANES*2];
+				unsigned ph= phase;
+				nOut= 0;
+				for(uint32_t start= 0; start<nFrames; start+= BLOCK)
+				{
+					uint32_t n= min(nFrames-start, uint32_t(BLOCK));
+					for(unsigned lane= 0; lane<nLanes; lane++)
+					{
+						const float *src= in[first+lane]+start;
+						for(uint32_t i= 0; i<n; i++)
+							scratch[i*LANES+lane]= src[i];
+					}
+					for(unsigned sec= 0; sec<nSections; sec++)
+						kernel(&scratch[0], n, groupCoefs+sec*LANES*5, groupState+sec*LANES*2);
+					for(unsigned lane= 0; lane<nLanes; lane++)
+					{
+						float *dest= out[first+lane]+nOut;
+						for(uint32_t i= ph, k= 0; i<n; i+= step)
+							dest[k++]= scratch[i*LANES+lane];
+					}
+					uint32_t count= (ph<n? (n-ph-1)/step+1: 0);
+					nOut+= count;
+					ph= ph+count*step-n;
+				}
+				nextPhase= ph;
+			}
+			phase= nextPhase;
+			return nOut;
+		}
+
+	private:
+		unsigned nChannels, nSections;
+		vector<float> coefs, state, scratch;
+		BiquadFunc kernel;
+};
+
+// kernels of the persistence display, which run over whole histograms of hit counts. decay multiplies the
+// counts by factor and returns the largest one; levels maps them to display levels as sqrt(count*scale),
+// capped at 255, which lifts rare hits like glitches out of the dark.
+typedef float (*PhosphorDecayFunc)(float *data, size_t n, float factor);
+typedef void (*PhosphorLevelsFunc)(const float *data, uint8_t *levels, size_t n, float scale);
+
+float phosphorDecayScalar(float *data, size_t n, float factor)
+{
+	float largest= 0;
+	for(size_t i= 0; i<n; i++)
+	{
+		data[i]*= factor;
+		largest= max(largest, data[i]);
+	}
+	return largest;
+}
+
+void phosphorLevelsScalar(const float *data, uint8_t *levels, size_t n, float scale)
+{
+	// clamped before the conversion, which is undefined out of range. NaN is 0, like in the SIMD versions.
+	for(size_t i= 0; i<n; i++)
+	{
+		float level= sqrtf(data[i]*scale);
+		levels[i]= uint8_t(level==level? min(max(level, 0.0f), 255.0f): 0);
+	}
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+__attribute__((target("sse2")))
+float phosphorDecaySSE2(float *data, size_t n, float factor)
+{
+	const __m128 vFactor= _mm_set1_ps(factor);
+	__m128 vMax= _mm_setzero_ps();
+	size_t i= 0;
+	for(; i+4<=n; i+= 4)
+	{
+		__m128 v= _mm_mul_ps(_mm_loadu_ps(data+i), vFactor);
+		_mm_storeu_ps(data+i, v);
+		vMax= _mm_max_ps(vMax, v);
+	}
+	float lanes[4];
+	_mm_storeu_ps(lanes, vMax);
+	return max(max(max(lanes[0], lanes[1]), max(lanes[2], lanes[3])), phosphorDecayScalar(data+i, n-i, factor));
+}
+
+__attribute__((target("sse2")))
+void phosphorLevelsSSE2(const float *data, uint8_t *levels, size_t n, float scale)
+{
+	const __m128 vScale= _mm_set1_ps(scale), vTop= _mm_set1_ps(255);
+	size_t i= 0;
+	for(; i+8<=n; i+= 8)
+	{
+		// min keeps a NaN in its second operand, which converts to INT_MIN and saturates to 0
+		__m128i a= _mm_cvttps_epi32(_mm_min_ps(vTop, _mm_sqrt_ps(_mm_mul_ps(_mm_loadu_ps(data+i), vScale)))),
+				b= _mm_cvttps_epi32(_mm_min_ps(vTop, _mm_sqrt_ps(_mm_mul_ps(_mm_loadu_ps(data+i+4), vScale))));
+		_mm_storel_epi64((__m128i*)(levels+i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_setzero_si128()));
+	}
+	phosphorLevelsScalar(data+i, levels+i, n-i, scale);
+}
+
+__attribute__((target("avx2")))
+float phosphorDecayAVX2(float *data, size_t n, float factor)
+{
+	const __m256 vFactor= _mm256_set1_ps(factor);
+	__m256 vMax= _mm256_setzero_ps();
+	size_t i= 0;
+	for(; i+8<=n; i+= 8)
+	{
+		__m256 v= _mm256_mul_ps(_mm256_loadu_ps(data+i), vFactor);
+		_mm256_storeu_ps(data+i, v);
+		vMax= _mm256_max_ps(vMax, v);
+	}
+	float lanes[8];
+	_mm256_storeu_ps(lanes, vMax);
+	float largest= phosphorDecayScalar(data+i, n-i, factor);
+	for(int k= 0; k<8; k++)
+		largest= max(largest, lanes[k]);
+	return largest;
+}
+
+__attribute__((target("avx2")))
+void phosphorLevelsAVX2(const float *data, uint8_t *levels, size_t n, float scale)
+{
+	const __m256 vScale= _mm256_set1_ps(scale), vTop= _mm256_set1_ps(255);
+	size_t i= 0;
+	for(; i+16<=n; i+= 16)
+	{
+		__m256i a= _mm256_cvttps_epi32(_mm256_min_ps(vTop, _mm256_sqrt_ps(_mm256_mul_ps(_mm256_loadu_ps(data+i), vScale)))),
+				b= _mm256_cvttps_epi32(_mm256_min_ps(vTop, _mm256_sqrt_ps(_mm256_mul_ps(_mm256_loadu_ps(data+i+8), vScale))));
+		// the packs work within 128 bit lanes, so put the quarters back in order in between
+		__m256i words= _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3,1,2,0));
+		__m256i bytes= _mm256_packus_epi16(words, words);
+		_mm_storel_epi64((__m128i*)(levels+i), _mm256_castsi256_si128(bytes));
+		_mm_storel_epi64((__m128i*)(levels+i+8), _mm256_extracti128_si256(bytes, 1));
+	}
+	phosphorLevelsSSE2(data+i, levels+i, n-i, scale);
+}
+#endif
+
+// the decay and levels functions for one instruction set
+struct PhosphorFuncs
+{
+	PhosphorDecayFunc decay;
+	PhosphorLevelsFunc levels;
+};
+
+KernelList<PhosphorFuncs> getPhosphorKernels()
+{
+	KernelList<PhosphorFuncs> kernels;
+#if defined(__i386__) || defined(__x86_64__)
+	PhosphorFuncs avx2= { phosphorDecayAVX2, phosphorLevelsAVX2 }, sse2= { phosphorDecaySSE2, phosphorLevelsSSE2 };
+	kernels.add("AVX2", avx2, cpuSupports(IS_AVX2));
+	kernels.add("SSE2", sse2, cpuSupports(IS_SSE2));
+#endif
+	PhosphorFuncs scalar= { phosphorDecayScalar, phosphorLevelsScalar };
+	return kernels.add("scalar", scalar, true);
+}
+
+// mask test kernels: the number of samples outside of [lower, upper]. NaN samples don't count.
+typedef uint32_t (*MaskCompareFunc)(const float *data, const float *lower, const float *upper, uint32_t n);
+
+uint32_t maskCompareScalar(const float *data, const float *lower, const float *upper, uint32_t n)
+{
+	uint32_t count= 0;
+	for(uint32_t i= 0; i<n; i++)
+		count+= (data[i]<lower[i] || data[i]>upper[i]);
+	return count;
+}
+
+#if defined(__i386__) || defined(__x86_64__)
+// the compare masks are all ones, -1 as integers, so subtracting them counts the violations per lane
+__attribute__((target("sse2")))
+uint32_t maskCompareSSE2(const float *data, const float *lower, const float *upper, uint32_t n)
+{
+	__m128i counts= _mm_setzero_si128();
+	uint32_t i= 0;
+	for(; i+4<=n; i+= 4)
+	{
+		__m128 x= _mm_loadu_ps(data+i);
+		__m128 outside= _mm_or_ps(_mm_cmplt_ps(x, _mm_loadu_ps(lower+i)), _mm_cmpgt_ps(x, _mm_loadu_ps(upper+i)));
+		counts= _mm_sub_epi32(counts, _mm_castps_si128(outside));
+	}
+	uint32_t lanes[4];
+	_mm_storeu_si128((__m128i*)lanes, counts);
+	return lanes[0]+lanes[1]+lanes[2]+lanes[3] + maskCompareScalar(data+i, lower+i, upper+i, n-i);
+}
+
+__attribute__((target("avx2")))
+uint32_t maskCompareAVX2(const float *data, const float *lower, const float *upper, uint32_t n)
+{
+	__m256i counts= _mm256_setzero_si256();
+	uint32_t i= 0;
+	for(; i+8<=n; i+= 8)
+	{
+		__m256 x= _mm256_loadu_ps(data+i);
+		__m256 outside= _mm256_or_ps(_mm256_cmp_ps(x, _mm256_loadu_ps(lower+i), _CMP_LT_OQ),
+									 _mm256_cmp_ps(x, _mm256_loadu_ps(upper+i), _CMP_GT_OQ));
+		counts= _mm256_sub_epi32(counts, _mm256_castps_si256(outside));
+	}
+	uint32_t lanes[8];
+	_mm256_storeu_si256((__m256i*)lanes, counts);
+	uint32_t count= 0;
+	for(int k= 0; k<8; k++) count+= lanes[k];
+	return count + maskCompareSSE2(data+i, lower+i, upper+i, n-i);
+}
+#endif
+
+KernelList<MaskCompareFunc> getMaskKernels()
+{
+	KernelList<MaskCompareFunc> kernels;
+#if defined(__i386__) || defined(__x86_64__)
+	kernels.add("AVX2", maskCompareAVX2, cpuSupports(IS_AVX2));
+	kernels.add("SSE2", maskCompareSSE2, cpuSupports(IS_SSE2));
+#endif
+	return kernels.add("scalar", maskCompareScalar, true);
+}
+
+// FFT of real input. the N real samples are treated as N/2 complex ones, which go through an iterative
+// radix-2 FFT in split format, then the spectrum of the real signal is untangled from the result.
+// twiddle factors and the bit reversal permutation are computed when the size is set, so transforms
+// don't allocate anything.
+class RealFFT
+{
+	public:
+		RealFFT(): size(0), butterfly(selectKernel<ButterflyFunc, getButterflyKernels>())
+		{ }
+
+		// power of two, at least 4
+		void setSize(uint32_t n)
+		{
+			if(n==size) return;
+			size= n;
+			uint32_t half= n/2, bits= 0;
+			while((1u<<bits)<half) bits++;
+			bitReverse.resize(half);
+			for(uint32_t i= 0; i<half; i++)
+			{
+				uint32_t r= 0;
+				for(uint32_t b= 0; b<bits; b++)
+					if(i & (1u<<b)) r|= 1u<<(bits-1-b);
+				bitReverse[i]= r;
+			}
+			// the twiddle factors of the pass with butterfly span h are stored at offset h-1
+			twiddleRe.resize(half);
+			twiddleIm.resize(half);
+			for(uint32_t h= 1; h<half; h*= 2)
+				for(uint32_t j= 0; j<h; j++)
+					twiddleRe[h-1+j]= cos(M_PI*j/h),
+					twiddleIm[h-1+j]= -sin(M_PI*j/h);
+			splitRe.resize(half+1);
+			splitIm.resize(half+1);
+			for(uint32_t k= 0; k<=half; k++)
+				splitRe[k]= cos(2*M_PI*k/n),
+				splitIm[k]= -sin(2*M_PI*k/n);
+			re.resize(half);
+			im.resize(half);
+		}
+
+		uint32_t getSize()
+		{ return size; }
+
+		// use a specific butterfly kernel instead of the fastest one
+		void setButterflyFunc(ButterflyFunc func)
+		{ butterfly= func; }
+
+		// squared magnitudes of bins 0..N/2 of the transform of N real samples
+		void powerSpectrum(const float *input, float *power)
+		{
+			uint32_t half= size/2;
+			for(uint32_t i= 0; i<half; i++)
+			{
+				uint32_t src= bitReverse[i]*2;
+				re[i]= input[src];
+				im[i]= input[src+1];
+			}
+			transform();
+			for(uint32_t k= 0; k<=half; k++)
+			{
+				// Z[k] and conj(Z[N/2-k]) give the transforms of the even and odd samples
+				uint32_t a= (k==half? 0: k), b= (k? half-k: 0);
+				float zr= re[a], zi= im[a], cr= re[b], ci= -im[b];
+				float er= (zr+cr)*.5f, ei= (zi+ci)*.5f;
+				float or_= (zi-ci)*.5f, oi= (cr-zr)*.5f;
+				float xr= er + splitRe[k]*or_ - splitIm[k]*oi,
+					  xi= ei + splitRe[k]*oi + splitIm[k]*or_;
+				power[k]= xr*xr + xi*xi;
+			}
+		}
+
+	private:
+		uint32_t size;
+		ButterflyFunc butterfly;
+		vector<uint32_t> bitReverse;
+		vector<float> twiddleRe, twiddleIm;
+		vector<float> splitRe, splitIm;     // exp(-2 pi i k/N), for untangling the real spectrum
+		vector<float> re, im;
+
+		// in-place complex FFT of the bit reversed data in re/im
+		void transform()
+		{
+			uint32_t half= size/2;
+			// the first passes have too few butterflies per group for the vector kernels
+			uint32_t h= 1;
+			for(; h<half && h<4; h*= 2)
+				for(uint32_t k= 0; k<half; k+= 2*h)
+					butterflyScalar(&re[k], &im[k], &re[k+h], &im[k+h], &twiddleRe[h-1], &twiddleIm[h-1], h);
+			for(; h<half; h*= 2)
+				for(uint32_t k= 0; k<half; k+= 2*h)
+					butterfly(&re[k], &im[k], &re[k+h], &im[k+h], &twiddleRe[h-1], &twiddleIm[h-1], h);
+		}
+};
+
+// trigger parameters. times are in seconds, levels in sample units.
+struct TriggerSettings
+{
+	enum Type
+	{
+		TT_EDGE= 0,
+		TT_PULSE_SHORTER,   // pulse narrower than pulseWidth
+		TT_PULSE_LONGER,    // pulse wider than pulseWidth
+		TT_RUNT             // pulse which crosses the level but not runtLevel
+	};
+	enum Mode
+	{
+		TM_AUTO= 0,         // free-run when no trigger event comes along
+		TM_NORMAL,          // wait for trigger events
+		TM_SINGLE           // stop after one triggered sweep until re-armed
+	};
+
+	bool enabled;
+	bool positive;          // rising edges/positive pulses
+	int type;
+	int mode;
+	unsigned sourceChannel;
+	float level;
+	float hysteresis;       // how far the signal must go back past the level before the trigger re-arms
+	float holdoff;          // minimum time between trigger events
+	float pulseWidth;
+	float runtLevel;
+	float position;         // fraction of the sweep shown before the trigger event
+	uint32_t armCount;      // incremented to re-arm single shot mode
+
+	TriggerSettings(): enabled(true), positive(true), type(TT_EDGE), mode(TM_NORMAL), sourceChannel(0), level(0.2),
+		hysteresis(0), holdoff(0), pulseWidth(0.001), runtLevel(0.5), position(0), armCount(0)
+	{ }
+};
+
+// trigger state machine for edge, pulse width and runt triggers with hysteresis and holdoff. it is fed the
+// source channel while waiting for a trigger event. every state waits for the next threshold crossing,
+// which is found with the vectorized edge search, so this costs about as much as a plain edge trigger.
+// falling edges and negative pulses are handled by searching in the other direction.
+class TriggerEngine
+{
+	public:
+		TriggerEngine(): findEdge(selectKernel<EdgeSearchFunc, getEdgeSearchKernels>()), armLevel(0), holdoffSamples(0), pulseWidthSamples(0),
+			prevSample(0), samplePos(0), pulseStart(0), lastTriggerPos(0), triggerFraction(0), haveTriggered(false), state(S_IDLE)
+		{ }
+
+		void setSettings(const TriggerSettings &s, float samplingRate)
+		{
+			settings= s;
+			float hysteresis= fabs(s.hysteresis);
+			armLevel= (s.positive? s.level-hysteresis: s.level+hysteresis);
+			holdoffSamples= uint64_t(max(s.holdoff, 0.0f)*samplingRate);
+			pulseWidthSamples= uint64_t(max(s.pulseWidth, 0.0f)*samplingRate);
+			arm();
+		}
+
+		// forget about partial pulses and start looking for a new trigger event
+		void arm()
+		{ state= S_IDLE; }
+
+		// pass over samples which are not searched, e.g. while a sweep is being filled
+		void skip(const float *data, uint32_t nFrames)
+		{
+			if(!nFrames) return;
+			prevSample= data[nFrames-1];
+			samplePos+= nFrames;
+		}
+
+		// the threshold crossing of the last trigger event, interpolated linearly between the trigger sample
+		// and the one before it: how far before the trigger sample it is, from 0 to 1 samples.
+		float getTriggerFraction()
+		{ return triggerFraction; }
+
+		// search for the next trigger event. returns its index, or -1 if there is none. everything before
+		// the trigger sample is consumed, so the caller continues at the trigger sample.
+		int find(const float *data, uint32_t nFrames)
+		{
+			uint32_t pos= 0;
+			while(pos<nFrames)
+			{
+				const float *p= data+pos;
+				uint32_t n= nFrames-pos;
+				int found;
+				switch(state)
+				{
+					case S_IDLE:
+						// wait until the signal is below the arm level
+						if(isBelow(prevSample, armLevel))
+						{ state= S_ARMED; continue; }
+						if((found= searchBelow(p, n, armLevel))<0) break;
+						consume(p, found+1, pos);
+						state= S_ARMED;
+						continue;
+
+					case S_ARMED:
+						if((found= searchAbove(p, n, settings.level))<0) break;
+						if(settings.type==TriggerSettings::TT_EDGE)
+						{
+							state= S_IDLE;
+							if(acceptTrigger(p, found, settings.level, pos)) return pos;
+							consume(p, found+1, pos);
+							continue;
+						}
+						consume(p, found+1, pos);
+						pulseStart= samplePos-1;
+						state= (settings.type==TriggerSettings::TT_RUNT && isAbove(prevSample, settings.runtLevel)?
+								S_HIGH: S_PULSE);
+						continue;
+
+					case S_PULSE:
+						if(settings.type==TriggerSettings::TT_RUNT)
+						{
+							// runt: the pulse must end before it gets to the runt level
+							int end= searchBelow(p, n, armLevel);
+							int high= searchAbove(p, end<0? n: end, settings.runtLevel);
+							if(high>=0)
+							{
+								consume(p, high+1, pos);
+								state= S_HIGH;
+								continue;
+							}
+							if(end<0) break;
+							state= S_ARMED;
+							if(acceptTrigger(p, end, armLevel, pos)) return pos;
+							consume(p, end+1, pos);
+							continue;
+						}
+						else
+						{
+							if((found= searchBelow(p, n, armLevel))<0) break;
+							uint64_t width= samplePos+found-pulseStart;
+							state= S_ARMED;
+							if( (settings.type==TriggerSettings::TT_PULSE_SHORTER? width<pulseWidthSamples: width>pulseWidthSamples) &&
+								acceptTrigger(p, found, armLevel, pos) )
+								return pos;
+							consume(p, found+1, pos);
+							continue;
+						}
+
+					case S_HIGH:
+						// too high for a runt, wait for the end of the pulse
+						if((found= searchBelow(p, n, armLevel))<0) break;
+						consume(p, found+1, pos);
+						state= S_ARMED;
+						continue;
+				}
+				// nothing found in the rest of the data
+				consume(p, n, pos);
+			}
+			return -1;
+		}
+
+	private:
+		enum State
+		{
+			S_IDLE= 0,          // signal has to go below the arm level
+			S_ARMED,            // waiting for the level to be crossed
+			S_PULSE,            // inside a pulse, waiting for it to end
+			S_HIGH              // inside a pulse which is not a runt
+		};
+
+		EdgeSearchFunc findEdge;
+		TriggerSettings settings;
+		float armLevel;
+		uint64_t holdoffSamples, pulseWidthSamples;
+		float prevSample;
+		uint64_t samplePos;     // stream position of the next sample
+		uint64_t pulseStart;
+		uint64_t lastTriggerPos;
+		float triggerFraction;
+		bool haveTriggered;
+		State state;
+
+		// "above" is in the direction of the trigger slope
+		bool isAbove(float sample, float level)
+		{ return settings.positive? sample>=level: sample<=level; }
+
+		bool isBelow(float sample, float level)
+		{ return settings.positive? sample<=level: sample>=level; }
+
+		int searchAbove(const float *data, uint32_t nFrames, float level)
+		{ return findEdge(data, nFrames, prevSample, level, settings.positive); }
+
+		int searchBelow(const float *data, uint32_t nFrames, float level)
+		{ return findEdge(data, nFrames, prevSample, level, !settings.positive); }
+
+		void consume(const float *data, uint32_t count, uint32_t &pos)
+		{
+			prevSample= data[count-1];
+			samplePos+= count;
+			pos+= count;
+		}
+
+		// check the holdoff time for an event at data[index], where the signal has crossed level. an accepted
+		// trigger consumes everything before the trigger sample and sets pos to its index.
+		bool acceptTrigger(const float *data, uint32_t index, float level, uint32_t &pos)
+		{
+			uint64_t triggerPos= samplePos+index;
+			if(haveTriggered && triggerPos-lastTriggerPos<holdoffSamples)
+				return false;
+			haveTriggered= true;
+			lastTriggerPos= triggerPos;
+			float prev= (index? data[index-1]: prevSample), cur= data[index];
+			triggerFraction= (cur!=prev? (cur-level)/(cur-prev): 0);
+			triggerFraction= (triggerFraction<0? 0: triggerFraction>1? 1: triggerFraction);
+			prevSample= data[index];
+			samplePos= triggerPos;
+			pos+= index;
+			return true;
+		}
+};
+
+// lock-free triple buffer for handing finished objects from one producer thread to one consumer thread.
+// the producer always has a buffer to write into and the consumer always has a complete one to read
+// from, so neither of them ever waits. objects are dropped when the consumer is slower than the producer.
+template<class T> class TripleBuffer
+{
+	public:
+		TripleBuffer(): backIndex(0), middleIndex(1), frontIndex(2)
+		{ }
+
+		// producer side
+		T &getWriteBuffer()
+		{ return buffers[backIndex]; }
+
+		// hand the write buffer over to the consumer and continue with a free one
+		void publish()
+		{ backIndex= __atomic_exchange_n(&middleIndex, backIndex|NEWDATA, __ATOMIC_ACQ_REL) & INDEXMASK; }
+
+		// consumer side: switch to the most recently published buffer, returns false if there is none
+		bool update()
+		{
+			if(!(__atomic_load_n(&middleIndex, __ATOMIC_ACQUIRE) & NEWDATA)) return false;
+			frontIndex= __atomic_exchange_n(&middleIndex, frontIndex, __ATOMIC_ACQ_REL) & INDEXMASK;
+			return true;
+		}
+
+		const T &getReadBuffer()
+		{ return buffers[frontIndex]; }
+
+		// index of the current write buffer, for producers which keep per-buffer state
+		int getWriteIndex()
+		{ return backIndex; }
+
+	private:
+		enum { INDEXMASK= 3, NEWDATA= 4 };
+		T buffers[3];
+		uint32_t backIndex, middleIndex, frontIndex;
+};
+
+// queue of objects like sweep captures from the processing thread to a consumer, which may be slow, like one
+// writing to disk. the slots are reused, so once their buffers have grown nothing is allocated any more.
+// when the consumer falls behind, objects are dropped and counted instead of stalling the processing.
+// T has to have a swap() method.
+template<class T> class SlotQueue
+{
+	public:
+		SlotQueue(unsigned maxPending= 16): slots(maxPending), readIndex(0), count(0), dropped(0)
+		{ mutex= SDL_CreateMutex(); }
+
+		~SlotQueue()
+		{ SDL_DestroyMutex(mutex); }
+
+		// producer side: the slot to fill in, or 0 if the queue is full and the object is dropped
+		T *getWriteSlot()
+		{
+			SDLScopedLock lock(mutex);
+			if(count==slots.size()) { dropped++; return 0; }
+			return &slots[(readIndex+count)%slots.size()];
+		}
+
+		void commitWrite()
+		{
+			SDLScopedLock lock(mutex);
+			count++;
+		}
+
+		// consumer side: swap the oldest object into c, which gives its buffers back to the queue.
+		// returns false if there is none.
+		bool read(T &c)
+		{
+			SDLScopedLock lock(mutex);
+			if(!count) return false;
+			c.swap(slots[readIndex]);
+			readIndex= (readIndex+1)%slots.size();
+			count--;
+			return true;
+		}
+
+		uint32_t getDroppedCount()
+		{
+			SDLScopedLock lock(mutex);
+			return dropped;
+		}
+
+	private:
+		vector<T> slots;
+		size_t readIndex, count;
+		uint32_t dropped;
+		SDL_mutex *mutex;
+};
+
+// a small set of column ranges [begin, end). keeps at most two separate ranges, which is enough for a
+// scrolling display wrapping around, and merges anything beyond that into the closest range.
+class ColumnRangeSet
+{
+	public:
+		struct Range { uint32_t begin, end; };
+
+		ColumnRangeSet(): nRanges(0)
+		{ }
+
+		void clear()
+		{ nRanges= 0; }
+
+		bool empty() const
+		{ return !nRanges; }
+
+		int size() const
+		{ return nRanges; }
+
+		const Range &operator[](int i) const
+		{ return ranges[i]; }
+
+		void add(uint32_t begin, uint32_t end)
+		{
+			if(begin>=end) return;
+			int best= 0;
+			uint32_t bestGap= 0xFFFFFFFF;
+			for(int i= 0; i<nRanges; i++)
+			{
+				uint32_t gap= (end<ranges[i].begin? ranges[i].begin-end: begin>ranges[i].end? begin-ranges[i].end: 0);
+				if(gap<bestGap) bestGap= gap, best= i;
+			}
+			if(bestGap && nRanges<MAXRANGES)
+			{
+				ranges[nRanges].begin= begin;
+				ranges[nRanges].end= end;
+				nRanges++;
+				return;
+			}
+			ranges[best].begin= min(ranges[best].begin, begin);
+			ranges[best].end= max(ranges[best].end, end);
+			if(nRanges==2 && ranges[0].begin<=ranges[1].end && ranges[1].begin<=ranges[0].end)
+			{
+				ranges[0].begin= min(ranges[0].begin, ranges[1].begin);
+				ranges[0].end= max(ranges[0].end, ranges[1].end);
+				nRanges= 1;
+			}
+		}
+
+		void add(const ColumnRangeSet &other)
+		{
+			for(int i= 0; i<other.size(); i++)
+				add(other[i].begin, other[i].end);
+		}
+
+	private:
+		enum { MAXRANGES= 2 };
+		Range ranges[MAXRANGES];
+		int nRanges;
+};
+
+struct gl2DCoords { float x, y; float x1, y1; };
+struct gl3fColor { float r, g, b; float r1, g1, b1; };
+
+// colored line segments in window coordinates, collected so that they can be drawn with a single call
+struct LineBatch
+{
+	struct Vertex { float x, y; float r, g, b, a; };
+	vector<Vertex> vertices;
+
+	void clear()
+	{ vertices.clear(); }
+
+	bool empty() const
+	{ return vertices.empty(); }
+
+	void add(float x0, float y0, float x1, float y1, float r, float g, float b, float a)
+	{
+		Vertex v0= { x0, y0, r, g, b, a }, v1= { x1, y1, r, g, b, a };
+		vertices.push_back(v0);
+		vertices.push_back(v1);
+	}
+};
+
+// a finished display frame as built by the processing thread. it is never modified
+// while the render loop has it, so it can be painted without any locking.
+// the columns of all channels are stored one channel after the other in the same array.
+struct DisplayFrame
+{
+	enum { RESERVED_COLUMNS= 4096 };    // columns per channel reserved up front, so resizing the window doesn't allocate
+	AlignedArray<gl2DCoords> coords;
+	AlignedArray<gl3fColor> colors;
+	AlignedArray<gl2DCoords> rmsCoords; // -rms..+rms bar per column, only used for min/max peak display
+	unsigned nChannels;
+	uint32_t width;             // number of columns
+	uint32_t fillColumn;        // column up to which the current sweep has been filled
+	bool lineDisplayPeaks;      // true if coords/colors contain max/min pairs instead of line segments to the next column
+	bool peakEnvelope;          // peaks are a filtered envelope from 0 to the peak, to be drawn mirrored
+	bool triggerEnabled;
+	float triggerPosition;      // fraction of the sweep before the trigger event
+	float displayTime;
+	double ingestTime;          // estimated time the newest samples in the frame arrived in the ring buffer
+	enum TriggerStatus
+	{
+		TS_WAITING= 0,  // waiting for a trigger event
+		TS_TRIGGERED,   // current sweep was triggered
+		TS_AUTO,        // free-running because there was no trigger event
+		TS_STOPPED      // single shot sweep is complete
+	} triggerStatus;
+	// frames are numbered as they are published. changedColumns holds the columns which changed since the
+	// frame numbered changesSince, so a renderer keeping its own copy of the columns can update just those.
+	uint32_t serial;
+	uint32_t changesSince;
+	ColumnRangeSet changedColumns;
+
+	DisplayFrame(): nChannels(0), width(0), fillColumn(0), lineDisplayPeaks(false), peakEnvelope(false), triggerEnabled(false),
+		triggerPosition(0), displayTime(0), ingestTime(0), triggerStatus(TS_WAITING), serial(0), changesSince(0)
+	{ }
+
+	// index of the first column of a channel
+	uint32_t channelOffset(unsigned channel) const
+	{ return channel*width; }
+
+	// size the column arrays for nChannels and width
+	void resizeColumns()
+	{
+		size_t size= size_t(width)*nChannels;
+		size_t reserved= max(size, size_t(RESERVED_COLUMNS)*nChannels);
+		coords.reserve(reserved), coords.resize(size);
+		colors.reserve(reserved), colors.resize(size);
+		rmsCoords.reserve(reserved), rmsCoords.resize(size);
+	}
+
+	// fill in a column of the peak display. with the envelope display, max is the peak.
+	void setPeakColumn(unsigned channel, uint32_t column, float min, float max, float rms, bool envelope)
+	{
+		gl2DCoords &coord= coords[channelOffset(channel)+column];
+		gl3fColor &color= colors[channelOffset(channel)+column];
+		float cr0= 0.1, cg0= 1.0, cb0= 0.2;
+		float cr1= 0.1, cg1= 1.0, cb1= .8;
+		float ct= 0.5;
+		coord.x= coord.x1= column;
+		if(envelope)
+		{
+			// filtered envelope from 0 to the peak, colored from the center outwards
+			float c= fabs(max);
+			float cr= (c-.75)*4;
+			if(cr<0) cr= 0;
+			else if(cr>.75) cr= .75;
+			c= c*(1.0-ct)+ct;
+			coord.y= max; coord.y1= 0;
+			color.r1= c*cr1; color.g1= c*cg1; color.b1= c*cb1;
+			color.r= ct*cr0+cr; color.g= ct*cg0; color.b= ct*cb0;
+		}
+		else
+		{
+			// exact min..max bar, with the ends turning red when they get close to full scale
+			float crMax= (fabs(max)-.75)*4, crMin= (fabs(min)-.75)*4;
+			crMax= (crMax<0? 0: crMax>.75? .75: crMax);
+			crMin= (crMin<0? 0: crMin>.75? .75: crMin);
+			coord.y= max; coord.y1= min;
+			color.r= ct*cr0+crMax; color.g= ct*cg0; color.b= ct*cb0;
+			color.r1= ct*cr0+crMin; color.g1= ct*cg0; color.b1= ct*cb0;
+			gl2DCoords &rmsCoord= rmsCoords[channelOffset(channel)+column];
+			rmsCoord.x= rmsCoord.x1= column;
+			rmsCoord.y= rms; rmsCoord.y1= -rms;
+		}
+	}
+};
+
+// parameters of the spectrum analysis
+struct SpectrumSettings
+{
+	enum Window
+	{
+		W_RECTANGLE= 0,
+		W_HANN,
+		W_BLACKMAN_HARRIS,
+		W_FLATTOP,          // accurate amplitudes of tones between bins
+		W_COUNT
+	};
+	bool enabled;
+	uint32_t fftSize;       // power of two
+	int window;
+	float overlap;          // fraction of each transform shared with the previous one
+	uint32_t averages;      // spectra averaged exponentially, 1 for none
+	float range;            // dB shown below full scale
+	bool waterfall;         // also pass the spectrum of each transform on as a waterfall row
+
+	SpectrumSettings(): enabled(false), fftSize(4096), window(W_HANN), overlap(0.5), averages(4), range(120), waterfall(false)
+	{ }
+};
+
+// one row of the waterfall display: the spectrum of a single transform, as levels from 0 at the bottom of
+// the dB range to 255 at full scale, for each display column of each channel
+struct SpectrumRow
+{
+	uint32_t width;
+	unsigned nChannels;
+	vector<uint8_t> levels;     // one channel after the other
+
+	SpectrumRow(): width(0), nChannels(0)
+	{ }
+
+	void swap(SpectrumRow &other)
+	{
+		std::swap(width, other.width);
+		std::swap(nChannels, other.nChannels);
+		levels.swap(other.levels);
+	}
+};
+
+// spectrum analyzer running on the processing thread. the samples of each channel are collected in a ring
+// of one transform size. each time the hop between transforms has passed, the ring is windowed and
+// transformed and the power spectrum is added to the running average. the display shows the averaged
+// spectrum on a log frequency axis from MINFREQUENCY to the Nyquist frequency, in dB relative to a
+// full scale sine.
+class SpectrumAnalyzer
+{
+	public:
+		enum { MINFREQUENCY= 10 };
+
+		SpectrumAnalyzer(): nChannels(0), samplingRate(48000), hop(1), filled(0), sinceTransform(0), averaged(0),
+			newSpectrum(false), rowQueue(0), columnRate(0)
+		{ }
+
+		// reallocates and starts over when the transform or channel count change. nothing is allocated
+		// while the analyzer is disabled. width is the number of display columns.
+		void setSettings(const SpectrumSettings &s, unsigned channels, float rate, uint32_t width)
+		{
+			if(!s.enabled)
+			{
+				settings.enabled= false;
+				return;
+			}
+			uint32_t size= 1;
+			while(size<s.fftSize && size<MAXSIZE) size*= 2;
+			size= max(size, uint32_t(MINSIZE));
+			bool restart= (!settings.enabled || size!=fft.getSize() || channels!=nChannels || s.window!=settings.window ||
+						   rate!=samplingRate);
+			settings= s;
+			settings.fftSize= size;
+			samplingRate= rate;
+			float overlap= (s.overlap<0? 0: s.overlap>0.95? 0.95: s.overlap);
+			hop= max(uint32_t(size*(1-overlap)), 1u);
+			if(restart)
+			{
+				nChannels= channels;
+				fft.setSize(size);
+				makeWindow();
+				inputs.assign(size_t(size)*nChannels, 0);
+				average.assign(size_t(size/2+1)*nChannels, 0);
+				power.resize(size/2+1);
+				windowed.resize(size);
+				filled= sinceTransform= averaged= 0;
+				columnRate= 0;
+			}
+			if(width!=columns.size() || columnRate!=samplingRate) mapColumns(width);
+		}
+
+		// with the waterfall enabled in the settings, a row is written to the queue for each transform
+		void setRowQueue(SlotQueue<SpectrumRow> *q)
+		{ rowQueue= q; }
+
+		// add nFrames frames of the first nInputs channels, running the transforms which become due
+		void addSamples(jack_default_audio_sample_t * const *data, unsigned nInputs, uint32_t nFrames)
+		{
+			uint32_t size= fft.getSize();
+			if(!size) return;
+			nInputs= min(nInputs, nChannels);
+			for(uint32_t done= 0; done<nFrames; )
+			{
+				uint32_t pos= filled&(size-1);
+				uint32_t n= min(min(nFrames-done, hop-sinceTransform), size-pos);
+				for(unsigned ch= 0; ch<nInputs; ch++)
+					memcpy(&inputs[size_t(ch)*size+pos], data[ch]+done, n*sizeof(jack_default_audio_sample_t));
+				done+= n;
+				filled+= n;
+				sinceTransform+= n;
+				if(sinceTransform==hop)
+				{
+					sinceTransform= 0;
+					if(filled>=size) runTransforms(nInputs);
+				}
+			}
+		}
+
+		// returns true once after new spectra were averaged in
+		bool takeNewSpectrum()
+		{
+			bool ret= newSpectrum;
+			newSpectrum= false;
+			return ret;
+		}
+
+		// frequency shown in a display column
+		static double getColumnFrequency(double column, uint32_t width, float rate)
+		{
+			double fMax= max(rate*.5, MINFREQUENCY*2.0);
+			return MINFREQUENCY*pow(fMax/MINFREQUENCY, column/max(width-1, 1u));
+		}
+
+		// level in dB of a display value
+		static float valueToDb(float value, float range)
+		{ return (value+1)*.5f*range - range; }
+
+		// build a display frame showing the averaged spectra as line segments between the columns
+		void fillFrame(DisplayFrame &frame)
+		{
+			uint32_t width= columns.size();
+			frame.nChannels= nChannels;
+			frame.width= width;
+			frame.lineDisplayPeaks= false;
+			frame.peakEnvelope= false;
+			frame.triggerEnabled= true;     // no scrolling
+			frame.triggerPosition= 0;
+			frame.fillColumn= (width? width-1: 0);
+			frame.displayTime= double(fft.getSize())/samplingRate;
+			frame.resizeColumns();
+			uint32_t nBins= fft.getSize()/2+1;
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const float *avg= &average[size_t(ch)*nBins];
+				gl2DCoords *coords= &frame.coords[frame.channelOffset(ch)];
+				for(uint32_t c= 0; c<width; c++)
+				{
+					float value= getColumnLevel(avg, c)*2-1;
+					coords[c].x= c;
+					coords[c].y= (value<-1? -1: value>1? 1: value);
+				}
+				for(uint32_t c= 0; c<width; c++)
+				{
+					uint32_t next= min(c+1, width-1);
+					coords[c].x1= next;
+					coords[c].y1= coords[next].y;
+				}
+			}
+		}
+
+	private:
+		enum { MINSIZE= 256, MAXSIZE= 65536 };
+		// bins [begin, end) shown in a column, or the two bins to interpolate between when the column is narrower than a bin
+		struct ColumnBins { uint32_t begin, end; float frac; };
+
+		SpectrumSettings settings;
+		unsigned nChannels;
+		float samplingRate;
+		RealFFT fft;
+		uint32_t hop;
+		uint64_t filled;                    // frames written to the input rings
+		uint32_t sinceTransform;
+		uint32_t averaged;                  // spectra in the average, up to settings.averages
+		bool newSpectrum;
+		SlotQueue<SpectrumRow> *rowQueue;
+		vector<float> window;
+		float powerScale;                   // scales the power of a full scale sine to 1
+		vector<jack_default_audio_sample_t> inputs;   // ring of the last transform size frames, one channel after the other
+		vector<float> average;              // averaged power spectrum of each channel
+		vector<float> windowed, power;
+		vector<ColumnBins> columns;
+		float columnRate;
+
+		void makeWindow()
+		{
+			uint32_t size= fft.getSize();
+			static const double coefs[SpectrumSettings::W_COUNT][5]=
+			{
+				{ 1, 0, 0, 0, 0 },
+				{ 0.5, 0.5, 0, 0, 0 },
+				{ 0.35875, 0.48829, 0.14128, 0.01168, 0 },
+				{ 0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368 },
+			};
+			int type= (settings.window<0 || settings.window>=SpectrumSettings::W_COUNT? SpectrumSettings::W_HANN: settings.window);
+			const double *a= coefs[type];
+			window.resize(size);
+			double sum= 0;
+			for(uint32_t i= 0; i<size; i++)
+			{
+				double x= 2*M_PI*i/size, w= a[0];
+				for(int k= 1; k<5; k++)
+					w+= ((k&1)? -a[k]: a[k]) * cos(k*x);
+				window[i]= w;
+				sum+= w;
+			}
+			// a sine of amplitude 1 ends up in a bin with a magnitude of half the window sum
+			powerScale= 4/(sum*sum);
+		}
+
+		void runTransforms(unsigned nInputs)
+		{
+			uint32_t size= fft.getSize(), nBins= size/2+1, start= filled&(size-1);
+			averaged= min(averaged+1, max(settings.averages, 1u));
+			float weight= 1.0f/averaged;
+			uint32_t width= columns.size();
+			SpectrumRow *row= (settings.waterfall && rowQueue? rowQueue->getWriteSlot(): 0);
+			if(row)
+			{
+				row->width= width;
+				row->nChannels= nChannels;
+				row->levels.assign(size_t(width)*nChannels, 0);
+			}
+			for(unsigned ch= 0; ch<nInputs; ch++)
+			{
+				// unwrap the ring, oldest sample first
+				const jack_default_audio_sample_t *in= &inputs[size_t(ch)*size];
+				for(uint32_t i= 0, pos= start; i<size; i++, pos= (pos+1)&(size-1))
+					windowed[i]= in[pos]*window[i];
+				fft.powerSpectrum(&windowed[0], &power[0]);
+				float *avg= &average[size_t(ch)*nBins];
+				for(uint32_t k= 0; k<nBins; k++)
+					avg[k]+= (power[k]-avg[k])*weight;
+				if(row)
+				{
+					uint8_t *levels= &row->levels[size_t(ch)*width];
+					for(uint32_t c= 0; c<width; c++)
+					{
+						float level= getColumnLevel(&power[0], c);
+						levels[c]= uint8_t(level<0? 0: level>1? 255: level*255+.5f);
+					}
+				}
+			}
+			if(row) rowQueue->commitWrite();
+			newSpectrum= true;
+		}
+
+		// position of the power shown in a display column in the dB range, 0 at the bottom, 1 at full scale.
+		// a column spanning several bins shows the largest one, narrower columns interpolate.
+		float getColumnLevel(const float *power, uint32_t column)
+		{
+			const ColumnBins &bins= columns[column];
+			float p;
+			if(bins.end>bins.begin)
+				p= *max_element(power+bins.begin, power+bins.end);
+			else
+				p= power[bins.begin] + (power[bins.begin+1]-power[bins.begin])*bins.frac;
+			float db= 10*log10f(p*powerScale+1e-30f);
+			return (db+settings.range)/settings.range;
+		}
+
+		void mapColumns(uint32_t width)
+		{
+			columns.resize(width);
+			columnRate= samplingRate;
+			uint32_t nBins= fft.getSize()/2+1;
+			double binWidth= double(samplingRate)/fft.getSize();
+			for(uint32_t c= 0; c<width; c++)
+			{
+				double b0= getColumnFrequency(c-.5, width, samplingRate)/binWidth,
+					   b1= getColumnFrequency(c+.5, width, samplingRate)/binWidth,
+					   b= getColumnFrequency(c, width, samplingRate)/binWidth;
+				ColumnBins &bins= columns[c];
+				bins.begin= min(uint32_t(ceil(b0)), nBins-1);
+				bins.end= min(uint32_t(ceil(b1)), nBins);
+				if(bins.end<=bins.begin)
+				{
+					bins.begin= min(uint32_t(b), nBins-2);
+					bins.end= bins.begin;
+					bins.frac= min(b-bins.begin, 1.0);
+				}
+			}
+		}
+};
+
+// parameters of the persistence display
+struct PhosphorSettings
+{
+	bool enabled;
+	uint32_t rows;          // vertical resolution of the histograms, normally the lane height in pixels
+	float range;            // the rows cover values from +range at the top to -range at the bottom
+	float persistence;      // seconds for the hits to fade to 1/e, 0 keeps them forever
+
+	PhosphorSettings(): enabled(false), rows(256), range(1), persistence(0.5)
+	{ }
+};
+
+// intensity graded images of the persistence display, built by the processing thread
+struct PhosphorFrame
+{
+	uint32_t width, rows;
+	unsigned nChannels;
+	vector<uint8_t> levels;     // rows of width levels 0..255 from the top, one channel after the other
+	float waveformRate;         // sweeps per second drawn into the histograms
+	uint32_t serial;
+
+	PhosphorFrame(): width(0), rows(0), nChannels(0), waveformRate(0), serial(0)
+	{ }
+
+	const uint8_t *getChannel(unsigned channel) const
+	{ return &levels[size_t(channel)*rows*width]; }
+};
+
+// digital phosphor: every sweep is drawn into a 2D histogram of hits per channel, which fades away
+// exponentially with stream time. in each column, a sweep hits every row between the lowest and the
+// highest value the trace takes there, so steep edges leave a line too. decay and the mapping to levels
+// run with the SIMD kernels when a frame is filled, not for every sweep, so thousands of sweeps per
+// second cost little more than drawing their columns.
+class PhosphorAccumulator
+{
+	public:
+		PhosphorAccumulator(): width(0), rows(0), nChannels(0), viewSize(0), range(1), persistence(0), samplingRate(48000),
+			decayStarted(false), lastDecayPos(0), rateSweeps(0), rateTime(0), waveformRate(0), kernel(selectKernel<PhosphorFuncs, getPhosphorKernels>())
+		{ }
+
+		// the histograms start over when their size or meaning changes. while the display is disabled they
+		// are left alone, and set up again when it is enabled.
+		void setSettings(const PhosphorSettings &s, unsigned channels, uint32_t columns, uint32_t sweepSize, float rate)
+		{
+			uint32_t newRows= max(s.rows, 1u);
+			if(!s.enabled)
+				width= 0;
+			else if(channels!=nChannels || columns!=width || newRows!=rows || sweepSize!=viewSize || s.range!=range)
+			{
+				nChannels= channels;
+				width= columns;
+				rows= newRows;
+				viewSize= sweepSize;
+				range= s.range;
+				hits.assign(size_t(width)*rows*nChannels, 0);
+			}
+			persistence= max(s.persistence, 0.0f);
+			samplingRate= rate;
+		}
+
+		void clear()
+		{ fill(hits.begin(), hits.end(), 0.0f); }
+
+		// draw one sweep of n samples for each channel. the sample arrays start with the sample before the
+		// sweep and end with the one after it, n+2 samples. the sweep is shifted left by fraction samples,
+		// like the line display does for the sub-sample position of the trigger crossing.
+		void addSweep(const float * const *samples, uint32_t n, float fraction)
+		{
+			if(!width || !n) return;
+			double step= double(n)/width, rowScale= rows/(2*range);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const float *s= samples[ch]+1;
+				float *channelHits= &hits[size_t(ch)*rows*width];
+				for(uint32_t column= 0; column<width; column++)
+				{
+					double a= column*step-fraction, b= a+step;
+					float lo= valueAt(s, n, a), hi= lo, vb= valueAt(s, n, b);
+					lo= min(lo, vb);
+					hi= max(hi, vb);
+					int64_t last= min(int64_t(ceil(b))-1, int64_t(n)-1);
+					for(int64_t i= max(int64_t(floor(a))+1, int64_t(0)); i<=last; i++)
+						lo= min(lo, s[i]), hi= max(hi, s[i]);
+					int top= rowOf(hi, rowScale), bottom= rowOf(lo, rowScale);
+					float *h= channelHits+size_t(top)*width+column;
+					for(int row= top; row<=bottom; row++, h+= width)
+						*h+= 1;
+				}
+			}
+			rateSweeps++;
+		}
+
+		// decay the histograms up to stream position streamPos and map them to levels, each channel
+		// relative to its most frequently hit pixel
+		void fillFrame(PhosphorFrame &frame, uint64_t streamPos)
+		{
+			double elapsed= (decayStarted? (streamPos-lastDecayPos)/samplingRate: 0);
+			decayStarted= true;
+			lastDecayPos= streamPos;
+			float factor= (persistence>0? exp(-elapsed/persistence): 1);
+			frame.width= width;
+			frame.rows= rows;
+			frame.nChannels= nChannels;
+			frame.levels.resize(hits.size());
+			size_t n= size_t(width)*rows;
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				float largest= kernel.decay(&hits[ch*n], n, factor);
+				kernel.levels(&hits[ch*n], &frame.levels[ch*n], n, largest>0? 255*255/largest: 0);
+			}
+			// the waveform rate is averaged over half a second
+			rateTime+= elapsed;
+			if(rateTime>=0.5)
+			{
+				waveformRate= rateSweeps/rateTime;
+				rateSweeps= 0;
+				rateTime= 0;
+			}
+			frame.waveformRate= waveformRate;
+		}
+
+		// used by the benchmark to compare the kernels
+		void setKernel(const PhosphorFuncs &k)
+		{ kernel= k; }
+
+	private:
+		uint32_t width, rows;
+		unsigned nChannels;
+		uint32_t viewSize;
+		float range;
+		float persistence;
+		float samplingRate;
+		bool decayStarted;
+		uint64_t lastDecayPos;
+		uint32_t rateSweeps;
+		double rateTime;            // seconds of stream time for the waveform rate
+		float waveformRate;
+		vector<float> hits;         // rows of width counts from the top, one channel after the other
+		PhosphorFuncs kernel;
+
+		// the trace between samples is linear, the samples before and after the sweep are at -1 and n
+		static float valueAt(const float *s, uint32_t n, double pos)
+		{
+			pos= (pos<-1? -1: pos>n? n: pos);
+			int64_t i= int64_t(floor(pos));
+			float f= pos-i;
+			return (f>0? s[i]+(s[i+1]-s[i])*f: s[i]);
+		}
+
+		// clamped before the conversion, which is undefined for NaN and out of range values. NaN is taken as 0.
+		int rowOf(float value, double rowScale)
+		{
+			double row= (range-(value==value? value: 0))*rowScale;
+			return int(row<0? 0: row>=rows? rows-1: row);
+		}
+};
+
+// parameters of the XY display
+struct XYSettings
+{
+	enum Mode { XY_OFF= 0, XY_PLOT, XY_GONIOMETER };
+	int mode;
+	unsigned xChannel;      // horizontal axis of the plot, left channel of the goniometer
+	unsigned yChannel;      // vertical axis of the plot, right channel of the goniometer
+
+	XYSettings(): mode(XY_OFF), xChannel(0), yChannel(1)
+	{ }
+};
+
+// phase correlation of two signals: +1 for the same signal on both, 0 for unrelated signals, -1 for the
+// same signal with opposite polarity. the sums of the products fade exponentially, updated once for each
+// chunk of samples, so this costs a few multiply-adds per sample pair.
+class CorrelationMeter
+{
+	public:
+		CorrelationMeter(): sxx(0), syy(0), sxy(0), chunkDecay(1), samplingRate(0), timeConstant(0)
+		{ setup(48000); }
+
+		// seconds for the sums to fade to 1/e
+		void setup(float rate, float seconds= 0.3)
+		{
+			if(rate==samplingRate && seconds==timeConstant) return;
+			samplingRate= rate;
+			timeConstant= seconds;
+			chunkDecay= exp(-double(CHUNK)/(samplingRate*timeConstant));
+		}
+
+		void reset()
+		{ sxx= syy= sxy= 0; }
+
+		void add(const float *x, const float *y, uint32_t n)
+		{
+			for(uint32_t pos= 0; pos<n; pos+= CHUNK)
+			{
+				uint32_t len= min(n-pos, uint32_t(CHUNK));
+				// four partial sums, so that the loop doesn't wait for the previous addition
+				float xx[4]= { 0 }, yy[4]= { 0 }, xy[4]= { 0 };
+				uint32_t i= 0;
+				for(; i+4<=len; i+= 4)
+					for(int k= 0; k<4; k++)
+					{
+						float a= x[pos+i+k], b= y[pos+i+k];
+						xx[k]+= a*a, yy[k]+= b*b, xy[k]+= a*b;
+					}
+				for(; i<len; i++)
+				{
+					float a= x[pos+i], b= y[pos+i];
+					xx[0]+= a*a, yy[0]+= b*b, xy[0]+= a*b;
+				}
+				double decay= (len==CHUNK? chunkDecay: exp(-double(len)/(samplingRate*timeConstant)));
+				sxx= sxx*decay + (xx[0]+xx[1]) + (xx[2]+xx[3]);
+				syy= syy*decay + (yy[0]+yy[1]) + (yy[2]+yy[3]);
+				sxy= sxy*decay + (xy[0]+xy[1]) + (xy[2]+xy[3]);
+			}
+		}
+
+		// 0 while either signal is silent
+		float get() const
+		{
+			double energy= sqrt(sxx*syy);
+			return (energy>1e-20? max(-1.0, min(1.0, sxy/energy)): 0);
+		}
+
+	private:
+		enum { CHUNK= 256 };
+		double sxx, syy, sxy;
+		double chunkDecay;
+		float samplingRate, timeConstant;
+};
+
+// pass/fail limits for the sweeps: a lower and an upper envelope for each channel, given as points over the
+// sweep with straight lines between them. the file has one point per line:
+//   channel position lower upper
+// the position goes from 0 at the start of the sweep to 1 at its end. channel * applies to all channels
+// which have no points of their own. empty lines and lines starting with # are skipped.
+class Mask
+{
+	public:
+		struct Point
+		{
+			float position, lower, upper;
+
+			bool operator<(const Point &other) const
+			{ return position<other.position; }
+		};
+
+		bool load(const char *filename)
+		{
+			channels.clear();
+			allChannels.clear();
+			ifstream f(filename);
+			if(f.fail())
+			{
+				fprintf(stderr, "couldn't open mask file %s: %s\n", filename, strerror(errno));
+				return false;
+			}
+			string line;
+			for(int lineNumber= 1; getline(f, line); lineNumber++)
+			{
+				size_t first= line.find_first_not_of(" \t\r");
+				if(first==string::npos || line[first]=='#') continue;
+				char channel[16];
+				Point p;
+				int ch= -1;
+				if(sscanf(line.c_str(), "%15s %f %f %f", channel, &p.position, &p.lower, &p.upper)!=4 ||
+				   (strcmp(channel, "*") && (sscanf(channel, "%d", &ch)!=1 || ch<0 || ch>=1024)) || p.lower>p.upper)
+				{
+					fprintf(stderr, "%s:%d: expected channel, position, lower and upper limit\n", filename, lineNumber);
+					return false;
+				}
+				if(ch<0)
+					allChannels.push_back(p);
+				else
+				{
+					if(unsigned(ch)>=channels.size()) channels.resize(ch+1);
+					channels[ch].push_back(p);
+				}
+			}
+			stable_sort(allChannels.begin(), allChannels.end());
+			for(size_t i= 0; i<channels.size(); i++)
+				stable_sort(channels[i].begin(), channels[i].end());
+			return true;
+		}
+
+		// the points of a channel, 0 if it has no limits
+		const vector<Point> *getPoints(unsigned channel) const
+		{
+			if(channel<channels.size() && !channels[channel].empty()) return &channels[channel];
+			return allChannels.empty()? 0: &allChannels;
+		}
+
+		// the limits of a channel at n positions spread evenly over the sweep, from 0 to 1. returns false
+		// if the channel has no limits.
+		bool resample(unsigned channel, uint32_t n, float *lower, float *upper) const
+		{
+			const vector<Point> *points= getPoints(channel);
+			if(!points) return false;
+			const vector<Point> &p= *points;
+			size_t k= 0;
+			for(uint32_t i= 0; i<n; i++)
+			{
+				float pos= (n>1? float(i)/(n-1): 0);
+				while(k+1<p.size() && p[k+1].position<=pos) k++;
+				if(pos<=p[k].position || k+1==p.size())
+					lower[i]= p[k].lower, upper[i]= p[k].upper;
+				else
+				{
+					float f= (pos-p[k].position)/(p[k+1].position-p[k].position);
+					lower[i]= p[k].lower + (p[k+1].lower-p[k].lower)*f;
+					upper[i]= p[k].upper + (p[k+1].upper-p[k].upper)*f;
+				}
+			}
+			return true;
+		}
+
+	private:
+		vector< vector<Point> > channels;
+		vector<Point> allChannels;
+};
+
+// checks sweeps against a mask resampled to the sweep length, with one SIMD compare pass per channel
+class MaskTester
+{
+	public:
+		MaskTester(): mask(0), size(0), nChannels(0), compare(selectKernel<MaskCompareFunc, getMaskKernels>())
+		{ }
+
+		// the limits are reserved for sweeps of up to maxSweepSize, so changing the sweep size doesn't allocate
+		void setup(const Mask *m, unsigned channels, uint32_t sweepSize, uint32_t maxSweepSize)
+		{
+			if(m==mask && channels==nChannels && sweepSize==size) return;
+			mask= m;
+			nChannels= channels;
+			size= sweepSize;
+			if(mask) limits.reserve(size_t(nChannels)*max(size, maxSweepSize)*2);
+			limits.resize(size_t(nChannels)*size*2);
+			active.assign(nChannels, false);
+			for(unsigned ch= 0; ch<nChannels && mask; ch++)
+				active[ch]= mask->resample(ch, size, getLower(ch), getUpper(ch));
+		}
+
+		bool hasLimits(unsigned channel) const
+		{ return channel<nChannels && active[channel]; }
+
+		// number of samples of a channel outside of its limits. the sweep is in two parts, the way it is
+		// in the history ring: n1 samples at part1, the rest at part2.
+		uint32_t test(unsigned channel, const float *part1, uint32_t n1, const float *part2)
+		{
+			if(!hasLimits(channel)) return 0;
+			const float *lower= getLower(channel), *upper= getUpper(channel);
+			uint32_t count= compare(part1, lower, upper, n1);
+			if(n1<size) count+= compare(part2, lower+n1, upper+n1, size-n1);
+			return count;
+		}
+
+		// used by the benchmark to compare the kernels
+		void setKernel(MaskCompareFunc k)
+		{ compare= k; }
+
+	private:
+		const Mask *mask;
+		uint32_t size;
+		unsigned nChannels;
+		AlignedArray<float> limits;     // lower and upper limits of each channel, one after the other
+		vector<bool> active;
+		MaskCompareFunc compare;
+
+		float *getLower(unsigned channel)
+		{ return &limits[size_t(channel)*size*2]; }
+
+		float *getUpper(unsigned channel)
+		{ return &limits[size_t(channel)*size*2+size]; }
+};
+
+// counts of the mask test since it was enabled
+struct MaskResults
+{
+	uint32_t sweeps;            // sweeps tested
+	uint32_t failedSweeps;      // sweeps with samples outside of the limits on any channel
+	vector<uint64_t> violations;    // samples outside of the limits, per channel
+	uint64_t lastFailurePos;    // stream position of the last failed sweep
+
+	MaskResults(): sweeps(0), failedSweeps(0), lastFailurePos(0)
+	{ }
+};
+
+// sequence acquisition: consecutive sweeps stored one after the other in memory which is allocated up front,
+// so that a burst of trigger events is caught sweep by sweep, however many of them come in a jack period.
+// once all segments are filled the sequence is complete, and the memory holds still until it is armed again.
+class SegmentMemory
+{
+	public:
+		struct Segment
+		{
+			uint64_t streamPos;         // stream position of the first sample
+			uint32_t triggerOffset;     // index of the trigger event in the segment
+			float triggerFraction;      // the threshold crossing was this fraction of a sample before the trigger event
+			DisplayFrame::TriggerStatus triggerStatus;
+			double time;                // seconds from the trigger event of the first segment to the one of this segment
+		};
+
+		// the number of segments is limited to what fits into this many bytes
+		enum { MAX_BYTES= 256<<20 };
+
+		SegmentMemory(): capacity(0), nChannels(0), size(0), samplingRate(0), count(0)
+		{ }
+
+		// a change of the shape starts a new sequence. the memory is reserved for segments of up to
+		// maxSegmentSize samples, so only changing the number of segments or channels allocates.
+		void setup(uint32_t nSegments, unsigned channels, uint32_t segmentSize, uint32_t maxSegmentSize, float rate)
+		{
+			if(hasShape(nSegments, channels, segmentSize, rate)) return;
+			capacity= getCapacity(nSegments, channels, segmentSize);
+			nChannels= channels;
+			size= segmentSize;
+			samplingRate= rate;
+			uint32_t maxSize= max(segmentSize, maxSegmentSize);
+			samples.reserve(size_t(getCapacity(nSegments, channels, maxSize))*nChannels*maxSize);
+			samples.resize(size_t(capacity)*nChannels*size);
+			segments.reserve(nSegments);
+			segments.resize(capacity);
+			count= 0;
+		}
+
+		// whether setup() with these would leave the memory as it is
+		bool hasShape(uint32_t nSegments, unsigned channels, uint32_t segmentSize, float rate) const
+		{
+			return getCapacity(nSegments, channels, segmentSize)==capacity && channels==nChannels &&
+				   segmentSize==size && rate==samplingRate;
+		}
+
+		// start a new sequence
+		void clear()
+		{ count= 0; }
+
+		uint32_t getCapacity() const
+		{ return capacity; }
+
+		uint32_t getCount() const
+		{ return count; }
+
+		bool isFull() const
+		{ return count>=capacity; }
+
+		unsigned getNumChannels() const
+		{ return nChannels; }
+
+		uint32_t getSize() const
+		{ return size; }
+
+		float getSamplingRate() const
+		{ return samplingRate; }
+
+		const Segment &getSegment(uint32_t index) const
+		{ return segments[index]; }
+
+		const jack_default_audio_sample_t *getChannel(uint32_t index, unsigned channel) const
+		{ return &samples[(size_t(index)*nChannels+channel)*size]; }
+
+		// the next segment is filled in place, then added with commit()
+		Segment &getNextSegment()
+		{ return segments[count]; }
+
+		jack_default_audio_sample_t *getNextChannel(unsigned channel)
+		{ return &samples[(size_t(count)*nChannels+channel)*size]; }
+
+		// the number of segments which fit into MAX_BYTES
+		static uint32_t getCapacity(uint32_t nSegments, unsigned channels, uint32_t segmentSize)
+		{
+			uint64_t segmentBytes= uint64_t(max(channels, 1u))*max(segmentSize, 1u)*sizeof(jack_default_audio_sample_t);
+			return uint32_t(min(uint64_t(nSegments), uint64_t(MAX_BYTES)/segmentBytes));
+		}
+
+		void commit()
+		{
+			Segment &s= segments[count];
+			const Segment &first= segments[0];
+			s.time= (double(s.streamPos-first.streamPos) + double(s.triggerOffset)-first.triggerOffset -
+					 (s.triggerFraction-first.triggerFraction)) / samplingRate;
+			count++;
+		}
+
+	private:
+		uint32_t capacity;
+		unsigned nChannels;
+		uint32_t size;                      // samples per channel of each segment
+		float samplingRate;
+		uint32_t count;                     // segments filled in the current sequence
+		AlignedArray<jack_default_audio_sample_t> samples;  // the channels of each segment, one after the other
+		vector<Segment> segments;
+};
+
+// the filters which run on the input before triggering and display
+struct FilterSettings
+{
+	enum Type { FT_OFF= 0, FT_LOWPASS, FT_HIGHPASS, FT_BANDPASS, FT_COUNT };
+	int type;
+	float lowpassFrequency;     // cutoff of the low pass and upper edge of the band pass, Hz
+	float highpassFrequency;    // cutoff of the high pass and lower edge of the band pass, Hz
+	bool dcRemoval;
+	bool triggerOnly;           // filter only the signal the trigger sees, the display stays unfiltered
+	unsigned decimation;        // keep only every n-th frame, after an anti-aliasing filter
+
+	FilterSettings(): type(FT_OFF), lowpassFrequency(1000), highpassFrequency(100), dcRemoval(false),
+		triggerOnly(false), decimation(1)
+	{ }
+
+	bool filtering() const
+	{ return type!=FT_OFF || dcRemoval; }
+
+	bool operator==(const FilterSettings &other) const
+	{
+		return type==other.type && lowpassFrequency==other.lowpassFrequency && highpassFrequency==other.highpassFrequency &&
+			   dcRemoval==other.dcRemoval && triggerOnly==other.triggerOnly && decimation==other.decimation;
+	}
+};
+
+// per-channel filter chain on whole blocks of input. decimation comes first, so the filters run at the
+// reduced rate; the filtered output either replaces the input or, in trigger only mode, is a filtered
+// copy of the trigger source channel. the filters use a BiquadBank, so all channels are filtered at once.
+class FilterChain
+{
+	public:
+		FilterChain(): nChannels(0), inputRate(0), triggerChannel(0), decimationPhase(0), configured(false), outputs(0)
+		{ }
+
+		// the filters are set up again and start from silence whenever anything has changed
+		void setSettings(const FilterSettings &s, unsigned channels, float rate, unsigned trigger)
+		{
+			trigger= min(trigger, max(channels, 1u)-1);
+			if(configured && s==settings && channels==nChannels && rate==inputRate && trigger==triggerChannel)
+				return;
+			configured= true;
+			settings= s;
+			settings.decimation= max(s.decimation, 1u);
+			nChannels= channels;
+			inputRate= rate;
+			triggerChannel= trigger;
+			decimationPhase= 0;
+
+			float outputRate= inputRate/settings.decimation;
+			Butterworth design;
+			if(settings.decimation>1)
+			{
+				// keeps aliases out of the lower 80% of the new bandwidth
+				design.setFrequency(outputRate*0.4, inputRate, false, 8);
+				decimator.setup(nChannels, design.getNumSections());
+				for(unsigned ch= 0; ch<nChannels; ch++)
+					for(int i= 0; i<design.getNumSections(); i++)
+						decimator.setSection(ch, i, design.getSection(i));
+			}
+
+			vector<Biquad> sections;
+			if(settings.dcRemoval)
+			{
+				// one pole high pass at 2 Hz
+				float r= exp(-2*M_PI*2/outputRate);
+				Biquad dc= { 1, -1, 0, -r, 0 };
+				sections.push_back(dc);
+			}
+			if(settings.type==FilterSettings::FT_HIGHPASS || settings.type==FilterSettings::FT_BANDPASS)
+			{
+				design.setFrequency(clampFrequency(settings.highpassFrequency, outputRate), outputRate, true);
+				for(int i= 0; i<design.getNumSections(); i++) sections.push_back(design.getSection(i));
+			}
+			if(settings.type==FilterSettings::FT_LOWPASS || settings.type==FilterSettings::FT_BANDPASS)
+			{
+				design.setFrequency(clampFrequency(settings.lowpassFrequency, outputRate), outputRate, false);
+				for(int i= 0; i<design.getNumSections(); i++) sections.push_back(design.getSection(i));
+			}
+			unsigned nFiltered= (settings.triggerOnly? 1: nChannels);
+			filters.setup(nFiltered, sections.size());
+			for(unsigned ch= 0; ch<nFiltered; ch++)
+				for(unsigned i= 0; i<sections.size(); i++)
+					filters.setSection(ch, i, sections[i]);
+		}
+
+		// if not, the input can be used as it is
+		bool isActive()
+		{ return configured && nChannels && (settings.decimation>1 || settings.filtering()); }
+
+		// filter a block of input, returns the number of output frames, which are found in getOutputs()
+		// and getTriggerOutput() afterwards. the buffers only grow, so there is nothing to allocate
+		// once the largest block size has been seen.
+		uint32_t process(jack_default_audio_sample_t **in, uint32_t nFrames)
+		{
+			bool filterAll= settings.filtering() && !settings.triggerOnly;
+			uint32_t n= nFrames;
+			unsigned phase= 0;
+			outputs= in;
+			if(settings.decimation>1 || filterAll)
+			{
+				buffers.resize(nChannels);
+				outputPointers.resize(nChannels);
+				for(unsigned ch= 0; ch<nChannels; ch++)
+				{
+					if(buffers[ch].size()<nFrames) buffers[ch].resize(nFrames);
+					outputPointers[ch]= &buffers[ch][0];
+				}
+				outputs= &outputPointers[0];
+			}
+			if(settings.decimation>1)
+				n= decimator.process(in, outputs, nFrames, settings.decimation, decimationPhase);
+			if(filterAll)
+				filters.process(settings.decimation>1? outputs: in, outputs, n, 1, phase);
+			else if(settings.filtering())
+			{
+				if(triggerBuffer.size()<max(n, 1u)) triggerBuffer.resize(max(n, 1u));
+				jack_default_audio_sample_t *dest= &triggerBuffer[0];
+				filters.process(outputs+triggerChannel, &dest, n, 1, phase);
+			}
+			return n;
+		}
+
+		jack_default_audio_sample_t **getOutputs()
+		{ return outputs; }
+
+		// the filtered trigger source in trigger only mode, otherwise 0
+		const jack_default_audio_sample_t *getTriggerOutput()
+		{ return (settings.triggerOnly && settings.filtering()? &triggerBuffer[0]: 0); }
+
+	private:
+		FilterSettings settings;
+		unsigned nChannels;
+		float inputRate;
+		unsigned triggerChannel;
+		unsigned decimationPhase;
+		bool configured;
+		BiquadBank decimator, filters;
+		vector< vector<jack_default_audio_sample_t> > buffers;
+		vector<jack_default_audio_sample_t*> outputPointers;
+		vector<jack_default_audio_sample_t> triggerBuffer;
+		jack_default_audio_sample_t **outputs;
+
+		static float clampFrequency(float f, float rate)
+		{ return (f<1? 1: f>rate*0.45f? rate*0.45f: f); }
+};
+
+// parameters of the processing side, set from the GUI
+struct ScopeSettings
+{
+	unsigned channels;
+	uint32_t displaySamples;
+	uint32_t maxDisplaySamples; // the longest sweep the controls allow, the buffers are sized for it up front
+	uint32_t columns;
+	TriggerSettings trigger;
+	bool peakEnvelope;      // display the filtered peak envelope instead of exact min/max values when zoomed out
+	bool sincInterpolation; // band-limited reconstruction between the samples of the line display, instead of linear
+	float samplingRate;         // after decimation
+	SpectrumSettings spectrum;
+	FilterSettings filter;
+	PhosphorSettings phosphor;
+	XYSettings xy;
+	bool measurements;          // run the measurement engines
+	bool maskTest;              // test the sweeps against the mask, if the processor has one
+	uint32_t segments;          // sweeps stored by the sequence acquisition, 0 for none
+	uint32_t segmentArmCount;   // incremented to start a new sequence
+
+	ScopeSettings(): channels(2), displaySamples(480), maxDisplaySamples(0), columns(0), peakEnvelope(false), sincInterpolation(false), samplingRate(48000),
+		measurements(false), maskTest(false), segments(0), segmentArmCount(0)
+	{ }
+};
+
+// running summary of a signal
+struct SignalStats
+{
+	float min, max;
+	double sum, sumSquares;
+	uint64_t count;
+
+	SignalStats()
+	{ clear(); }
+
+	void clear()
+	{ min= max= 0; sum= sumSquares= 0; count= 0; }
+
+	void add(const jack_default_audio_sample_t *samples, uint32_t n)
+	{
+		if(!n) return;
+		float lo= samples[0], hi= samples[0];
+		double s= 0, s2= 0;
+		for(uint32_t i= 0; i<n; i++)
+		{
+			float v= samples[i];
+			lo= (v<lo? v: lo); hi= (v>hi? v: hi);
+			s+= v; s2+= v*v;
+		}
+		if(!count) min= lo, max= hi;
+		else min= (lo<min? lo: min), max= (hi>max? hi: max);
+		sum+= s; sumSquares+= s2; count+= n;
+	}
+
+	double mean() const
+	{ return count? sum/count: 0; }
+
+	double rms() const
+	{ return count? sqrt(sumSquares/count): 0; }
+};
+
+// results of the measurements on one channel, taken over one measurement interval
+struct Measurement
+{
+	float min, max, mean, rms;
+	float frequency;        // Hz, 0 if no period was found
+	float dutyCycle;        // part of the period above the middle level
+	float riseTime;         // seconds from 10% to 90% of the peak to peak range, 0 if there was no edge
+	float fallTime;         // same from 90% to 10%
+
+	Measurement(): min(0), max(0), mean(0), rms(0), frequency(0), dutyCycle(0), riseTime(0), fallTime(0)
+	{ }
+
+	float peakToPeak() const
+	{ return max-min; }
+
+	float period() const
+	{ return frequency>0? 1/frequency: 0; }
+};
+
+// streaming measurements of one channel. every sample goes through a few comparisons once, nothing is
+// buffered or scanned again. the levels for the crossings come from the range of the previous interval:
+// the middle, with hysteresis, for the period and duty cycle, 10% and 90% for the rise and fall times.
+// crossing times are interpolated between the samples.
+class MeasurementEngine
+{
+	public:
+		MeasurementEngine(): samplingRate(48000)
+		{ reset(); }
+
+		void reset()
+		{
+			sums.clear();
+			clearSums();
+			position= 0;
+			previous= 0;
+			levelsValid= false;
+			high= riseArmed= fallArmed= false;
+			lastRise= lastFall= midUp= midDown= lowUp= highDown= -1;
+			frequency= dutyCycle= riseTime= fallTime= 0;
+		}
+
+		void setRate(float rate)
+		{
+			if(rate==samplingRate) return;
+			samplingRate= rate;
+			reset();
+		}
+
+		void add(const jack_default_audio_sample_t *samples, uint32_t n)
+		{
+			if(!n) return;
+			sums.add(samples, n);
+			if(!position) previous= samples[0];
+			if(levelsValid) track(samples, n);
+			else previous= samples[n-1];
+			position+= n;
+		}
+
+		// results since the last call, then start the next interval
+		void take(Measurement &m)
+		{
+			m.min= sums.min;
+			m.max= sums.max;
+			m.mean= sums.mean();
+			m.rms= sums.rms();
+			// without a new period, the last one stays valid for twice its length
+			if(periodCount)
+				frequency= samplingRate*periodCount/periodSum;
+			else if(frequency>0 && position-lastRise>2*samplingRate/frequency)
+				frequency= dutyCycle= riseTime= fallTime= 0;
+			if(dutyCount) dutyCycle= dutySum/dutyCount;
+			if(riseCount) riseTime= riseSum/riseCount/samplingRate;
+			if(fallCount) fallTime= fallSum/fallCount/samplingRate;
+			m.frequency= frequency;
+			m.dutyCycle= dutyCycle;
+			m.riseTime= riseTime;
+			m.fallTime= fallTime;
+
+			float range= sums.max-sums.min;
+			levelsValid= (sums.count && range>1e-6f);
+			if(levelsValid)
+			{
+				midLevel= sums.min+range*.5f;
+				hysteresis= range*.05f;
+				lowLevel= sums.min+range*.1f;
+				highLevel= sums.min+range*.9f;
+			}
+			sums.clear();
+			clearSums();
+		}
+
+	private:
+		float samplingRate;
+		SignalStats sums;
+		uint64_t position;          // of the next sample
+		float previous;             // the sample before it
+		bool levelsValid;
+		float midLevel, hysteresis, lowLevel, highLevel;
+		bool high;                  // above the middle level, with hysteresis
+		bool riseArmed, fallArmed;  // below 10% since the last rise, above 90% since the last fall
+		// sample positions of the last crossings
+		double lastRise, lastFall, midUp, midDown, lowUp, highDown;
+		double periodSum, dutySum, riseSum, fallSum;
+		uint32_t periodCount, dutyCount, riseCount, fallCount;
+		float frequency, dutyCycle, riseTime, fallTime;
+
+		void clearSums()
+		{
+			periodSum= dutySum= riseSum= fallSum= 0;
+			periodCount= dutyCount= riseCount= fallCount= 0;
+		}
+
+		// position where the line from the previous sample at t-1 to v at t crosses level
+		static double crossing(double t, float prev, float v, float level)
+		{ return t-1 + (level-prev)/(v-prev); }
+
+		void track(const jack_default_audio_sample_t *samples, uint32_t n)
+		{
+			float prev= previous;
+			for(uint32_t i= 0; i<n; i++)
+			{
+				float v= samples[i];
+				double t= double(position+i);
+				if(prev<=midLevel && v>midLevel) midUp= crossing(t, prev, v, midLevel);
+				else if(prev>=midLevel && v<midLevel) midDown= crossing(t, prev, v, midLevel);
+				if(!high && v>midLevel+hysteresis)
+				{
+					// a period ends at each rising edge, the high part of it ended at the falling edge before
+					high= true;
+					if(lastRise>=0)
+					{
+						periodSum+= midUp-lastRise;
+						periodCount++;
+						if(lastFall>lastRise)
+							dutySum+= (lastFall-lastRise)/(midUp-lastRise), dutyCount++;
+					}
+					lastRise= midUp;
+				}
+				else if(high && v<midLevel-hysteresis)
+				{
+					high= false;
+					lastFall= midDown;
+				}
+				if(v<lowLevel) riseArmed= true;
+				if(v>highLevel) fallArmed= true;
+				if(prev<=lowLevel && v>lowLevel) lowUp= crossing(t, prev, v, lowLevel);
+				if(prev>=highLevel && v<highLevel) highDown= crossing(t, prev, v, highLevel);
+				if(riseArmed && prev<highLevel && v>=highLevel)
+				{
+					riseSum+= crossing(t, prev, v, highLevel)-lowUp;
+					riseCount++;
+					riseArmed= false;
+				}
+				if(fallArmed && prev>lowLevel && v<=lowLevel)
+				{
+					fallSum+= crossing(t, prev, v, lowLevel)-highDown;
+					fallCount++;
+					fallArmed= false;
+				}
+				prev= v;
+			}
+			previous= prev;
+		}
+};
+
+// the samples of a completed sweep, copied out of the history
+struct SweepCapture
+{
+	uint64_t streamPos;         // stream position of the first sample
+	uint32_t nFrames;
+	unsigned nChannels;
+	uint32_t triggerOffset;     // index of the trigger event in the sweep, for triggered sweeps
+	float triggerFraction;      // the threshold crossing was this fraction of a sample before the trigger event
+	DisplayFrame::TriggerStatus triggerStatus;
+	float samplingRate;
+	vector<jack_default_audio_sample_t> samples;    // one channel after the other
+
+	SweepCapture(): streamPos(0), nFrames(0), nChannels(0), triggerOffset(0), triggerFraction(0), triggerStatus(DisplayFrame::TS_WAITING),
+		samplingRate(0)
+	{ }
+
+	const jack_default_audio_sample_t *getChannel(unsigned channel) const
+	{ return &samples[size_t(channel)*nFrames]; }
+
+	// exchange contents without copying the samples, so the buffers can be recycled
+	void swap(SweepCapture &other)
+	{
+		std::swap(streamPos, other.streamPos);
+		std::swap(nFrames, other.nFrames);
+		std::swap(nChannels, other.nChannels);
+		std::swap(triggerOffset, other.triggerOffset);
+		std::swap(triggerFraction, other.triggerFraction);
+		std::swap(triggerStatus, other.triggerStatus);
+		std::swap(samplingRate, other.samplingRate);
+		samples.swap(other.samples);
+	}
+};
+
+typedef SlotQueue<SweepCapture> CaptureQueue;
+
+// receives the samples as the processing thread reads them from the ring buffer, one pointer per input.
+// implementations only copy, they must never block or allocate.
+class SampleSink
+{
+	public:
+		virtual ~SampleSink() { }
+		virtual void write(jack_default_audio_sample_t * const *inputs, unsigned nInputs, uint32_t nFrames)= 0;
+};
+
+// records selected channels to WAV files without ever stalling the thread which feeds it. the samples are
+// interleaved into a ring of large page-aligned blocks, which a writer thread writes with O_DIRECT, past the
+// page cache. when the writer falls behind, frames are dropped and counted. files are started anew after a
+// number of bytes or seconds, and become RF64 when they grow past the 4 GB limit of RIFF.
+class StreamRecorder: public SampleSink
+{
+	public:
+		StreamRecorder(): maxFileBytes(0), maxFileSeconds(0), samplingRate(0), blockMemory(0), headerBlock(0),
+			nBlocks(16), fillIndex(0), writeIndex(0), blockFill(0), droppedFrames(0), writtenBytes(0), failed(false),
+			thread(0), quit(false), fd(-1)
+		{
+			dataAvailable= SDL_CreateSemaphore(0);
+		}
+
+		~StreamRecorder()
+		{
+			stop();
+			SDL_DestroySemaphore(dataAvailable);
+		}
+
+		// inputs to record, in file channel order. inputs which don't exist are recorded as silence.
+		void setChannels(const vector<unsigned> &c)
+		{ channels= c; }
+
+		// start a new file after this many bytes or seconds of samples, 0 for no limit
+		void setRotation(uint64_t bytes, double seconds)
+		{ maxFileBytes= bytes; maxFileSeconds= seconds; }
+
+		// files are named DIRECTORY/fluxscope-DATE-TIME-NNNN.wav
+		void setDirectory(const char *dir)
+		{ directory= dir; }
+
+		// allocate the blocks and start the writer. without a channel selection all inputs are recorded.
+		bool start(double rate, unsigned nInputs)
+		{
+			stop();
+			if(channels.empty())
+				for(unsigned i= 0; i<nInputs; i++) channels.push_back(i);
+			if(channels.empty()) return false;
+			samplingRate= rate;
+			frameBytes= channels.size()*sizeof(float);
+			// whole pages for every 1024 frames, so all writes except the very last one stay aligned
+			blockFrames= 1024*max(1u, unsigned(256/channels.size()));
+			blockBytes= blockFrames*frameBytes;
+			framesPerFile= 0;
+			if(maxFileBytes) framesPerFile= maxFileBytes/frameBytes;
+			if(maxFileSeconds>0 && (!framesPerFile || maxFileSeconds*rate<framesPerFile)) framesPerFile= uint64_t(maxFileSeconds*rate);
+			if(framesPerFile) framesPerFile= max(uint64_t(1024), framesPerFile & ~uint64_t(1023));
+
+			void *mem;
+			if(posix_memalign(&mem, ALIGNMENT, nBlocks*blockBytes + ALIGNMENT))
+			{
+				fprintf(stderr, "couldn't allocate the recording buffers\n");
+				return false;
+			}
+			// touch the pages now, so the feeding thread doesn't fault them in
+			memset(mem, 0, nBlocks*blockBytes + ALIGNMENT);
+			headerBlock= (uint8_t*)mem;
+			blockMemory= (float*)(headerBlock+ALIGNMENT);
+			blockFrameCounts.assign(nBlocks, 0);
+
+			time_t now= ::time(0);
+			char stamp[32];
+			strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+			fileStamp= stamp;
+			fileIndex= 0;
+			fillIndex= writeIndex= blockFill= 0;
+			droppedFrames= 0;
+			writtenBytes= 0;
+			failed= false;
+			quit= false;
+			thread= SDL_CreateThread(threadFunc, this);
+			return true;
+		}
+
+		// finish the current file. the feeding thread must not call write() any more.
+		void stop()
+		{
+			if(!thread) return;
+			if(blockFill) commitBlock();
+			__atomic_store_n(&quit, true, __ATOMIC_RELEASE);
+			SDL_SemPost(dataAvailable);
+			SDL_WaitThread(thread, 0);
+			thread= 0;
+			free(headerBlock);
+			headerBlock= 0;
+			blockMemory= 0;
+		}
+
+		bool isRecording()
+		{ return thread; }
+
+		// producer side
+		void write(jack_default_audio_sample_t * const *inputs, unsigned nInputs, uint32_t nFrames)
+		{
+			unsigned nChannels= channels.size();
+			uint32_t done= 0;
+			while(done<nFrames)
+			{
+				if(fillIndex-__atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE)>=nBlocks)
+				{
+					__atomic_store_n(&droppedFrames, droppedFrames+(nFrames-done), __ATOMIC_RELAXED);
+					return;
+				}
+				uint32_t n= min(nFrames-done, blockFrames-blockFill);
+				float *dest= getBlock(fillIndex%nBlocks) + size_t(blockFill)*nChannels;
+				for(unsigned c= 0; c<nChannels; c++)
+				{
+					if(channels[c]<nInputs)
+					{
+						const jack_default_audio_sample_t *src= inputs[channels[c]]+done;
+						for(uint32_t i= 0; i<n; i++)
+							dest[i*nChannels+c]= src[i];
+					}
+					else for(uint32_t i= 0; i<n; i++)
+						dest[i*nChannels+c]= 0;
+				}
+				blockFill+= n;
+				done+= n;
+				if(blockFill==blockFrames) commitBlock();
+			}
+		}
+
+		uint32_t getDroppedFrames()
+		{ return __atomic_load_n(&droppedFrames, __ATOMIC_RELAXED); }
+
+		uint64_t getWrittenBytes()
+		{ return __atomic_load_n(&writtenBytes, __ATOMIC_RELAXED); }
+
+		// a file couldn't be created or written, the recording has stopped
+		bool hasFailed()
+		{ return __atomic_load_n(&failed, __ATOMIC_ACQUIRE); }
+
+	private:
+		enum { ALIGNMENT= 4096 };   // O_DIRECT alignment. the WAV header takes one such page, so the samples start aligned.
+
+		vector<unsigned> channels;
+		uint64_t maxFileBytes;
+		double maxFileSeconds;
+		string directory, fileStamp;
+		double samplingRate;
+		uint32_t frameBytes, blockFrames, blockBytes;
+		uint64_t framesPerFile;
+		float *blockMemory;
+		uint8_t *headerBlock;
+		vector<uint32_t> blockFrameCounts;
+		uint32_t nBlocks;
+		uint32_t fillIndex;         // written by the producer...
+		uint32_t writeIndex;        // ...and by the writer thread
+		uint32_t blockFill;
+		uint32_t droppedFrames;
+		uint64_t writtenBytes;
+		bool failed;
+		SDL_sem *dataAvailable;
+		SDL_Thread *thread;
+		bool quit;
+		// writer thread state
+		int fd;
+		unsigned fileIndex;
+		uint64_t fileFrames;
+		bool direct;
+
+		float *getBlock(uint32_t index)
+		{ return (float*)((uint8_t*)blockMemory + size_t(index)*blockBytes); }
+
+		void commitBlock()
+		{
+			blockFrameCounts[fillIndex%nBlocks]= blockFill;
+			blockFill= 0;
+			__atomic_store_n(&fillIndex, fillIndex+1, __ATOMIC_RELEASE);
+			if(!SDL_SemValue(dataAvailable)) SDL_SemPost(dataAvailable);
+		}
+
+		static int threadFunc(void *arg)
+		{
+			reinterpret_cast<StreamRecorder*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			for(;;)
+			{
+				// blocks committed before the quit flag was set are still written
+				bool stopping= __atomic_load_n(&quit, __ATOMIC_ACQUIRE);
+				while(writeIndex!=__atomic_load_n(&fillIndex, __ATOMIC_ACQUIRE))
+				{
+					uint32_t b= writeIndex%nBlocks;
+					if(!hasFailed()) writeBlock(getBlock(b), blockFrameCounts[b]);
+					__atomic_store_n(&writeIndex, writeIndex+1, __ATOMIC_RELEASE);
+				}
+				if(stopping) break;
+				SDL_SemWaitTimeout(dataAvailable, 100);
+			}
+			closeFile();
+		}
+
+		void writeBlock(const float *data, uint32_t nFrames)
+		{
+			while(nFrames)
+			{
+				if(fd<0 && !openFile()) return fail();
+				uint32_t n= nFrames;
+				if(framesPerFile) n= uint32_t(min(uint64_t(n), framesPerFile-fileFrames));
+				if(!writeData(data, size_t(n)*frameBytes, ALIGNMENT+fileFrames*frameBytes)) return fail();
+				fileFrames+= n;
+				data+= size_t(n)*channels.size();
+				nFrames-= n;
+				__atomic_store_n(&writtenBytes, writtenBytes+size_t(n)*frameBytes, __ATOMIC_RELAXED);
+				if(framesPerFile && fileFrames>=framesPerFile) closeFile();
+			}
+		}
+
+		void fail()
+		{
+			fprintf(stderr, "recording failed: %s\n", strerror(errno));
+			closeFile();
+			__atomic_store_n(&failed, true, __ATOMIC_RELEASE);
+		}
+
+		// write whole pages directly. an unaligned rest can only come at the end of the recording and
+		// goes through the page cache.
+		bool writeData(const void *data, size_t size, uint64_t offset)
+		{
+			size_t aligned= (direct? size & ~size_t(ALIGNMENT-1): 0);
+			if(!writeAll(data, aligned, offset)) return false;
+			if(aligned<size)
+			{
+				setDirect(false);
+				return writeAll((const uint8_t*)data+aligned, size-aligned, offset+aligned);
+			}
+			return true;
+		}
+
+		bool writeAll(const void *data, size_t size, uint64_t offset)
+		{
+			while(size)
+			{
+				ssize_t n= pwrite(fd, data, size, offset);
+				if(n<0 && errno==EINTR) continue;
+				if(n<=0) return false;
+				data= (const uint8_t*)data+n;
+				size-= n;
+				offset+= n;
+			}
+			return true;
+		}
+
+		void setDirect(bool enable)
+		{
+			if(direct==enable) return;
+			int flags= fcntl(fd, F_GETFL);
+			if(flags!=-1 && fcntl(fd, F_SETFL, enable? flags|O_DIRECT: flags&~O_DIRECT)!=-1)
+				direct= enable;
+		}
+
+		bool openFile()
+		{
+			char filename[1024];
+			snprintf(filename, sizeof(filename), "%s/fluxscope-%s-%04u.wav", directory.c_str(), fileStamp.c_str(), fileIndex++);
+			// not every file system supports O_DIRECT
+			direct= true;
+			fd= open(filename, O_WRONLY|O_CREAT|O_TRUNC|O_DIRECT, 0644);
+			if(fd<0 && errno==EINVAL)
+				direct= false, fd= open(filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+			if(fd<0) return false;
+			fileFrames= 0;
+			makeHeader(0);
+			return writeAll(headerBlock, ALIGNMENT, 0);
+		}
+
+		// complete the header with the final sizes and close
+		void closeFile()
+		{
+			if(fd<0) return;
+			setDirect(false);
+			makeHeader(fileFrames*frameBytes);
+			writeAll(headerBlock, ALIGNMENT, 0);
+			close(fd);
+			fd= -1;
+		}
+
+		static void put16(uint8_t *p, uint32_t v)
+		{ p[0]= v; p[1]= v>>8; }
+
+		static void put32(uint8_t *p, uint32_t v)
+		{ put16(p, v); put16(p+2, v>>16); }
+
+		static void put64(uint8_t *p, uint64_t v)
+		{ put32(p, v); put32(p+4, v>>32); }
+
+		// a float WAV header padded to one page. the JUNK chunk after WAVE is reserved for the ds64 chunk
+		// of RF64, as in EBU Tech 3306.
+		void makeHeader(uint64_t dataBytes)
+		{
+			uint8_t *h= headerBlock;
+			bool rf64= (dataBytes > 0xFFFFFFFFull-(ALIGNMENT-8));
+			memset(h, 0, ALIGNMENT);
+			memcpy(h, rf64? "RF64": "RIFF", 4);
+			put32(h+4, rf64? 0xFFFFFFFF: uint32_t(ALIGNMENT-8+dataBytes));
+			memcpy(h+8, "WAVE", 4);
+			memcpy(h+12, rf64? "ds64": "JUNK", 4);
+			put32(h+16, 28);
+			if(rf64)
+			{
+				put64(h+20, ALIGNMENT-8+dataBytes);
+				put64(h+28, dataBytes);
+				put64(h+36, dataBytes/frameBytes);
+			}
+			memcpy(h+48, "fmt ", 4);
+			put32(h+52, 18);
+			put16(h+56, 3);     // WAVE_FORMAT_IEEE_FLOAT
+			put16(h+58, channels.size());
+			put32(h+60, uint32_t(samplingRate));
+			put32(h+64, uint32_t(samplingRate)*frameBytes);
+			put16(h+68, frameBytes);
+			put16(h+70, 32);
+			memcpy(h+74, "JUNK", 4);
+			put32(h+78, ALIGNMENT-8-82);
+			memcpy(h+ALIGNMENT-8, "data", 4);
+			put32(h+ALIGNMENT-4, rf64? 0xFFFFFFFF: uint32_t(dataBytes));
+		}
+};
+
+// long-term history of all inputs on disk, in segment files of a fixed number of frames. a segment holds
+// the samples of each channel one after the other, followed by two overview levels of min/max/rms entries
+// for every 256 and 65536 frames. the processing thread feeds it like the recorder and a writer thread
+// writes the segments. reading back a time span maps only the part of the segment files it needs, from
+// the overview level matching the resolution, so hours of history can be browsed with constant memory use.
+class HistoryStore: public SampleSink
+{
+	public:
+		typedef DecimationPyramid::Entry Entry;
+		enum { LEVEL1= 256, LEVEL2= 65536 };    // frames per overview entry
+
+		HistoryStore(): maxLength(0), maxSegments(0), nChannels(0), samplingRate(0), blockMemory(0), fillIndex(0), writeIndex(0),
+			blockFill(0), firstFrame(0), writtenFrames(0), droppedFrames(0), failed(false), thread(0), quit(false), fd(-1)
+		{
+			dataAvailable= SDL_CreateSemaphore(0);
+		}
+
+		~HistoryStore()
+		{
+			stop();
+			SDL_DestroySemaphore(dataAvailable);
+		}
+
+		// segment files are named DIRECTORY/history-NNNNNNNN.seg
+		void setDirectory(const char *dir)
+		{ directory= dir; }
+
+		// keep at most this many seconds, deleting the oldest segments. 0 for no limit.
+		void setMaxLength(double seconds)
+		{ maxLength= seconds; }
+
+		bool start(double rate, unsigned channels)
+		{
+			stop();
+			if(!channels) return false;
+			nChannels= channels;
+			samplingRate= rate;
+			// segments of up to 64 MB, at least one level 2 entry long
+			segmentFrames= LEVEL2;
+			while(segmentFrames<(1u<<22) && uint64_t(segmentFrames)*2*nChannels*sizeof(float)<=(64u<<20)) segmentFrames<<= 1;
+			maxSegments= (maxLength>0? max(uint64_t(2), uint64_t(ceil(maxLength*rate/segmentFrames))+1): 0);
+			// about a second of buffering
+			nBlocks= max(4u, min(16u, unsigned(rate/blockFrames)));
+			blockBytes= size_t(blockFrames)*nChannels*sizeof(float);
+			blockMemory= (float*)malloc(nBlocks*blockBytes);
+			if(!blockMemory) return false;
+			memset(blockMemory, 0, nBlocks*blockBytes);
+			blockFrameCounts.assign(nBlocks, 0);
+			level2Entries.resize(nChannels);
+			fillIndex= writeIndex= blockFill= 0;
+			firstFrame= writtenFrames= 0;
+			segmentIndex= 0;
+			segmentFill= 0;
+			droppedFrames= 0;
+			failed= false;
+			quit= false;
+			thread= SDL_CreateThread(threadFunc, this);
+			return true;
+		}
+
+		// the feeding thread must not call write() any more
+		void stop()
+		{
+			if(!thread) return;
+			if(blockFill) commitBlock();
+			__atomic_store_n(&quit, true, __ATOMIC_RELEASE);
+			SDL_SemPost(dataAvailable);
+			SDL_WaitThread(thread, 0);
+			thread= 0;
+			free(blockMemory);
+			blockMemory= 0;
+		}
+
+		bool isRunning()
+		{ return thread; }
+
+		unsigned getNumChannels()
+		{ return nChannels; }
+
+		double getSamplingRate()
+		{ return samplingRate; }
+
+		// range of frames which can be read, counted from the start
+		uint64_t getFirstFrame()
+		{ return __atomic_load_n(&firstFrame, __ATOMIC_ACQUIRE); }
+
+		uint64_t getEndFrame()
+		{ return __atomic_load_n(&writtenFrames, __ATOMIC_ACQUIRE); }
+
+		uint32_t getDroppedFrames()
+		{ return __atomic_load_n(&droppedFrames, __ATOMIC_RELAXED); }
+
+		// producer side. inputs beyond the channel count given to start() are ignored, missing ones are silent.
+		void write(jack_default_audio_sample_t * const *inputs, unsigned nInputs, uint32_t nFrames)
+		{
+			uint32_t done= 0;
+			while(done<nFrames)
+			{
+				if(fillIndex-__atomic_load_n(&writeIndex, __ATOMIC_ACQUIRE)>=nBlocks)
+				{
+					__atomic_store_n(&droppedFrames, droppedFrames+(nFrames-done), __ATOMIC_RELAXED);
+					return;
+				}
+				uint32_t n= min(nFrames-done, blockFrames-blockFill);
+				float *block= getBlock(fillIndex%nBlocks);
+				for(unsigned c= 0; c<nChannels; c++)
+				{
+					if(c<nInputs) memcpy(block+size_t(c)*blockFrames+blockFill, inputs[c]+done, n*sizeof(float));
+					else memset(block+size_t(c)*blockFrames+blockFill, 0, n*sizeof(float));
+				}
+				blockFill+= n;
+				done+= n;
+				if(blockFill==blockFrames) commitBlock();
+			}
+		}
+
+		// reader side, thread safe. summarize the frames [start+i*framesPerColumn, start+(i+1)*framesPerColumn)
+		// of each channel for nColumns columns, into out[channel*nColumns+column]. columns outside of the
+		// stored frames get entries with a count of 0. the column boundaries are rounded to the overview
+		// entries used, so they are exact only when a column is narrower than 256 frames.
+		void readColumns(double start, double framesPerColumn, uint32_t nColumns, vector<Entry> &out)
+		{
+			Entry empty= { 0, 0, 0, 0 };
+			out.assign(size_t(nColumns)*nChannels, empty);
+			uint64_t first= getFirstFrame(), end= getEndFrame();
+			if(!nColumns || framesPerColumn<=0 || end<=first) return;
+			uint32_t unit= (framesPerColumn>=LEVEL2? LEVEL2: framesPerColumn>=LEVEL1? LEVEL1: 1);
+			uint64_t viewBegin= max(first, columnStart(start, framesPerColumn, 0));
+			uint64_t viewEnd= min(end, max(columnStart(start, framesPerColumn, nColumns), viewBegin+1));
+			for(uint64_t segment= viewBegin/segmentFrames; segment*segmentFrames<viewEnd; segment++)
+				readSegment(segment, max(viewBegin, segment*segmentFrames), min(viewEnd, (segment+1)*segmentFrames),
+							unit, start, framesPerColumn, nColumns, out);
+		}
+
+	private:
+		enum { blockFrames= 8192, HEADERSIZE= 4096 };
+
+		string directory;
+		double maxLength;
+		uint64_t maxSegments;
+		unsigned nChannels;
+		double samplingRate;
+		uint32_t segmentFrames;
+		// block ring from the producer to the writer, one channel after the other in each block
+		float *blockMemory;
+		size_t blockBytes;
+		uint32_t nBlocks;
+		vector<uint32_t> blockFrameCounts;
+		uint32_t fillIndex;         // written by the producer...
+		uint32_t writeIndex;        // ...and by the writer thread
+		uint32_t blockFill;
+		uint64_t firstFrame, writtenFrames;
+		uint32_t droppedFrames;
+		bool failed;
+		SDL_sem *dataAvailable;
+		SDL_Thread *thread;
+		bool quit;
+		// writer thread state
+		int fd;
+		uint64_t segmentIndex;
+		uint32_t segmentFill;
+		vector<Entry> level2Entries;    // level 2 entries of the current segment, while they are filled
+		vector<Entry> level1Entries;
+
+		float *getBlock(uint32_t index)
+		{ return (float*)((uint8_t*)blockMemory + size_t(index)*blockBytes); }
+
+		static uint64_t columnStart(double start, double framesPerColumn, uint32_t column)
+		{
+			double f= start+column*framesPerColumn;
+			return f>0? uint64_t(f): 0;
+		}
+
+		// layout of a segment file
+		uint64_t dataOffset(unsigned channel)
+		{ return HEADERSIZE + uint64_t(channel)*segmentFrames*sizeof(float); }
+
+		uint64_t level1Offset(unsigned channel)
+		{ return dataOffset(nChannels) + uint64_t(channel)*(segmentFrames/LEVEL1)*sizeof(Entry); }
+
+		uint64_t level2Offset(unsigned channel)
+		{ return level1Offset(nChannels) + uint64_t(channel)*(segmentFrames/LEVEL2)*sizeof(Entry); }
+
+		string getSegmentName(uint64_t index)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "/history-%08llu.seg", (unsigned long long)index);
+			return directory+name;
+		}
+
+		void commitBlock()
+		{
+			blockFrameCounts[fillIndex%nBlocks]= blockFill;
+			blockFill= 0;
+			__atomic_store_n(&fillIndex, fillIndex+1, __ATOMIC_RELEASE);
+			if(!SDL_SemValue(dataAvailable)) SDL_SemPost(dataAvailable);
+		}
+
+		static int threadFunc(void *arg)
+		{
+			reinterpret_cast<HistoryStore*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+			for(;;)
+			{
+				bool stopping= __atomic_load_n(&quit, __ATOMIC_ACQUIRE);
+				while(writeIndex!=__atomic_load_n(&fillIndex, __ATOMIC_ACQUIRE))
+				{
+					uint32_t b= writeIndex%nBlocks;
+					if(!__atomic_load_n(&failed, __ATOMIC_ACQUIRE)) writeBlock(getBlock(b), blockFrameCounts[b]);
+					__atomic_store_n(&writeIndex, writeIndex+1, __ATOMIC_RELEASE);
+				}
+				if(stopping) break;
+				SDL_SemWaitTimeout(dataAvailable, 100);
+			}
+			closeSegment();
+		}
+
+		static Entry summarize(const float *samples, uint32_t n)
+		{
+			Entry e= { samples[0], samples[0], 0, n };
+			for(uint32_t i= 0; i<n; i++)
+			{
+				float v= samples[i];
+				if(v<e.min) e.min= v;
+				if(v>e.max) e.max= v;
+				e.sumSquares+= v*v;
+			}
+			return e;
+		}
+
+		// blocks are appended to segments whole, as they are a fraction of a level 2 entry. only the last
+		// block of the history may be shorter.
+		void writeBlock(const float *block, uint32_t nFrames)
+		{
+			if(fd<0 && !openSegment()) return fail();
+			uint32_t nLevel1= (nFrames+LEVEL1-1)/LEVEL1;
+			level1Entries.resize(nLevel1);
+			for(unsigned c= 0; c<nChannels; c++)
+			{
+				const float *samples= block+size_t(c)*blockFrames;
+				if(!writeAll(samples, nFrames*sizeof(float), dataOffset(c)+uint64_t(segmentFill)*sizeof(float)))
+					return fail();
+				for(uint32_t i= 0; i<nLevel1; i++)
+				{
+					level1Entries[i]= summarize(samples+i*LEVEL1, min(uint32_t(LEVEL1), nFrames-i*LEVEL1));
+					if(segmentFill%LEVEL2 || i) level2Entries[c].merge(level1Entries[i]);
+					else level2Entries[c]= level1Entries[i];
+				}
+				if(!writeAll(&level1Entries[0], nLevel1*sizeof(Entry), level1Offset(c)+(segmentFill/LEVEL1)*sizeof(Entry)) ||
+				   !writeAll(&level2Entries[c], sizeof(Entry), level2Offset(c)+(segmentFill/LEVEL2)*sizeof(Entry)))
+					return fail();
+			}
+			segmentFill+= nFrames;
+			__atomic_store_n(&writtenFrames, writtenFrames+nFrames, __ATOMIC_RELEASE);
+			if(segmentFill>=segmentFrames) closeSegment();
+		}
+
+		bool writeAll(const void *data, size_t size, uint64_t offset)
+		{
+			while(size)
+			{
+				ssize_t n= pwrite(fd, data, size, offset);
+				if(n<0 && errno==EINTR) continue;
+				if(n<=0) return false;
+				data= (const uint8_t*)data+n;
+				size-= n;
+				offset+= n;
+			}
+			return true;
+		}
+
+		void fail()
+		{
+			fprintf(stderr, "writing the history failed: %s\n", strerror(errno));
+			closeSegment();
+			__atomic_store_n(&failed, true, __ATOMIC_RELEASE);
+		}
+
+		// the header describes the segment, so the files can be told apart and inspected
+		void writeHeader()
+		{
+			uint8_t header[64];
+			memset(header, 0, sizeof(header));
+			memcpy(header, "FLUXHIST", 8);
+			uint32_t u32[]= { 1, nChannels, segmentFrames, segmentFill };
+			memcpy(header+8, u32, sizeof(u32));
+			uint64_t start= segmentIndex*segmentFrames;
+			memcpy(header+24, &start, 8);
+			memcpy(header+32, &samplingRate, 8);
+			writeAll(header, sizeof(header), 0);
+		}
+
+		bool openSegment()
+		{
+			if(maxSegments && segmentIndex>=maxSegments)
+			{
+				// readers check the first frame before they open a segment
+				__atomic_store_n(&firstFrame, (segmentIndex-maxSegments+1)*segmentFrames, __ATOMIC_RELEASE);
+				unlink(getSegmentName(segmentIndex-maxSegments).c_str());
+			}
+			fd= open(getSegmentName(segmentIndex).c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+			if(fd<0) return false;
+			// the full size up front, so readers can map any part of it
+			if(ftruncate(fd, level2Offset(nChannels)))
+			{
+				close(fd);
+				fd= -1;
+				return false;
+			}
+			segmentFill= 0;
+			writeHeader();
+			return true;
+		}
+
+		void closeSegment()
+		{
+			if(fd<0) return;
+			writeHeader();
+			close(fd);
+			fd= -1;
+			if(segmentFill>=segmentFrames) segmentIndex++, segmentFill= 0;
+		}
+
+		// map the part of an array in a segment file which covers the elements [first, last)
+		static const void *mapRange(int fd, uint64_t offset, size_t elementSize, uint64_t first, uint64_t last,
+									void *&mapping, size_t &mappingSize)
+		{
+			static const uint64_t pageSize= sysconf(_SC_PAGESIZE);
+			uint64_t begin= offset+first*elementSize, end= offset+last*elementSize;
+			uint64_t mapBegin= begin & ~(pageSize-1);
+			mappingSize= end-mapBegin;
+			mapping= mmap(0, mappingSize, PROT_READ, MAP_SHARED, fd, mapBegin);
+			if(mapping==MAP_FAILED) return (mapping= 0);
+			return (const uint8_t*)mapping + (begin-mapBegin);
+		}
+
+		uint32_t getColumn(uint64_t frame, double start, double framesPerColumn, uint32_t nColumns)
+		{
+			double column= floor((frame-start)/framesPerColumn);
+			return column<0? 0: column>=nColumns? nColumns-1: uint32_t(column);
+		}
+
+		// merge the frames [viewBegin, viewEnd) of a segment into the columns overlapping them
+		void readSegment(uint64_t segment, uint64_t viewBegin, uint64_t viewEnd, uint32_t unit, double start,
+						 double framesPerColumn, uint32_t nColumns, vector<Entry> &out)
+		{
+			uint64_t segmentBegin= segment*segmentFrames;
+			uint32_t firstColumn= getColumn(viewBegin, start, framesPerColumn, nColumns),
+					 lastColumn= getColumn(viewEnd, start, framesPerColumn, nColumns);
+			int segmentFd= open(getSegmentName(segment).c_str(), O_RDONLY);
+			if(segmentFd<0) return;
+			// in units of the level, relative to the segment
+			uint64_t firstUnit= (viewBegin-segmentBegin)/unit, lastUnit= (viewEnd-segmentBegin+unit-1)/unit;
+			for(unsigned c= 0; c<nChannels; c++)
+			{
+				void *mapping;
+				size_t mappingSize;
+				uint64_t offset= (unit==1? dataOffset(c): unit==LEVEL1? level1Offset(c): level2Offset(c));
+				const void *data= mapRange(segmentFd, offset, unit==1? sizeof(float): sizeof(Entry), firstUnit, lastUnit,
+										   mapping, mappingSize);
+				if(!data) continue;
+				for(uint32_t column= firstColumn; column<=lastColumn; column++)
+				{
+					uint64_t begin= max(viewBegin, columnStart(start, framesPerColumn, column));
+					uint64_t end= min(viewEnd, max(columnStart(start, framesPerColumn, column+1), begin+1));
+					if(begin>=end) continue;
+					uint64_t u0= (begin-segmentBegin)/unit-firstUnit, u1= (end-segmentBegin+unit-1)/unit-firstUnit;
+					if(u1<=u0) u1= u0+1;
+					Entry e;
+					if(unit==1)
+						e= summarize((const float*)data+u0, uint32_t(u1-u0));
+					else
+					{
+						const Entry *entries= (const Entry*)data;
+						e= entries[u0];
+						for(uint64_t u= u0+1; u<u1; u++) e.merge(entries[u]);
+					}
+					Entry &dest= out[size_t(c)*nColumns+column];
+					if(dest.count) dest.merge(e);
+					else dest= e;
+				}
+				munmap(mapping, mappingSize);
+			}
+			close(segmentFd);
+		}
+};
+
+// decides when the render loop redraws. the loop sleeps until a new display frame is ready, GUI input has
+// come in or the poll timeout has passed, and only redraws when the display data or the widgets have changed,
+// at most at the maximum frame rate. also keeps statistics of the render time and of the ingest latency,
+// the time from jack handing over the samples to the frame showing them being swapped to the screen.
+class RenderScheduler
+{
+	public:
+		struct Stats
+		{
+			uint32_t frames;            // redraws
+			uint32_t dataFrames;        // redraws which showed new samples
+			double renderTime, maxRenderTime;
+			double latency, maxLatency;
+			double interval;            // time covered
+
+			Stats()
+			{ clear(); }
+
+			void clear()
+			{ frames= dataFrames= 0; renderTime= maxRenderTime= latency= maxLatency= interval= 0; }
+		};
+
+		RenderScheduler(double maxFrameRate= 100): frameReady(false), guiDirty(true), lastRenderTime(0),
+			frameStart(0), lastSerial(0), statsStart(getTime())
+		{
+			mutex= SDL_CreateMutex();
+			cond= SDL_CreateCond();
+			setMaxFrameRate(maxFrameRate);
+		}
+
+		~RenderScheduler()
+		{
+			SDL_DestroyCond(cond);
+			SDL_DestroyMutex(mutex);
+		}
+
+		void setMaxFrameRate(double rate)
+		{ minFrameInterval= (rate>0? 1.0/rate: 0); }
+
+		// called by the processing thread when it has published a display frame
+		void notifyFrame()
+		{
+			SDLScopedLock lock(mutex);
+			frameReady= true;
+			SDL_CondSignal(cond);
+		}
+
+		// GUI input was handled, the widgets have to be redrawn
+		void markGuiDirty()
+		{ guiDirty= true; }
+
+		// sleep until there is something to redraw or the timeout has passed. SDL 1.2 can't wait for
+		// input events and a condition at the same time, so the timeout is the input poll interval.
+		void wait(double timeout)
+		{
+			SDL_LockMutex(mutex);
+			if(!frameReady && !guiDirty)
+				SDL_CondWaitTimeout(cond, mutex, Uint32(timeout*1000));
+			bool dirty= frameReady || guiDirty;
+			SDL_UnlockMutex(mutex);
+			// a redraw which is due too early waits for its frame slot
+			double delay= lastRenderTime+minFrameInterval-getTime();
+			if(dirty && delay>0)
+				SDL_Delay(Uint32(ceil(min(delay, timeout)*1000)));
+		}
+
+		// returns true if a frame should be drawn now
+		bool beginFrame()
+		{
+			double now= getTime();
+			SDLScopedLock lock(mutex);
+			if((!frameReady && !guiDirty) || now<lastRenderTime+minFrameInterval) return false;
+			frameReady= guiDirty= false;
+			frameStart= lastRenderTime= now;
+			return true;
+		}
+
+		// the frame has been swapped to the screen
+		void endFrame(const DisplayFrame &frame)
+		{
+			double now= getTime(), renderTime= now-frameStart;
+			stats.frames++;
+			stats.renderTime+= renderTime;
+			stats.maxRenderTime= max(stats.maxRenderTime, renderTime);
+			if(frame.serial!=lastSerial && frame.ingestTime>0)
+			{
+				double latency= now-frame.ingestTime;
+				lastSerial= frame.serial;
+				stats.dataFrames++;
+				stats.latency+= latency;
+				stats.maxLatency= max(stats.maxLatency, latency);
+			}
+		}
+
+		// statistics since the last call
+		Stats takeStats()
+		{
+			double now= getTime();
+			Stats s= stats;
+			s.interval= now-statsStart;
+			stats.clear();
+			statsStart= now;
+			return s;
+		}
+
+		static void printStats(const Stats &s)
+		{
+			printf("%5.1f fps, render %.2f/%.2f ms, ingest latency %.2f/%.2f ms (avg/max)\n",
+				   s.interval>0? s.frames/s.interval: 0,
+				   s.frames? s.renderTime/s.frames*1000: 0, s.maxRenderTime*1000,
+				   s.dataFrames? s.latency/s.dataFrames*1000: 0, s.maxLatency*1000);
+		}
+
+	private:
+		SDL_mutex *mutex;
+		SDL_cond *cond;
+		bool frameReady;
+		bool guiDirty;
+		double minFrameInterval;
+		double lastRenderTime, frameStart;
+		uint32_t lastSerial;
+		Stats stats;
+		double statsStart;
+};
+
+// acquisition/processing side of the oscilloscope. runs on its own thread: drains the sample ring buffer,
+// does triggering and peak filtering, and builds the display frames which are handed over to the render
+// loop through a triple buffer. this way, a slow frame on the GUI thread never stalls the sample ingest.
+// display columns are cached and only the ones covering newly written samples are recomputed.
+class ScopeProcessor
+{
+	public:
+		ScopeProcessor(): history(0), historySize(0), nChannels(0), viewSize(0), writePos(0), viewStart(0), prevViewStart(0),
+			triggerStreamPos(0), sweepFraction(0), prevSweepFraction(0), sweepComplete(false), lineDisplayPeaks(false), triggerWaitSamples(0),
+			triggerStatus(DisplayFrame::TS_WAITING), singleShotDone(false), ringBuffer(0), settingsChanged(true),
+			frameSerial(0), takenSerial(0), renderChangesSince(0), ingestTime(0), ringFramesRead(0), ringClockOffset(0),
+			ringClockTime(0), ringClockRate(0), inputWaiters(0),
+			publishedStatus(DisplayFrame::TS_WAITING), publishedFillColumn(0), scheduler(0), captureQueue(0),
+			collectStats(false), sweepCount(0), spectrumSerial(0), spectrumRows(64), phosphorSerial(0), phosphorChanged(false),
+			phosphorPublishPos(0), phosphorPublishTime(0), xyPoints(2, XYPOINTS), correlation(0), measuredSamples(0),
+			measurementSerial(0), mask(0), maskFailureQueue(0), segmentSequence(0), segmentsPublished(0), thread(0), quit(false)
+		{
+			settingsMutex= SDL_CreateMutex();
+			inputMutex= SDL_CreateMutex();
+			statsMutex= SDL_CreateMutex();
+			segmentMutex= SDL_CreateMutex();
+			spectrum.setRowQueue(&spectrumRows);
+			applySettings();
+		}
+
+		~ScopeProcessor()
+		{
+			stop();
+			SDL_DestroyMutex(settingsMutex);
+			SDL_DestroyMutex(inputMutex);
+			SDL_DestroyMutex(statsMutex);
+			SDL_DestroyMutex(segmentMutex);
+		}
+
+		void start()
+		{
+			if(thread) return;
+			quit= false;
+			thread= SDL_CreateThread(threadFunc, this);
+		}
+
+		void stop()
+		{
+			if(!thread) return;
+			__atomic_store_n(&quit, true, __ATOMIC_RELEASE);
+			wakeThread();
+			SDL_WaitThread(thread, 0);
+			thread= 0;
+		}
+
+		// set the ring buffer to read from. blocks until the processing thread has stopped using the old one,
+		// so call this with NULL before the ring buffer is destroyed.
+		void setRingBuffer(SampleRingBuffer *rb)
+		{
+			InputLock lock(*this);
+			ringBuffer= rb;
+			ringFramesRead= 0;
+			ringClockTime= 0;
+		}
+
+		// called from the GUI thread. the new settings are applied before the next block is processed.
+		void setSettings(const ScopeSettings &s)
+		{
+			{
+				SDLScopedLock lock(settingsMutex);
+				pendingSettings= s;
+				settingsChanged= true;
+			}
+			wakeThread();
+		}
+
+		// one iteration of the processing loop: apply new settings, drain the ring buffer and publish a
+		// display frame if anything has changed. the processing thread calls this continuously; it can
+		// also be called directly when the thread isn't running. returns true if samples were processed.
+		bool processPending()
+		{
+			SDLScopedLock lock(inputMutex);
+			bool newSettings= applySettings();
+			bool haveData= (ringBuffer && addBuffers(*ringBuffer));
+			// samples which don't change the display, like those coming in while waiting for a trigger,
+			// don't produce a new frame, so the render loop can stay idle
+			if(newSettings || !dirtyColumns.empty() || triggerStatus!=publishedStatus || getFillColumn()!=publishedFillColumn)
+			{
+				for(int i= 0; i<dirtyColumns.size(); i++)
+					refreshColumns(dirtyColumns[i].begin, dirtyColumns[i].end);
+				for(int i= 0; i<3; i++)
+					frameDirtyColumns[i].add(dirtyColumns);
+				publishDisplayFrame();
+				dirtyColumns.clear();
+				if(scheduler) scheduler->notifyFrame();
+			}
+			if(settings.spectrum.enabled && (spectrum.takeNewSpectrum() || newSettings))
+			{
+				publishSpectrumFrame();
+				if(scheduler) scheduler->notifyFrame();
+			}
+			// the persistence display is published at most at the display rate, it fades with the
+			// stream time even while no sweeps come in
+			if(settings.phosphor.enabled && (phosphorChanged || newSettings ||
+			   (settings.phosphor.persistence>0 && writePos!=phosphorPublishPos)) && getTime()-phosphorPublishTime>=1/60.0)
+			{
+				publishPhosphorFrame();
+				if(scheduler) scheduler->notifyFrame();
+			}
+			return haveData;
+		}
+
+		// the scheduler is woken up whenever a new display frame is ready
+		void setScheduler(class RenderScheduler *s)
+		{ scheduler= s; }
+
+		// each completed sweep is copied to the queue. set this before starting the processing thread.
+		void setCaptureQueue(CaptureQueue *q)
+		{ captureQueue= q; }
+
+		// the limits for the mask test, which runs on each completed sweep while it is enabled in the
+		// settings. the sweeps which fail it are copied to the failure queue, if there is one. set both
+		// before starting the processing thread; the mask must stay valid while the processor uses it.
+		void setMask(const Mask *m)
+		{
+			{
+				SDLScopedLock lock(settingsMutex);
+				mask= m;
+				settingsChanged= true;
+			}
+			wakeThread();
+		}
+
+		void setMaskFailureQueue(CaptureQueue *q)
+		{ maskFailureQueue= q; }
+
+		const Mask *getMask()
+		{ return mask; }
+
+		// pass the incoming samples on to a recorder or the like. removing a sink blocks until the
+		// processing thread has stopped using it, like setRingBuffer().
+		void addSampleSink(SampleSink *sink)
+		{
+			InputLock lock(*this);
+			sampleSinks.push_back(sink);
+		}
+
+		void removeSampleSink(SampleSink *sink)
+		{
+			InputLock lock(*this);
+			sampleSinks.erase(remove(sampleSinks.begin(), sampleSinks.end(), sink), sampleSinks.end());
+		}
+
+		// collect statistics of the incoming signal of each channel
+		void enableSignalStats(bool enabled)
+		{ __atomic_store_n(&collectStats, enabled, __ATOMIC_RELEASE); }
+
+		// statistics and number of completed sweeps since the last call
+		void takeSignalStats(vector<SignalStats> &stats, uint32_t &sweeps)
+		{
+			SDLScopedLock lock(statsMutex);
+			stats= signalStats;
+			sweeps= sweepCount;
+			for(size_t i= 0; i<signalStats.size(); i++)
+				signalStats[i].clear();
+			sweepCount= 0;
+		}
+
+		// render loop side: switch to the newest display frame, returns false if nothing new has been built
+		bool updateDisplayFrame()
+		{
+			if(!displayFrames.update()) return false;
+			__atomic_store_n(&takenSerial, displayFrames.getReadBuffer().serial, __ATOMIC_RELEASE);
+			return true;
+		}
+
+		const DisplayFrame &getDisplayFrame()
+		{ return displayFrames.getReadBuffer(); }
+
+		// same for the spectrum frames, which are built while the spectrum is enabled in the settings
+		bool updateSpectrumFrame()
+		{ return spectrumFrames.update(); }
+
+		const DisplayFrame &getSpectrumFrame()
+		{ return spectrumFrames.getReadBuffer(); }
+
+		// same for the persistence display
+		bool updatePhosphorFrame()
+		{ return phosphorFrames.update(); }
+
+		const PhosphorFrame &getPhosphorFrame()
+		{ return phosphorFrames.getReadBuffer(); }
+
+		// the waterfall rows in the order of the transforms, while the waterfall is enabled in the settings.
+		// returns false if there are no more.
+		bool readSpectrumRow(SpectrumRow &row)
+		{ return spectrumRows.read(row); }
+
+		// the points of the XY display, x in channel 0 and y in channel 1, while it is enabled in the settings.
+		// the goniometer points are already rotated into side and mid. points which don't fit are dropped.
+		SampleRingBuffer &getXYPoints()
+		{ return xyPoints; }
+
+		// phase correlation of the two channels of the XY display
+		float getCorrelation()
+		{
+			SDLScopedLock lock(statsMutex);
+			return correlation;
+		}
+
+		// the newest results of the measurements of each channel, while they are enabled in the settings.
+		// they are updated every MEASUREMENT_INTERVAL seconds of input; returns a serial number which
+		// changes with each update.
+		uint32_t getMeasurements(vector<Measurement> &results)
+		{
+			SDLScopedLock lock(statsMutex);
+			results= measurements;
+			return measurementSerial;
+		}
+
+		// counts of the mask test since it was last enabled
+		void getMaskResults(MaskResults &results)
+		{
+			SDLScopedLock lock(statsMutex);
+			results= maskResults;
+		}
+
+		// state of the sequence acquisition: the number of segments filled and the number there is memory for.
+		// returns a sequence number which changes when the segments start over. until then, filled segments
+		// stay as they are and new ones are only added after them.
+		uint32_t getSegmentCount(uint32_t &count, uint32_t &capacity)
+		{
+			SDLScopedLock lock(segmentMutex);
+			count= __atomic_load_n(&segmentsPublished, __ATOMIC_ACQUIRE);
+			capacity= segmentMemory.getCapacity();
+			return segmentSequence;
+		}
+
+		// copy a segment of the sequence, with the time of its trigger event after the one of the first
+		// segment. returns false if it hasn't been filled or the sequence isn't the one given any more.
+		bool readSegment(uint32_t sequence, uint32_t index, SweepCapture &dest, double &time)
+		{
+			SDLScopedLock lock(segmentMutex);
+			if(sequence!=segmentSequence || index>=__atomic_load_n(&segmentsPublished, __ATOMIC_ACQUIRE)) return false;
+			const SegmentMemory::Segment &s= segmentMemory.getSegment(index);
+			dest.streamPos= s.streamPos;
+			dest.nFrames= segmentMemory.getSize();
+			dest.nChannels= segmentMemory.getNumChannels();
+			dest.triggerOffset= s.triggerOffset;
+			dest.triggerFraction= s.triggerFraction;
+			dest.triggerStatus= s.triggerStatus;
+			dest.samplingRate= segmentMemory.getSamplingRate();
+			dest.samples.resize(size_t(dest.nFrames)*dest.nChannels);
+			for(unsigned ch= 0; ch<dest.nChannels; ch++)
+				memcpy(&dest.samples[size_t(ch)*dest.nFrames], segmentMemory.getChannel(index, ch),
+					   dest.nFrames*sizeof(jack_default_audio_sample_t));
+			time= s.time;
+			return true;
+		}
+
+		static const float MEASUREMENT_INTERVAL;
+
+	private:
+		AlignedArena historyArena;              // the history and the pyramids of all channels
+		jack_default_audio_sample_t *history;   // ring of the most recent samples, one channel after the other
+		uint32_t historySize;                   // per channel, power of two
+		unsigned nChannels;
+		uint32_t viewSize;                      // samples per sweep
+		uint64_t writePos;                      // stream position of the next sample written to the history
+		uint64_t viewStart;                     // stream position of the first sample of the current sweep
+		uint64_t prevViewStart;                 // same for the previous sweep
+		uint64_t triggerStreamPos;              // stream position of the last trigger event
+		float sweepFraction;                    // sub-sample position of the trigger crossing, before viewStart
+		float prevSweepFraction;                // same for the previous sweep
+		bool sweepComplete;                     // triggered sweep is complete, waiting for a trigger event
+		bool lineDisplayPeaks;
+		TriggerEngine trigger;
+		uint32_t triggerWaitSamples;            // samples searched since the last sweep was complete
+		DisplayFrame::TriggerStatus triggerStatus;
+		bool singleShotDone;
+		vector<PeakTracker> filters;
+		vector<DecimationPyramid> pyramids;
+		vector<jack_default_audio_sample_t*> readPointers;
+		ScopeSettings settings, pendingSettings;
+		SampleRingBuffer *ringBuffer;
+		bool settingsChanged;
+		DisplayFrame columnCache;               // up to date display columns, copied to the display frames
+		ColumnRangeSet dirtyColumns;            // columns which need to be recomputed
+		ColumnRangeSet frameDirtyColumns[3];    // columns which are outdated in each of the display frames
+		uint32_t frameSerial;                   // serial of the last published frame
+		uint32_t takenSerial;                   // serial of the frame the render loop has, written by the render loop
+		ColumnRangeSet renderChanges;           // columns changed since frame renderChangesSince
+		uint32_t renderChangesSince;
+		double ingestTime;                      // estimated arrival time of the newest samples processed
+		uint64_t ringFramesRead;                // frames read from the current ring buffer
+		double ringClockOffset;                 // estimated arrival time of the ring buffer's first frame
+		double ringClockTime, ringClockRate;    // time and input rate of the last estimate, 0 if there is none
+		uint32_t inputWaiters;                  // other threads waiting for inputMutex, accessed atomically
+		DisplayFrame::TriggerStatus publishedStatus;
+		uint32_t publishedFillColumn;
+		class RenderScheduler *scheduler;
+		CaptureQueue *captureQueue;
+		vector<SampleSink*> sampleSinks;
+		bool collectStats;                      // accessed atomically
+		vector<SignalStats> signalStats;        // guarded by statsMutex
+		uint32_t sweepCount;
+		TripleBuffer<DisplayFrame> displayFrames;
+		SpectrumAnalyzer spectrum;
+		TripleBuffer<DisplayFrame> spectrumFrames;
+		uint32_t spectrumSerial;
+		SlotQueue<SpectrumRow> spectrumRows;
+		FilterChain filterChain;
+		SincInterpolator sinc;
+		PhosphorAccumulator phosphor;
+		TripleBuffer<PhosphorFrame> phosphorFrames;
+		uint32_t phosphorSerial;
+		bool phosphorChanged;                   // sweeps have been drawn since the last phosphor frame
+		uint64_t phosphorPublishPos;            // write position at the last phosphor frame
+		double phosphorPublishTime;
+		vector<jack_default_audio_sample_t> sweepSamples;
+		vector<const jack_default_audio_sample_t*> sweepPointers;
+		enum { XYPOINTS= 1<<18 };
+		SampleRingBuffer xyPoints;
+		CorrelationMeter correlationMeter;
+		float correlation;                      // last value of the meter, guarded by statsMutex
+		vector<jack_default_audio_sample_t> midSide;
+		vector<MeasurementEngine> measurementEngines;
+		uint32_t measuredSamples;               // in the current measurement interval
+		vector<Measurement> measurements;       // results of the last interval, guarded by statsMutex
+		uint32_t measurementSerial;
+		const Mask *mask;
+		MaskTester maskTester;
+		MaskResults maskResults;                // guarded by statsMutex
+		CaptureQueue *maskFailureQueue;
+		// segments are filled without a lock, readers copy them under segmentMutex. the processing thread
+		// only takes it to clear the memory or set it up anew.
+		SegmentMemory segmentMemory;
+		uint32_t segmentSequence;               // guarded by segmentMutex
+		uint32_t segmentsPublished;             // filled segments the GUI may read, accessed atomically
+		SDL_mutex *settingsMutex, *inputMutex, *statsMutex, *segmentMutex;
+		SDL_Thread *thread;
+		bool quit;
+
+		static int threadFunc(void *arg)
+		{
+			reinterpret_cast<ScopeProcessor*>(arg)->run();
+			return 0;
+		}
+
+		void run()
+		{
+#if defined(__i386__) || defined(__x86_64__)
+			// flush denormals to zero, the filters produce them when their input goes silent
+			_mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+			while(!__atomic_load_n(&quit, __ATOMIC_ACQUIRE))
+			{
+				if(!processPending()) waitForInput();
+			}
+		}
+
+		// sleep until the jack callback has written new frames. new settings, other threads which need
+		// inputMutex and stop() wake the thread up, the timeout is only a fallback.
+		void waitForInput()
+		{
+			uint32_t delay= 10;
+			{
+				SDLScopedLock lock(inputMutex);
+				// a thread waiting for the lock gets it before this goes to sleep again
+				if(__atomic_load_n(&inputWaiters, __ATOMIC_SEQ_CST))
+					delay= 1;
+				else if(ringBuffer)
+				{
+					ringBuffer->waitForData(100);
+					return;
+				}
+			}
+			SDL_Delay(delay);
+		}
+
+		// make waitForInput() return. the ring buffer pointer is only changed by the thread calling this.
+		void wakeThread()
+		{
+			if(ringBuffer) ringBuffer->interruptWait();
+		}
+
+		// inputMutex, taken from another thread. the processing thread holds it while it sleeps on the ring
+		// buffer, so it is woken up first and lets go of it.
+		class InputLock
+		{
+			public:
+				InputLock(ScopeProcessor &processor): processor(processor)
+				{
+					__atomic_add_fetch(&processor.inputWaiters, 1, __ATOMIC_SEQ_CST);
+					processor.wakeThread();
+					SDL_LockMutex(processor.inputMutex);
+					__atomic_sub_fetch(&processor.inputWaiters, 1, __ATOMIC_SEQ_CST);
+				}
+
+				~InputLock()
+				{ SDL_UnlockMutex(processor.inputMutex); }
+
+			private:
+				ScopeProcessor &processor;
+		};
+
+		// copy pending settings from the GUI thread. returns true if anything has changed.
+		bool applySettings()
+		{
+			{
+				SDLScopedLock lock(settingsMutex);
+				if(!settingsChanged) return false;
+				if(pendingSettings.trigger.mode!=settings.trigger.mode ||
+				   pendingSettings.trigger.armCount!=settings.trigger.armCount)
+					singleShotDone= false;
+				if(pendingSettings.maskTest && !settings.maskTest)
+				{
+					SDLScopedLock lock(statsMutex);
+					maskResults= MaskResults();
+				}
+				if(pendingSettings.segmentArmCount!=settings.segmentArmCount)
+				{
+					SDLScopedLock lock(segmentMutex);
+					segmentMemory.clear();
+					startSegmentSequence();
+				}
+				settings= pendingSettings;
+				settingsChanged= false;
+			}
+			trigger.setSettings(settings.trigger, settings.samplingRate);
+			if(!settings.trigger.enabled)
+				sweepFraction= prevSweepFraction= 0;
+			if(settings.channels!=nChannels)
+			{
+				nChannels= max(settings.channels, 1u);
+				filters.resize(nChannels);
+				historySize= 0;
+			}
+			viewSize= max(settings.displaySamples, 1u);
+			// the history is sized for the longest sweep the settings allow, so zooming only moves the view
+			// and keeps the samples
+			uint32_t newHistorySize= getHistorySize(max(viewSize, settings.maxDisplaySamples));
+			if(newHistorySize>historySize || (newHistorySize<historySize && settings.maxDisplaySamples))
+			{
+				historySize= newHistorySize;
+				historyArena.reserve(getHistoryBytes(historySize));
+				history= historyArena.allocate<jack_default_audio_sample_t>(size_t(historySize)*nChannels);
+				memset(history, 0, size_t(historySize)*nChannels*sizeof(jack_default_audio_sample_t));
+				pyramids.resize(nChannels);
+				for(unsigned i= 0; i<nChannels; i++)
+				{
+					pyramids[i].setSize(historySize, historyArena);
+					pyramids[i].update(getHistory(i), 0, historySize);
+				}
+				// start out with a history of silence
+				writePos= viewStart= triggerStreamPos= historySize;
+				prevViewStart= viewStart-viewSize;
+				sweepComplete= false;
+			}
+			placeView();
+
+			double samplesPerStep= (settings.columns? double(viewSize) / settings.columns: 1.0);
+			for(unsigned i= 0; i<nChannels; i++)
+				filters[i].setNumSamples(samplesPerStep);
+			lineDisplayPeaks= (samplesPerStep>2.5);
+			spectrum.setSettings(settings.spectrum, nChannels, settings.samplingRate, settings.columns);
+			phosphor.setSettings(settings.phosphor, nChannels, settings.columns, viewSize, settings.samplingRate);
+			// the meter is a ratio of the sums, so it is valid again after the first chunk
+			correlationMeter.setup(settings.samplingRate);
+			correlationMeter.reset();
+			measurementEngines.resize(nChannels);
+			for(unsigned i= 0; i<nChannels; i++)
+				measurementEngines[i].setRate(settings.samplingRate);
+			maskTester.setup(mask, nChannels, viewSize, settings.maxDisplaySamples);
+			if(!segmentMemory.hasShape(settings.segments, nChannels, viewSize, settings.samplingRate))
+			{
+				SDLScopedLock lock(segmentMutex);
+				segmentMemory.setup(settings.segments, nChannels, viewSize, settings.maxDisplaySamples, settings.samplingRate);
+				startSegmentSequence();
+			}
+
+			resizeColumns(columnCache);
+			dirtyColumns.add(0, settings.columns);
+			return true;
+		}
+
+		// the history holds at least two sweeps, so that the previous sweep of a scrolling display and the
+		// pre-trigger samples of a triggered one are always available, plus the samples around them which
+		// the sinc interpolation reads
+		static uint32_t getHistorySize(uint32_t sweepSize)
+		{
+			uint32_t size= DecimationPyramid::BASEBLOCK;
+			while(size<sweepSize*2+SincInterpolator::TAPS) size*= 2;
+			return size;
+		}
+
+		// arena bytes taken by the history and the pyramids of all channels
+		size_t getHistoryBytes(uint32_t size)
+		{
+			return AlignedArena::roundUp(size_t(size)*nChannels*sizeof(jack_default_audio_sample_t)) +
+				   DecimationPyramid::getArenaBytes(size)*nChannels;
+		}
+
+		uint32_t getPreTriggerSamples()
+		{
+			float position= settings.trigger.position;
+			return uint32_t(viewSize*(position<0? 0: position>1? 1: position));
+		}
+
+		// position the current sweep for changed view size or trigger settings. nothing is copied,
+		// the sweep is just a window into the history.
+		void placeView()
+		{
+			if(settings.trigger.enabled)
+			{
+				viewStart= triggerStreamPos-getPreTriggerSamples();
+				sweepComplete= (writePos>=viewStart+viewSize);
+			}
+			else
+			{
+				if(writePos-viewStart>=viewSize)
+					viewStart= writePos;
+				prevViewStart= viewStart-viewSize;
+			}
+		}
+
+		jack_default_audio_sample_t *getHistory(unsigned channel)
+		{ return &history[size_t(channel)*historySize]; }
+
+		// drain all frames which are currently available in the ring buffer
+		bool addBuffers(SampleRingBuffer &ringBuffer)
+		{
+			uint32_t nFrames, nChannelsAvail= min(ringBuffer.getNumChannels(), nChannels);
+			bool haveData= false;
+			// the producer doesn't take timestamps in the realtime thread, so the arrival of the frames is
+			// estimated from their position in the stream. a pickup is never early, so the lowest pickup time
+			// less the stream time is when the first frame arrived. that estimate creeps forward by 100ppm to
+			// follow an audio clock which runs slow. the latency then includes the wakeup and any backlog.
+			double pickupTime= getTime(), inputRate= settings.samplingRate*max(settings.filter.decimation, 1u);
+			double pickupOffset= pickupTime-(ringFramesRead+ringBuffer.getReadSpace())/inputRate;
+			if(ringClockTime && inputRate==ringClockRate)
+				ringClockOffset= min(ringClockOffset+(pickupTime-ringClockTime)*1e-4, pickupOffset);
+			else
+				ringClockOffset= pickupOffset;
+			ringClockTime= pickupTime;
+			ringClockRate= inputRate;
+			readPointers.resize(ringBuffer.getNumChannels());
+			filterChain.setSettings(settings.filter, nChannelsAvail, settings.samplingRate*max(settings.filter.decimation, 1u),
+									settings.trigger.sourceChannel);
+			while( (nFrames= ringBuffer.getReadPointers(&readPointers[0])) )
+			{
+				// triggering, display and spectrum see the filtered samples, the sinks get the input as it is
+				jack_default_audio_sample_t **data= &readPointers[0];
+				const jack_default_audio_sample_t *triggerData= 0;
+				uint32_t n= nFrames;
+				if(filterChain.isActive())
+				{
+					n= filterChain.process(data, nFrames);
+					data= filterChain.getOutputs();
+					triggerData= filterChain.getTriggerOutput();
+				}
+				addBlock(data, n, nChannelsAvail, triggerData);
+				if(settings.spectrum.enabled)
+					spectrum.addSamples(data, nChannelsAvail, n);
+				if(settings.xy.mode!=XYSettings::XY_OFF)
+					addXYPoints(data, n, nChannelsAvail);
+				if(settings.measurements)
+					addMeasurements(data, n, nChannelsAvail);
+				for(size_t i= 0; i<sampleSinks.size(); i++)
+					sampleSinks[i]->write(&readPointers[0], ringBuffer.getNumChannels(), nFrames);
+				ringBuffer.commitRead(nFrames);
+				ringFramesRead+= nFrames;
+				haveData= true;
+			}
+			if(haveData) ingestTime= ringClockOffset+ringFramesRead/inputRate;
+			return haveData;
+		}
+
+		// append one block of frames to the history, handling triggering and sweeps. the trigger looks at
+		// triggerData if given, otherwise at the source channel.
+		void addBlock(jack_default_audio_sample_t **data, uint32_t nFrames, uint32_t nChannels,
+					  const jack_default_audio_sample_t *triggerData= 0)
+		{
+			uint32_t srcPos= 0;
+			bool triggerEnabled= settings.trigger.enabled;
+			const jack_default_audio_sample_t *triggerSource=
+				(triggerData? triggerData: data[min(settings.trigger.sourceChannel, nChannels-1)]);
+			while(srcPos<nFrames)
+			{
+				uint32_t blockSize= nFrames-srcPos;
+				if(triggerEnabled && sweepComplete)
+				{
+					if(settings.trigger.mode==TriggerSettings::TM_SINGLE && singleShotDone)
+					{
+						// hold the display and keep the history frozen until re-armed
+						trigger.skip(triggerSource+srcPos, blockSize);
+						triggerStatus= DisplayFrame::TS_STOPPED;
+						break;
+					}
+					// sweep is complete, wait for the next trigger event. the samples before it are
+					// recorded anyway, they are shown as pre-trigger history.
+					bool triggered= waitForTrigger(triggerSource+srcPos, blockSize);
+					writeHistory(data, srcPos, blockSize, nChannels);
+					srcPos+= blockSize;
+					if(triggered) startTriggeredSweep();
+					continue;
+				}
+				blockSize= min(blockSize, uint32_t(viewStart+viewSize-writePos));
+				writeHistory(data, srcPos, blockSize, nChannels);
+				if(triggerEnabled)
+					trigger.skip(triggerSource+srcPos, blockSize);
+				srcPos+= blockSize;
+				if(writePos>=viewStart+viewSize)
+				{
+					completeSweep();
+					if(!triggerEnabled)
+						prevViewStart= viewStart, viewStart= writePos;
+					else
+						sweepComplete= true, trigger.arm(), triggerWaitSamples= 0;
+				}
+			}
+		}
+
+		// feed a block to the measurement engines, taking the results at the end of each interval
+		void addMeasurements(jack_default_audio_sample_t **data, uint32_t nFrames, unsigned nChannels)
+		{
+			uint32_t intervalSamples= max(uint32_t(settings.samplingRate*MEASUREMENT_INTERVAL), 1u);
+			for(uint32_t pos= 0; pos<nFrames; )
+			{
+				uint32_t n= min(nFrames-pos, intervalSamples-min(measuredSamples, intervalSamples-1));
+				for(unsigned ch= 0; ch<nChannels; ch++)
+					measurementEngines[ch].add(data[ch]+pos, n);
+				pos+= n;
+				measuredSamples+= n;
+				if(measuredSamples>=intervalSamples)
+				{
+					SDLScopedLock lock(statsMutex);
+					measurements.resize(nChannels);
+					for(unsigned ch= 0; ch<nChannels; ch++)
+						measurementEngines[ch].take(measurements[ch]);
+					measurementSerial++;
+					measuredSamples= 0;
+					if(scheduler) scheduler->notifyFrame();
+				}
+			}
+		}
+
+		// pass a block on to the XY display and the correlation meter
+		void addXYPoints(jack_default_audio_sample_t **data, uint32_t nFrames, unsigned nChannels)
+		{
+			if(!nFrames || !nChannels) return;
+			const jack_default_audio_sample_t *x= data[min(settings.xy.xChannel, nChannels-1)],
+											  *y= data[min(settings.xy.yChannel, nChannels-1)];
+			correlationMeter.add(x, y, nFrames);
+			{
+				SDLScopedLock lock(statsMutex);
+				correlation= correlationMeter.get();
+			}
+			if(xyPoints.getWriteSpace()<nFrames)
+			{
+				xyPoints.countOverflow(nFrames);
+				return;
+			}
+			if(settings.xy.mode==XYSettings::XY_GONIOMETER)
+			{
+				// left up and to the left, right up and to the right: side across, mid upwards
+				midSide.resize(size_t(nFrames)*2);
+				const float scale= M_SQRT1_2;
+				for(uint32_t i= 0; i<nFrames; i++)
+					midSide[i]= (y[i]-x[i])*scale,
+					midSide[nFrames+i]= (x[i]+y[i])*scale;
+				x= &midSide[0];
+				y= &midSide[nFrames];
+			}
+			xyPoints.writeChannel(0, x, nFrames);
+			xyPoints.writeChannel(1, y, nFrames);
+			xyPoints.commitWrite(nFrames);
+		}
+
+		// search for the trigger event which starts the next sweep. nFrames is set to the number of samples
+		// before it, returns true if a sweep starts after them.
+		bool waitForTrigger(const jack_default_audio_sample_t *source, uint32_t &nFrames)
+		{
+			int mode= settings.trigger.mode;
+			// auto mode starts a sweep anyway after waiting for 100ms
+			uint32_t autoTimeout= max(uint32_t(settings.samplingRate*0.1), 1u);
+			if(mode==TriggerSettings::TM_AUTO)
+				nFrames= min(nFrames, autoTimeout-min(triggerWaitSamples, autoTimeout-1));
+			int triggerPos= trigger.find(source, nFrames);
+			if(triggerPos>=0)
+			{
+				nFrames= triggerPos;
+				triggerStatus= DisplayFrame::TS_TRIGGERED;
+				if(mode==TriggerSettings::TM_SINGLE) singleShotDone= true;
+				return true;
+			}
+			triggerWaitSamples+= nFrames;
+			if(mode==TriggerSettings::TM_AUTO && triggerWaitSamples>=autoTimeout)
+			{
+				triggerStatus= DisplayFrame::TS_AUTO;
+				return true;
+			}
+			if(mode!=TriggerSettings::TM_AUTO) triggerStatus= DisplayFrame::TS_WAITING;
+			return false;
+		}
+
+		// the trigger event is at the write position. the samples before it are shown right away,
+		// the rest of the sweep is filled in as it comes in.
+		void startTriggeredSweep()
+		{
+			triggerStreamPos= writePos;
+			prevViewStart= viewStart;
+			viewStart= triggerStreamPos-getPreTriggerSamples();
+			prevSweepFraction= sweepFraction;
+			sweepFraction= (triggerStatus==DisplayFrame::TS_TRIGGERED? trigger.getTriggerFraction(): 0);
+			sweepComplete= false;
+			markStreamDirty(viewStart, writePos);
+		}
+
+		// append frames to the history of each channel
+		void writeHistory(jack_default_audio_sample_t **data, uint32_t srcPos, uint32_t nFrames, uint32_t nChannels)
+		{
+			uint32_t mask= historySize-1;
+			// only the statistics are shared with the other threads, the history belongs to this one
+			if(__atomic_load_n(&collectStats, __ATOMIC_ACQUIRE))
+			{
+				SDLScopedLock lock(statsMutex);
+				signalStats.resize(this->nChannels);
+				for(unsigned ch= 0; ch<nChannels; ch++)
+					signalStats[ch].add(data[ch]+srcPos, nFrames);
+			}
+			for(uint32_t done= 0; done<nFrames; )
+			{
+				uint32_t ringPos= uint32_t(writePos+done)&mask, n= min(nFrames-done, historySize-ringPos);
+				if(lineDisplayPeaks && settings.peakEnvelope)
+				{
+					// the peak trackers run a group of channels at once
+					for(unsigned ch= 0; ch<nChannels; ch+= PeakTracker::GROUP)
+					{
+						const jack_default_audio_sample_t *in[PeakTracker::GROUP];
+						jack_default_audio_sample_t *out[PeakTracker::GROUP];
+						unsigned count= min(nChannels-ch, (unsigned)PeakTracker::GROUP);
+						for(unsigned k= 0; k<count; k++)
+							in[k]= data[ch+k]+srcPos+done,
+							out[k]= getHistory(ch+k)+ringPos;
+						PeakTracker::run(&filters[ch], in, out, count, n);
+					}
+				}
+				else for(unsigned ch= 0; ch<nChannels; ch++)
+					memcpy(getHistory(ch)+ringPos, data[ch]+srcPos+done, n*sizeof(jack_default_audio_sample_t));
+				for(unsigned ch= 0; ch<nChannels; ch++)
+					pyramids[ch].update(getHistory(ch), ringPos, ringPos+n);
+				done+= n;
+			}
+			markStreamDirty(writePos, writePos+nFrames);
+			writePos+= nFrames;
+		}
+
+		// the current sweep has been filled: count it, test it against the mask and hand a copy to the capture
+		// queue. with the trigger on, the sweep which was running before the first trigger event is skipped.
+		void completeSweep()
+		{
+			if(settings.trigger.enabled && triggerStatus==DisplayFrame::TS_WAITING) return;
+			{
+				SDLScopedLock lock(statsMutex);
+				sweepCount++;
+			}
+			if(settings.phosphor.enabled) drawPhosphorSweep();
+			if(settings.segments) storeSegment();
+			if(settings.maskTest && mask && testMask() && maskFailureQueue)
+				captureSweep(*maskFailureQueue);
+			if(captureQueue) captureSweep(*captureQueue);
+		}
+
+		// readers drop the segments they have copied. called with segmentMutex held.
+		void startSegmentSequence()
+		{
+			segmentSequence++;
+			__atomic_store_n(&segmentsPublished, 0, __ATOMIC_RELEASE);
+		}
+
+		// copy the sweep into the next segment of the sequence, if it isn't complete yet. readers don't look
+		// at it before it is published, so this needs no lock.
+		void storeSegment()
+		{
+			if(segmentMemory.isFull()) return;
+			SegmentMemory::Segment &s= segmentMemory.getNextSegment();
+			s.streamPos= viewStart;
+			s.triggerOffset= (settings.trigger.enabled? getPreTriggerSamples(): 0);
+			s.triggerFraction= sweepFraction;
+			s.triggerStatus= (settings.trigger.enabled? triggerStatus: DisplayFrame::TS_AUTO);
+			uint32_t begin= uint32_t(viewStart)&(historySize-1), n1= min(viewSize, historySize-begin);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const jack_default_audio_sample_t *src= getHistory(ch);
+				jack_default_audio_sample_t *dest= segmentMemory.getNextChannel(ch);
+				memcpy(dest, src+begin, n1*sizeof(jack_default_audio_sample_t));
+				memcpy(dest+n1, src, (viewSize-n1)*sizeof(jack_default_audio_sample_t));
+			}
+			segmentMemory.commit();
+			__atomic_store_n(&segmentsPublished, segmentMemory.getCount(), __ATOMIC_RELEASE);
+		}
+
+		// compare the sweep to the limits right where it is in the history ring. returns true if it failed.
+		bool testMask()
+		{
+			uint32_t begin= uint32_t(viewStart)&(historySize-1), n1= min(viewSize, historySize-begin);
+			uint32_t failed= 0;
+			SDLScopedLock lock(statsMutex);
+			maskResults.violations.resize(nChannels);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const jack_default_audio_sample_t *src= getHistory(ch);
+				uint32_t count= maskTester.test(ch, src+begin, n1, src);
+				maskResults.violations[ch]+= count;
+				failed|= count;
+			}
+			maskResults.sweeps++;
+			if(failed)
+			{
+				maskResults.failedSweeps++;
+				maskResults.lastFailurePos= viewStart;
+			}
+			return failed!=0;
+		}
+
+		// copy the current sweep out of the history into a queue, unless the queue is full
+		void captureSweep(CaptureQueue &queue)
+		{
+			SweepCapture *c= queue.getWriteSlot();
+			if(!c) return;
+			c->streamPos= viewStart;
+			c->nFrames= viewSize;
+			c->nChannels= nChannels;
+			c->triggerOffset= (settings.trigger.enabled? getPreTriggerSamples(): 0);
+			c->triggerFraction= sweepFraction;
+			c->triggerStatus= (settings.trigger.enabled? triggerStatus: DisplayFrame::TS_AUTO);
+			c->samplingRate= settings.samplingRate;
+			c->samples.resize(size_t(viewSize)*nChannels);
+			uint32_t begin= uint32_t(viewStart)&(historySize-1), n1= min(viewSize, historySize-begin);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const jack_default_audio_sample_t *src= getHistory(ch);
+				jack_default_audio_sample_t *dest= &c->samples[size_t(ch)*viewSize];
+				memcpy(dest, src+begin, n1*sizeof(jack_default_audio_sample_t));
+				memcpy(dest+n1, src, (viewSize-n1)*sizeof(jack_default_audio_sample_t));
+			}
+			queue.commitWrite();
+		}
+
+		// draw the sweep which has just been completed into the persistence histograms, with the sample
+		// before and after it. the one after it may not be there yet, then the last one is repeated.
+		void drawPhosphorSweep()
+		{
+			uint32_t n= viewSize+2, mask= historySize-1;
+			sweepSamples.resize(size_t(n)*nChannels);
+			sweepPointers.resize(nChannels);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const jack_default_audio_sample_t *src= getHistory(ch);
+				jack_default_audio_sample_t *dest= &sweepSamples[size_t(ch)*n];
+				for(uint32_t i= 0; i<n; i++)
+					dest[i]= src[uint32_t(min(viewStart-1+i, writePos-1))&mask];
+				sweepPointers[ch]= dest;
+			}
+			phosphor.addSweep(&sweepPointers[0], viewSize, sweepFraction);
+			phosphorChanged= true;
+		}
+
+		// mark the columns which show stream positions [begin, end) in the current sweep for refresh. the
+		// line display interpolates from samples up to half the sinc length to the right, so the columns
+		// before them change too, even when the samples themselves are past the end of the sweep.
+		void markStreamDirty(uint64_t begin, uint64_t end)
+		{
+			const uint64_t margin= SincInterpolator::TAPS/2+1;
+			begin= max(begin, viewStart+margin)-margin;
+			end= min(end, viewStart+viewSize);
+			if(begin<end)
+				markSamplesDirty(uint32_t(begin-viewStart), uint32_t(end-viewStart));
+		}
+
+		// mark the columns which show samples [begin, end) of the sweep for refresh. this is a little
+		// conservative: rounding to pyramid blocks can move a sample up to two columns to the left.
+		void markSamplesDirty(uint32_t begin, uint32_t end)
+		{
+			uint32_t windowWidth= settings.columns;
+			if(!windowWidth || begin>=end) return;
+			double sampleStep= double(viewSize)/windowWidth;
+			uint32_t first= uint32_t(begin/sampleStep), last= uint32_t(end/sampleStep)+2;
+			first= (first>2? first-2: 0);
+			dirtyColumns.add(first, min(last, windowWidth));
+		}
+
+		// find the samples shown at offsets [begin, end) of the sweep. columns which the current sweep
+		// hasn't reached yet show the previous one. returns false if the samples are not in the history.
+		bool getColumnSource(uint32_t begin, uint32_t &end, uint64_t &start)
+		{
+			uint64_t base= (viewStart+begin<writePos? viewStart: prevViewStart);
+			if(base+end>writePos) end= uint32_t(writePos-base);
+			if(end<=begin || base+begin+historySize<writePos) return false;
+			start= base+begin;
+			return true;
+		}
+
+		// summarize count samples of the history starting at a stream position
+		DecimationPyramid::Entry queryHistory(unsigned channel, int level, uint64_t start, uint32_t count)
+		{
+			const jack_default_audio_sample_t *samples= getHistory(channel);
+			DecimationPyramid &pyramid= pyramids[channel];
+			uint32_t begin= uint32_t(start)&(historySize-1), end= begin+count;
+			if(end<=historySize)
+				return pyramid.query(samples, level, begin, end);
+			DecimationPyramid::Entry e= pyramid.query(samples, level, begin, historySize);
+			e.merge(pyramid.query(samples, level, 0, end-historySize));
+			return e;
+		}
+
+		// set up the frame for the current settings. the column contents are left alone.
+		void resizeColumns(DisplayFrame &frame)
+		{
+			uint32_t windowWidth= settings.columns;
+
+			frame.nChannels= nChannels;
+			frame.width= windowWidth;
+			frame.lineDisplayPeaks= lineDisplayPeaks;
+			frame.peakEnvelope= settings.peakEnvelope;
+			frame.triggerEnabled= settings.trigger.enabled;
+			frame.triggerPosition= double(getPreTriggerSamples())/viewSize;
+			frame.displayTime= double(viewSize)/settings.samplingRate;
+
+			if(frame.coords.size()!=size_t(windowWidth)*nChannels)
+				frame.resizeColumns();
+		}
+
+		// recompute cached columns [begin, end) of all channels
+		void refreshColumns(uint32_t begin, uint32_t end)
+		{
+			uint32_t windowWidth= columnCache.width;
+			if(!windowWidth) return;
+
+			double sampleStep= double(viewSize)/windowWidth;
+			for(unsigned i= 0; i<nChannels; i++)
+			{
+				if(lineDisplayPeaks)
+					refreshPeakColumns(columnCache, i, sampleStep, begin, end);
+				else
+				{
+					// each column is a line segment from its sample to the one of the next column
+					gl2DCoords *coords= &columnCache.coords[columnCache.channelOffset(i)];
+					const jack_default_audio_sample_t *samples= getHistory(i);
+					float y= getLineSample(samples, begin, sampleStep);
+					for(uint32_t coordIdx= begin; coordIdx<end; coordIdx++)
+					{
+						coords[coordIdx].x= coordIdx;
+						coords[coordIdx].y= y;
+						if(coordIdx+1<windowWidth)
+							y= getLineSample(samples, coordIdx+1, sampleStep),
+							coords[coordIdx].x1= coordIdx+1,
+							coords[coordIdx].y1= y;
+						else
+							coords[coordIdx].x1= coordIdx,
+							coords[coordIdx].y1= coords[coordIdx].y;
+					}
+				}
+			}
+		}
+
+		// the value shown in a column of the line display. columns fall between samples when zoomed in, and
+		// triggered sweeps are shifted by the sub-sample position of their trigger crossing, so the trace
+		// doesn't jitter from sweep to sweep. in between, the samples are interpolated linearly or with the
+		// sinc. columns of the current sweep show the previous one until all the samples they are
+		// interpolated from have come in.
+		float getLineSample(const jack_default_audio_sample_t *samples, uint32_t column, double sampleStep)
+		{
+			const int before= SincInterpolator::TAPS/2-1, after= (settings.sincInterpolation? SincInterpolator::TAPS/2: 1);
+			double offset= min(column*sampleStep, double(viewSize-1));
+			int64_t first= int64_t(floor(offset-sweepFraction));
+			bool current= (viewStart+first+after<writePos);
+			if(!current) first= int64_t(floor(offset-prevSweepFraction));
+			float fraction= offset-(current? sweepFraction: prevSweepFraction)-first;
+			uint64_t index= (current? viewStart: prevViewStart)+first, oldest= writePos-historySize;
+			if(index>=writePos || index<oldest+(settings.sincInterpolation? before: 0))
+				return 0;
+			uint32_t mask= historySize-1;
+			if(!settings.sincInterpolation)
+			{
+				float s0= samples[uint32_t(index)&mask], s1= samples[uint32_t(min(index+1, writePos-1))&mask];
+				return s0 + (s1-s0)*fraction;
+			}
+			float taps[SincInterpolator::TAPS];
+			for(int k= 0; k<SincInterpolator::TAPS; k++)
+				taps[k]= samples[uint32_t(min(index+k-before, writePos-1))&mask];
+			return sinc.interpolate(taps, fraction);
+		}
+
+		// each column summarizes all samples it covers, looked up from the decimation pyramid
+		void refreshPeakColumns(DisplayFrame &frame, unsigned channel, double sampleStep, uint32_t first, uint32_t last)
+		{
+			uint32_t windowWidth= frame.width;
+			int level= pyramids[channel].getLevel(sampleStep);
+			for(uint32_t coordIdx= first; coordIdx<last; coordIdx++)
+			{
+				uint32_t begin= uint32_t(coordIdx*sampleStep),
+						 end= (coordIdx+1<windowWidth? min(uint32_t((coordIdx+1)*sampleStep), viewSize): viewSize);
+				if(end<=begin) end= begin+1;
+				uint64_t start;
+				DecimationPyramid::Entry e= { 0, 0, 0, 0 };
+				if(getColumnSource(begin, end, start))
+					e= queryHistory(channel, level, start, end-begin);
+				frame.setPeakColumn(channel, coordIdx, e.min, e.max, e.rms(), settings.peakEnvelope);
+			}
+		}
+
+		// column up to which the current sweep has been filled
+		uint32_t getFillColumn()
+		{ return uint32_t(min(writePos-viewStart, uint64_t(viewSize))*columnCache.width/viewSize); }
+
+		// bring the next display frame up to date by copying the columns which changed since it was
+		// last written, and hand it over to the render loop
+		void publishDisplayFrame()
+		{
+			DisplayFrame &frame= displayFrames.getWriteBuffer();
+			ColumnRangeSet &dirty= frameDirtyColumns[displayFrames.getWriteIndex()];
+			if(frame.width!=columnCache.width || frame.nChannels!=columnCache.nChannels)
+				frame= columnCache;
+			else
+			{
+				frame.lineDisplayPeaks= columnCache.lineDisplayPeaks;
+				frame.peakEnvelope= columnCache.peakEnvelope;
+				frame.triggerEnabled= columnCache.triggerEnabled;
+				frame.triggerPosition= columnCache.triggerPosition;
+				frame.displayTime= columnCache.displayTime;
+				for(int i= 0; i<dirty.size(); i++)
+				{
+					for(unsigned ch= 0; ch<frame.nChannels; ch++)
+					{
+						uint32_t begin= frame.channelOffset(ch)+dirty[i].begin, end= frame.channelOffset(ch)+dirty[i].end;
+						copy(columnCache.coords.begin()+begin, columnCache.coords.begin()+end, frame.coords.begin()+begin);
+						copy(columnCache.colors.begin()+begin, columnCache.colors.begin()+end, frame.colors.begin()+begin);
+						copy(columnCache.rmsCoords.begin()+begin, columnCache.rmsCoords.begin()+end, frame.rmsCoords.begin()+begin);
+					}
+				}
+			}
+			dirty.clear();
+			// the render loop may skip frames, so the changes are collected until it has caught up
+			if(__atomic_load_n(&takenSerial, __ATOMIC_ACQUIRE)==frameSerial)
+				renderChanges.clear(), renderChangesSince= frameSerial;
+			renderChanges.add(dirtyColumns);
+			frame.serial= ++frameSerial;
+			frame.changesSince= renderChangesSince;
+			frame.changedColumns= renderChanges;
+			frame.triggerStatus= triggerStatus;
+			frame.ingestTime= ingestTime;
+			frame.fillColumn= getFillColumn();
+			publishedStatus= triggerStatus;
+			publishedFillColumn= frame.fillColumn;
+			displayFrames.publish();
+		}
+
+		void publishPhosphorFrame()
+		{
+			PhosphorFrame &frame= phosphorFrames.getWriteBuffer();
+			phosphor.fillFrame(frame, writePos);
+			frame.serial= ++phosphorSerial;
+			phosphorFrames.publish();
+			phosphorChanged= false;
+			phosphorPublishPos= writePos;
+			phosphorPublishTime= getTime();
+		}
+
+		// the spectrum is redrawn completely every time
+		void publishSpectrumFrame()
+		{
+			DisplayFrame &frame= spectrumFrames.getWriteBuffer();
+			spectrum.fillFrame(frame);
+			frame.serial= ++spectrumSerial;
+			frame.changesSince= frame.serial;
+			frame.changedColumns.clear();
+			frame.changedColumns.add(0, frame.width);
+			frame.ingestTime= ingestTime;
+			spectrumFrames.publish();
+		}
+};
+
+const float ScopeProcessor::MEASUREMENT_INTERVAL= 0.2;
+
+// the GL 2.0 / GLES 2.0 functions used by the shader renderer. they aren't linked with SDL 1.2,
+// so they are looked up at runtime, once there is a GL context.
+struct GLShaderFunctions
+{
+	PFNGLCREATESHADERPROC CreateShader;
+	PFNGLSHADERSOURCEPROC ShaderSource;
+	PFNGLCOMPILESHADERPROC CompileShader;
+	PFNGLGETSHADERIVPROC GetShaderiv;
+	PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+	PFNGLDELETESHADERPROC DeleteShader;
+	PFNGLCREATEPROGRAMPROC CreateProgram;
+	PFNGLATTACHSHADERPROC AttachShader;
+	PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+	PFNGLLINKPROGRAMPROC LinkProgram;
+	PFNGLGETPROGRAMIVPROC GetProgramiv;
+	PFNGLGETPROGRAMINFOLOGPROC GetProgramInfoLog;
+	PFNGLUSEPROGRAMPROC UseProgram;
+	PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+	PFNGLUNIFORM1FPROC Uniform1f;
+	PFNGLUNIFORM2FPROC Uniform2f;
+	PFNGLUNIFORM4FPROC Uniform4f;
+	PFNGLGENBUFFERSPROC GenBuffers;
+	PFNGLBINDBUFFERPROC BindBuffer;
+	PFNGLBUFFERDATAPROC BufferData;
+	PFNGLBUFFERSUBDATAPROC BufferSubData;
+	PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+	PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+	PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray;
+	PFNGLGENVERTEXARRAYSPROC GenVertexArrays;   // GL 3.0, only needed for core profiles
+	PFNGLBINDVERTEXARRAYPROC BindVertexArray;
+
+	bool load()
+	{
+#define GET_GL_FUNCTION(name) if(!(name= (__typeof__(name))SDL_GL_GetProcAddress("gl" #name))) return false
+		GET_GL_FUNCTION(CreateShader);
+		GET_GL_FUNCTION(ShaderSource);
+		GET_GL_FUNCTION(CompileShader);
+		GET_GL_FUNCTION(GetShaderiv);
+		GET_GL_FUNCTION(GetShaderInfoLog);
+		GET_GL_FUNCTION(DeleteShader);
+		GET_GL_FUNCTION(CreateProgram);
+		GET_GL_FUNCTION(AttachShader);
+		GET_GL_FUNCTION(BindAttribLocation);
+		GET_GL_FUNCTION(LinkProgram);
+		GET_GL_FUNCTION(GetProgramiv);
+		GET_GL_FUNCTION(GetProgramInfoLog);
+		GET_GL_FUNCTION(UseProgram);
+		GET_GL_FUNCTION(GetUniformLocation);
+		GET_GL_FUNCTION(Uniform1f);
+		GET_GL_FUNCTION(Uniform2f);
+		GET_GL_FUNCTION(Uniform4f);
+		GET_GL_FUNCTION(GenBuffers);
+		GET_GL_FUNCTION(BindBuffer);
+		GET_GL_FUNCTION(BufferData);
+		GET_GL_FUNCTION(BufferSubData);
+		GET_GL_FUNCTION(VertexAttribPointer);
+		GET_GL_FUNCTION(EnableVertexAttribArray);
+		GET_GL_FUNCTION(DisableVertexAttribArray);
+#undef GET_GL_FUNCTION
+		GenVertexArrays= (PFNGLGENVERTEXARRAYSPROC)SDL_GL_GetProcAddress("glGenVertexArrays");
+		BindVertexArray= (PFNGLBINDVERTEXARRAYPROC)SDL_GL_GetProcAddress("glBindVertexArray");
+		return true;
+	}
+};
+
+// shader based signal renderer. the columns of all channels are kept in a vertex buffer, which is updated
+// only where the display frame has changed. the vertex shader places the columns in their lanes and does the
+// scrolling, vertical scaling, envelope mirroring and coloring, so all channels are drawn with one or two
+// calls. the shaders are written in the common subset of GLSL 1.20, GLSL ES 1.00 and GLSL 3.30 core.
+class GLSignalRenderer
+{
+	public:
+		GLSignalRenderer(): available(false), legacyContext(true), esContext(false), signalProgram(0), lineProgram(0),
+			textureProgram(0), pointProgram(0), signalBuffer(0), lineBuffer(0), pointBuffer(0), vertexArray(0),
+			pointCapacity(0), signalCapacity(0), uploadedSerial(0), uploadedWidth(0),
+			uploadedChannels(0), uploadedPeaks(false), uploadedEnvelope(false), bufferValid(false)
+		{ }
+
+		// the next frame doesn't continue the ones uploaded before, as it comes from another source
+		void invalidate()
+		{ bufferValid= false; }
+
+		// set up shaders and buffers, needs a current GL context. returns false if the context can't
+		// do it, the caller should fall back to fixed function drawing then.
+		bool init()
+		{
+			available= false;
+			const char *version= (const char*)glGetString(GL_VERSION);
+			int major= 0, minor= 0;
+			if(!version || !gl.load()) return false;
+			bool es= !strncmp(version, "OpenGL ES", 9);
+			sscanf(es? version+9: version, " %d.%d", &major, &minor);
+			if(major<2) return false;
+			legacyContext= !es;
+			esContext= es;
+			if(!es && (major>3 || (major==3 && minor>=2)))
+			{
+				GLint profile= 0;
+				glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &profile);
+				legacyContext= !(profile & GL_CONTEXT_CORE_PROFILE_BIT);
+			}
+			if(!legacyContext && !es && (!gl.GenVertexArrays || !gl.BindVertexArray)) return false;
+
+			string vertexHeader, fragmentHeader;
+			if(es)
+				vertexHeader= "#version 100\n",
+				fragmentHeader= "#version 100\nprecision mediump float;\n";
+			else if(legacyContext)
+				vertexHeader= fragmentHeader= "#version 120\n";
+			else
+				vertexHeader= "#version 330 core\n#define attribute in\n#define varying out\n",
+				fragmentHeader= "#version 330 core\n#define varying in\nout vec4 fragColor;\n#define gl_FragColor fragColor\n"
+								"#define texture2D texture\n";
+
+			signalProgram= buildProgram(vertexHeader+signalVertexShader, fragmentHeader+signalFragmentShader, "aVertex", 0);
+			lineProgram= buildProgram(vertexHeader+lineVertexShader, fragmentHeader+lineFragmentShader, "aPosition", "aColor");
+			textureProgram= buildProgram(vertexHeader+textureVertexShader, fragmentHeader+textureFragmentShader, "aVertex", 0);
+			pointProgram= buildProgram(vertexHeader+pointVertexShader, fragmentHeader+pointFragmentShader, "aPoint", 0);
+			if(!signalProgram || !lineProgram || !textureProgram || !pointProgram) return false;
+			uArea= gl.GetUniformLocation(signalProgram, "uArea");
+			uView= gl.GetUniformLocation(signalProgram, "uView");
+			uSignalScreen= gl.GetUniformLocation(signalProgram, "uScreen");
+			uMirror= gl.GetUniformLocation(signalProgram, "uMirror");
+			uColorMode= gl.GetUniformLocation(signalProgram, "uColorMode");
+			uColor= gl.GetUniformLocation(signalProgram, "uColor");
+			uLineScreen= gl.GetUniformLocation(lineProgram, "uScreen");
+			uTextureScreen= gl.GetUniformLocation(textureProgram, "uScreen");
+			uPointArea= gl.GetUniformLocation(pointProgram, "uArea");
+			uPointAge= gl.GetUniformLocation(pointProgram, "uAge");
+			uPointScreen= gl.GetUniformLocation(pointProgram, "uScreen");
+			uPointColor= gl.GetUniformLocation(pointProgram, "uColor");
+
+			gl.GenBuffers(1, &signalBuffer);
+			gl.GenBuffers(1, &lineBuffer);
+			gl.GenBuffers(1, &pointBuffer);
+			pointCapacity= 0;
+			signalCapacity= 0;
+			if(!legacyContext && !es)
+				gl.GenVertexArrays(1, &vertexArray);
+			bufferValid= false;
+			available= checkglerror();
+			return available;
+		}
+
+		bool isAvailable()
+		{ return available; }
+
+		// draw the signals of the first nLanes channels of a frame, each lane laneHeight pixels high
+		void drawSignals(const DisplayFrame &frame, float x, float y, float width, float laneHeight, unsigned nLanes,
+						 float verticalScaling)
+		{
+			nLanes= min(nLanes, frame.nChannels);
+			if(!frame.width || !nLanes) return;
+			uploadFrame(frame);
+
+			// a scrolling display starts with the column after the one last filled
+			uint32_t shift= 0;
+			if(!frame.triggerEnabled)
+			{
+				shift= frame.fillColumn+1;
+				while(shift>frame.width) shift-= frame.width;
+			}
+			GLsizei count= GLsizei(frame.width*nLanes*2);
+
+			beginDraw(signalProgram, signalBuffer);
+			gl.EnableVertexAttribArray(0);
+			gl.VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), 0);
+			gl.Uniform4f(uArea, x, y, width, laneHeight);
+			gl.Uniform4f(uView, frame.width, shift, frame.lineDisplayPeaks? 0: 1, verticalScaling);
+			gl.Uniform2f(uSignalScreen, viewport.rgt, viewport.btm);
+			gl.Uniform1f(uMirror, 1);
+			if(!frame.lineDisplayPeaks)
+			{
+				gl.Uniform1f(uColorMode, CM_CONSTANT);
+				gl.Uniform4f(uColor, .1,1,.25,.75);
+				if(legacyContext) glEnable(GL_LINE_SMOOTH), glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+				glDrawArrays(GL_LINES, 0, count);
+				if(legacyContext) glDisable(GL_LINE_SMOOTH);
+			}
+			else if(frame.peakEnvelope)
+			{
+				gl.Uniform1f(uColorMode, CM_ENVELOPE);
+				glDrawArrays(GL_LINES, 0, count);
+				gl.Uniform1f(uMirror, -1);
+				glDrawArrays(GL_LINES, 0, count);
+			}
+			else
+			{
+				gl.Uniform1f(uColorMode, CM_PEAKS);
+				glDrawArrays(GL_LINES, 0, count);
+				// rms bars in a constant color, they are stored after the min/max bars
+				gl.Uniform1f(uColorMode, CM_CONSTANT);
+				gl.Uniform4f(uColor, .1,1,.8,.35);
+				gl.VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)(getRmsOffset(frame)*sizeof(Vertex)));
+				glDrawArrays(GL_LINES, 0, count);
+			}
+			gl.DisableVertexAttribArray(0);
+			endDraw();
+		}
+
+		// draw a batch of lines, streamed into a buffer which is orphaned each time
+		void drawLines(const LineBatch &batch, float lineWidth= 1, bool smooth= false)
+		{
+			if(batch.empty()) return;
+			beginDraw(lineProgram, lineBuffer);
+			gl.BufferData(GL_ARRAY_BUFFER, batch.vertices.size()*sizeof(LineBatch::Vertex), &batch.vertices[0], GL_STREAM_DRAW);
+			gl.EnableVertexAttribArray(0);
+			gl.EnableVertexAttribArray(1);
+			gl.VertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(LineBatch::Vertex), 0);
+			gl.VertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(LineBatch::Vertex), (void*)(2*sizeof(float)));
+			gl.Uniform2f(uLineScreen, viewport.rgt, viewport.btm);
+			if(lineWidth!=1) glLineWidth(lineWidth);
+			if(smooth && legacyContext) glEnable(GL_LINE_SMOOTH);
+			glDrawArrays(GL_LINES, 0, GLsizei(batch.vertices.size()));
+			if(smooth && legacyContext) glDisable(GL_LINE_SMOOTH);
+			if(lineWidth!=1) glLineWidth(1);
+			gl.DisableVertexAttribArray(0);
+			gl.DisableVertexAttribArray(1);
+			endDraw();
+		}
+
+		// draw a rectangle in window coordinates, textured with texture coordinates s0,t0 at the top left
+		// and s1,t1 at the bottom right
+		void drawTexture(GLuint texture, float x, float y, float width, float height, float s0, float t0, float s1, float t1)
+		{
+			float quad[4][4]=
+			{
+				{ x, y, s0, t0 }, { x, y+height, s0, t1 },
+				{ x+width, y, s1, t0 }, { x+width, y+height, s1, t1 }
+			};
+			beginDraw(textureProgram, lineBuffer);
+			glBindTexture(GL_TEXTURE_2D, texture);
+			gl.BufferData(GL_ARRAY_BUFFER, sizeof(quad), quad, GL_STREAM_DRAW);
+			gl.EnableVertexAttribArray(0);
+			gl.VertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(float), 0);
+			gl.Uniform2f(uTextureScreen, viewport.rgt, viewport.btm);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			gl.DisableVertexAttribArray(0);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			endDraw();
+		}
+
+		// the point buffer is a ring of capacity points, each an x, y and serial number. the caller writes it
+		// piecewise, n points starting at point first.
+		void uploadPoints(uint32_t capacity, uint32_t first, const float *points, uint32_t n)
+		{
+			gl.BindBuffer(GL_ARRAY_BUFFER, pointBuffer);
+			if(capacity!=pointCapacity)
+			{
+				gl.BufferData(GL_ARRAY_BUFFER, size_t(capacity)*3*sizeof(float), 0, GL_STREAM_DRAW);
+				pointCapacity= capacity;
+			}
+			gl.BufferSubData(GL_ARRAY_BUFFER, size_t(first)*3*sizeof(float), size_t(n)*3*sizeof(float), points);
+			gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+		// draw n points of the ring starting at point first, +-1 reaching radius pixels from the center after
+		// scaling. the points fade by exp(-decay) for each point they are older than the newest serial.
+		void drawPoints(uint32_t first, uint32_t n, float newestSerial, float decay, float cx, float cy, float radius,
+						float scale, float pointSize, float alpha)
+		{
+			if(!n || !pointCapacity) return;
+			beginDraw(pointProgram, pointBuffer);
+			gl.EnableVertexAttribArray(0);
+			gl.VertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(float), 0);
+			gl.Uniform4f(uPointArea, cx, cy, radius, scale);
+			gl.Uniform4f(uPointAge, newestSerial, decay, pointSize, 0);
+			gl.Uniform2f(uPointScreen, viewport.rgt, viewport.btm);
+			gl.Uniform4f(uPointColor, .1,1,.25, alpha);
+			// ES always takes the size from the shader
+			if(!esContext) glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+			uint32_t n1= min(n, pointCapacity-first);
+			glDrawArrays(GL_POINTS, first, n1);
+			if(n1<n) glDrawArrays(GL_POINTS, 0, n-n1);
+			if(!esContext) glDisable(GL_VERTEX_PROGRAM_POINT_SIZE);
+			gl.DisableVertexAttribArray(0);
+			endDraw();
+		}
+
+	private:
+		// column, value, level for coloring, lane*2 + index of the vertex in the column
+		struct Vertex { float column, value, level, laneVertex; };
+		enum { CM_CONSTANT= 0, CM_PEAKS, CM_ENVELOPE };
+
+		GLShaderFunctions gl;
+		bool available;
+		bool legacyContext;     // compatibility or GL 2.x context, which has line smoothing
+		bool esContext;
+		GLuint signalProgram, lineProgram, textureProgram, pointProgram;
+		GLuint signalBuffer, lineBuffer, pointBuffer;
+		GLuint vertexArray;
+		uint32_t pointCapacity;
+		size_t signalCapacity;      // vertices the signal buffer has storage for
+		GLint uArea, uView, uSignalScreen, uMirror, uColorMode, uColor, uLineScreen, uTextureScreen;
+		GLint uPointArea, uPointAge, uPointScreen, uPointColor;
+		AlignedArray<Vertex> vertices;  // copy of the signal buffer contents
+		uint32_t uploadedSerial, uploadedWidth;
+		unsigned uploadedChannels;
+		bool uploadedPeaks, uploadedEnvelope;
+		bool bufferValid;
+
+		static const char *signalVertexShader, *signalFragmentShader, *lineVertexShader, *lineFragmentShader,
+						  *textureVertexShader, *textureFragmentShader, *pointVertexShader, *pointFragmentShader;
+
+		void beginDraw(GLuint program, GLuint buffer)
+		{
+			gl.UseProgram(program);
+			if(vertexArray) gl.BindVertexArray(vertexArray);
+			gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+		}
+
+		void endDraw()
+		{
+			gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+			if(vertexArray) gl.BindVertexArray(0);
+			gl.UseProgram(0);
+		}
+
+		// the rms bars follow the min/max bars of all channels
+		size_t getRmsOffset(const DisplayFrame &frame)
+		{ return size_t(frame.width)*frame.nChannels*2; }
+
+		// bring the signal buffer up to date. if the frame continues the one uploaded last, only the
+		// columns which have changed since then are converted and uploaded.
+		void uploadFrame(const DisplayFrame &frame)
+		{
+			bool sameLayout= (bufferValid && frame.width==uploadedWidth && frame.nChannels==uploadedChannels &&
+							  frame.lineDisplayPeaks==uploadedPeaks && frame.peakEnvelope==uploadedEnvelope);
+			if(sameLayout && frame.serial==uploadedSerial) return;
+			gl.BindBuffer(GL_ARRAY_BUFFER, signalBuffer);
+			if(sameLayout && int32_t(uploadedSerial-frame.changesSince)>=0)
+			{
+				size_t rmsOffset= getRmsOffset(frame);
+				bool rms= (frame.lineDisplayPeaks && !frame.peakEnvelope);
+				for(int i= 0; i<frame.changedColumns.size(); i++)
+				{
+					uint32_t begin= frame.changedColumns[i].begin, end= min(frame.changedColumns[i].end, frame.width);
+					if(begin>=end) continue;
+					for(unsigned ch= 0; ch<frame.nChannels; ch++)
+					{
+						convertColumns(frame, ch, begin, end);
+						size_t first= size_t(frame.channelOffset(ch)+begin)*2, n= size_t(end-begin)*2;
+						gl.BufferSubData(GL_ARRAY_BUFFER, first*sizeof(Vertex), n*sizeof(Vertex), &vertices[first]);
+						if(rms)
+							gl.BufferSubData(GL_ARRAY_BUFFER, (rmsOffset+first)*sizeof(Vertex), n*sizeof(Vertex),
+											 &vertices[rmsOffset+first]);
+					}
+				}
+			}
+			else
+			{
+				// both the vertices and the buffer storage only grow, so a new layout usually fits
+				vertices.reserve(max(getRmsOffset(frame), size_t(DisplayFrame::RESERVED_COLUMNS)*frame.nChannels*2)*2);
+				vertices.resize(getRmsOffset(frame)*2);
+				for(unsigned ch= 0; ch<frame.nChannels; ch++)
+					convertColumns(frame, ch, 0, frame.width);
+				if(vertices.getCapacity()>signalCapacity)
+				{
+					gl.BufferData(GL_ARRAY_BUFFER, vertices.getCapacity()*sizeof(Vertex), 0, GL_DYNAMIC_DRAW);
+					signalCapacity= vertices.getCapacity();
+				}
+				if(!vertices.empty())
+					gl.BufferSubData(GL_ARRAY_BUFFER, 0, vertices.size()*sizeof(Vertex), &vertices[0]);
+				uploadedWidth= frame.width;
+				uploadedChannels= frame.nChannels;
+				uploadedPeaks= frame.lineDisplayPeaks;
+				uploadedEnvelope= frame.peakEnvelope;
+				bufferValid= true;
+			}
+			gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+			uploadedSerial= frame.serial;
+		}
+
+		// convert columns [begin, end) of a channel to vertices
+		void convertColumns(const DisplayFrame &frame, unsigned channel, uint32_t begin, uint32_t end)
+		{
+			uint32_t offset= frame.channelOffset(channel);
+			size_t rmsOffset= getRmsOffset(frame);
+			float lane= channel*2;
+			bool rms= (frame.lineDisplayPeaks && !frame.peakEnvelope);
+			for(uint32_t i= begin; i<end; i++)
+			{
+				const gl2DCoords &c= frame.coords[offset+i];
+				Vertex *v= &vertices[size_t(offset+i)*2];
+				// envelope bars are colored from the center outwards by the peak value
+				float level= fabs(c.y), level1= (frame.peakEnvelope? level: fabs(c.y1));
+				Vertex v0= { float(i), c.y, level, lane }, v1= { float(i), c.y1, level1, lane+1 };
+				v[0]= v0; v[1]= v1;
+				if(rms)
+				{
+					const gl2DCoords &r= frame.rmsCoords[offset+i];
+					Vertex r0= { float(i), r.y, 0, lane }, r1= { float(i), r.y1, 0, lane+1 };
+					v[rmsOffset]= r0; v[rmsOffset+1]= r1;
+				}
+			}
+		}
+
+		GLuint compileShader(GLenum type, const string &source)
+		{
+			GLuint shader= gl.CreateShader(type);
+			const char *src= source.c_str();
+			gl.ShaderSource(shader, 1, &src, 0);
+			gl.CompileShader(shader);
+			GLint ok= 0;
+			gl.GetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+			if(!ok)
+			{
+				char log[1024]= "";
+				gl.GetShaderInfoLog(shader, sizeof(log), 0, log);
+				printf("shader compilation failed: %s\n", log);
+				gl.DeleteShader(shader);
+				return 0;
+			}
+			return shader;
+		}
+
+		GLuint buildProgram(const string &vertexSource, const string &fragmentSource, const char *attrib0, const char *attrib1)
+		{
+			GLuint vertexShader= compileShader(GL_VERTEX_SHADER, vertexSource),
+				   fragmentShader= compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+			if(!vertexShader || !fragmentShader) return 0;
+			GLuint program= gl.CreateProgram();
+			gl.AttachShader(program, vertexShader);
+			gl.AttachShader(program, fragmentShader);
+			gl.BindAttribLocation(program, 0, attrib0);
+			if(attrib1) gl.BindAttribLocation(program, 1, attrib1);
+			gl.LinkProgram(program);
+			gl.DeleteShader(vertexShader);
+			gl.DeleteShader(fragmentShader);
+			GLint ok= 0;
+			gl.GetProgramiv(program, GL_LINK_STATUS, &ok);
+			if(!ok)
+			{
+				char log[1024]= "";
+				gl.GetProgramInfoLog(program, sizeof(log), 0, log);
+				printf("shader linking failed: %s\n", log);
+				return 0;
+			}
+			return program;
+		}
+};
+
+// uArea: x, y and width of the display and lane height in pixels
+// uView: number of columns, scroll shift, 1 for line segments/0 for bars, vertical scaling
+const char *GLSignalRenderer::signalVertexShader=
+	"attribute vec4 aVertex;\n"
+	"uniform vec4 uArea;\n"
+	"uniform vec4 uView;\n"
+	"uniform vec2 uScreen;\n"
+	"uniform float uMirror;\n"
+	"uniform float uColorMode;\n"
+	"uniform vec4 uColor;\n"
+	"varying vec4 vColor;\n"
+	"varying float vLaneY;\n"
+	"void main()\n"
+	"{\n"
+	"	float lane= floor(aVertex.w*0.5);\n"
+	"	float end= aVertex.w-lane*2.0;\n"
+	"	float column= aVertex.x-uView.y;\n"
+	"	if(column<0.0) column+= uView.x;\n"
+	"	column+= end*uView.z;\n"
+	"	vLaneY= aVertex.y*uView.w*uMirror;\n"
+	"	vec2 pos= vec2(uArea.x+column*uArea.z/uView.x, uArea.y+uArea.w*(lane+0.5-vLaneY*0.5));\n"
+	"	gl_Position= vec4(pos.x*2.0/uScreen.x-1.0, 1.0-pos.y*2.0/uScreen.y, 0.0, 1.0);\n"
+	"	float red= clamp((aVertex.z-0.75)*4.0, 0.0, 0.75);\n"
+	"	if(uColorMode<0.5) vColor= uColor;\n"
+	"	else if(uColorMode>1.5 && end>0.5) vColor= vec4(vec3(0.1, 1.0, 0.8)*(aVertex.z*0.5+0.5), 1.0);\n"
+	"	else vColor= vec4(0.05+red, 0.5, 0.1, 1.0);\n"
+	"}\n";
+
+// fragments outside of the lane are dropped, which clips each lane without a scissor rectangle per lane
+const char *GLSignalRenderer::signalFragmentShader=
+	"varying vec4 vColor;\n"
+	"varying float vLaneY;\n"
+	"void main()\n"
+	"{\n"
+	"	if(abs(vLaneY)>1.0) discard;\n"
+	"	gl_FragColor= vColor;\n"
+	"}\n";
+
+const char *GLSignalRenderer::lineVertexShader=
+	"attribute vec2 aPosition;\n"
+	"attribute vec4 aColor;\n"
+	"uniform vec2 uScreen;\n"
+	"varying vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"	vColor= aColor;\n"
+	"	gl_Position= vec4(aPosition.x*2.0/uScreen.x-1.0, 1.0-aPosition.y*2.0/uScreen.y, 0.0, 1.0);\n"
+	"}\n";
+
+const char *GLSignalRenderer::lineFragmentShader=
+	"varying vec4 vColor;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor= vColor;\n"
+	"}\n";
+
+// aVertex: position in window coordinates, texture coordinates
+const char *GLSignalRenderer::textureVertexShader=
+	"attribute vec4 aVertex;\n"
+	"uniform vec2 uScreen;\n"
+	"varying vec2 vTexCoord;\n"
+	"void main()\n"
+	"{\n"
+	"	vTexCoord= aVertex.zw;\n"
+	"	gl_Position= vec4(aVertex.x*2.0/uScreen.x-1.0, 1.0-aVertex.y*2.0/uScreen.y, 0.0, 1.0);\n"
+	"}\n";
+
+const char *GLSignalRenderer::textureFragmentShader=
+	"uniform sampler2D uTexture;\n"
+	"varying vec2 vTexCoord;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_FragColor= texture2D(uTexture, vTexCoord);\n"
+	"}\n";
+
+// aPoint: x and y, serial number of the point modulo 2^24, which floats hold exactly
+// uArea: center of the plot, pixels from the center to +-1, scaling of the values
+// uAge: serial of the newest point, fading per point, point size
+const char *GLSignalRenderer::pointVertexShader=
+	"attribute vec3 aPoint;\n"
+	"uniform vec4 uArea;\n"
+	"uniform vec4 uAge;\n"
+	"uniform vec2 uScreen;\n"
+	"varying vec2 vPlot;\n"
+	"varying float vIntensity;\n"
+	"void main()\n"
+	"{\n"
+	"	float age= uAge.x-aPoint.z;\n"
+	"	if(age<0.0) age+= 16777216.0;\n"
+	"	vIntensity= exp(-age*uAge.y);\n"
+	"	vPlot= aPoint.xy*uArea.w;\n"
+	"	vec2 pos= vec2(uArea.x+vPlot.x*uArea.z, uArea.y-vPlot.y*uArea.z);\n"
+	"	gl_Position= vec4(pos.x*2.0/uScreen.x-1.0, 1.0-pos.y*2.0/uScreen.y, 0.0, 1.0);\n"
+	"	gl_PointSize= uAge.z;\n"
+	"}\n";
+
+// points outside of the plot square are dropped
+const char *GLSignalRenderer::pointFragmentShader=
+	"uniform vec4 uColor;\n"
+	"varying vec2 vPlot;\n"
+	"varying float vIntensity;\n"
+	"void main()\n"
+	"{\n"
+	"	if(abs(vPlot.x)>1.0 || abs(vPlot.y)>1.0) discard;\n"
+	"	gl_FragColor= vec4(uColor.rgb, uColor.a*vIntensity);\n"
+	"}\n";
+
+// scrolling spectrogram of each channel. every channel has a ring texture holding one waterfall row per
+// texel row. a new row is written over the oldest one with a single glTexSubImage2D, and the texture
+// coordinates are shifted so that the newest row is drawn at the top of the lane, so nothing else has to
+// be uploaded or redrawn. the levels of all rows are kept as well, for the cursor readout and for
+// recoloring the textures when the color map changes.
+class WaterfallDisplay
+{
+	public:
+		enum ColorMap
+		{
+			CM_HEAT= 0,
+			CM_VIRIDIS,
+			CM_PHOSPHOR,
+			CM_GRAY,
+			CM_COUNT
+		};
+
+		WaterfallDisplay(): width(0), nChannels(0), textureWidth(0), nRows(0), writeRow(0), rowsWritten(0),
+			colorMap(-1), texturesValid(false)
+		{
+			setColorMap(CM_HEAT);
+		}
+
+		void setColorMap(int map)
+		{
+			map= (map<0 || map>=CM_COUNT? CM_HEAT: map);
+			if(map==colorMap) return;
+			colorMap= map;
+			buildColorMap(colorMap, colors);
+			texturesValid= false;
+		}
+
+		// start over with empty rows
+		void clear()
+		{
+			fill(levels.begin(), levels.end(), 0);
+			rowsWritten= 0;
+			texturesValid= false;
+		}
+
+		// add the newest row. at least minRows rows are kept, to fill the lanes. needs a current GL context.
+		void addRow(const SpectrumRow &row, uint32_t minRows)
+		{
+			if(!row.width || !row.nChannels) return;
+			if(row.width!=width || row.nChannels!=nChannels || minRows>nRows)
+			{
+				width= row.width;
+				nChannels= row.nChannels;
+				textureWidth= nRows= MINROWS;
+				while(textureWidth<width) textureWidth*= 2;
+				while(nRows<minRows && nRows<MAXROWS) nRows*= 2;
+				levels.assign(size_t(nRows)*width*nChannels, 0);
+				writeRow= rowsWritten= 0;
+				texturesValid= false;
+			}
+			memcpy(&levels[size_t(writeRow)*width*nChannels], &row.levels[0], size_t(width)*nChannels);
+			if(texturesValid)
+			{
+				pixels.resize(width);
+				for(unsigned ch= 0; ch<nChannels; ch++)
+				{
+					convertRow(ch, writeRow, &pixels[0]);
+					glBindTexture(GL_TEXTURE_2D, textures[ch]);
+					glTexSubImage2D(GL_TEXTURE_2D, 0, 0, writeRow, width, 1, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+				}
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+			writeRow= (writeRow+1)&(nRows-1);
+			rowsWritten++;
+		}
+
+		// draw the first nLanes channels, one row per pixel, the newest row at the top. without a renderer,
+		// the fixed function pipeline is used.
+		void draw(GLSignalRenderer *renderer, float x, float y, float laneWidth, float laneHeight, unsigned nLanes)
+		{
+			if(!nRows) return;
+			if(!texturesValid) uploadTextures();
+			nLanes= min(nLanes, nChannels);
+			float s1= float(width)/textureWidth, t0= float(writeRow)/nRows, t1= (writeRow-laneHeight)/nRows;
+			if(!renderer)
+			{
+				glEnable(GL_TEXTURE_2D);
+				glColor4f(1,1,1,1);
+			}
+			for(unsigned lane= 0; lane<nLanes; lane++)
+			{
+				float top= y + laneHeight*lane;
+				if(renderer)
+				{
+					renderer->drawTexture(textures[lane], x, top, laneWidth, laneHeight, 0, t0, s1, t1);
+					continue;
+				}
+				glBindTexture(GL_TEXTURE_2D, textures[lane]);
+				glBegin(GL_QUADS);
+				glTexCoord2f(0, t0); glVertex2f(x, top);
+				glTexCoord2f(s1, t0); glVertex2f(x+laneWidth, top);
+				glTexCoord2f(s1, t1); glVertex2f(x+laneWidth, top+laneHeight);
+				glTexCoord2f(0, t1); glVertex2f(x, top+laneHeight);
+				glEnd();
+			}
+			if(!renderer)
+			{
+				glBindTexture(GL_TEXTURE_2D, 0);
+				glDisable(GL_TEXTURE_2D);
+			}
+		}
+
+		// level 0..255 of a column in the row added rowsAgo rows before the newest one, -1 if there is none
+		int getLevel(unsigned channel, uint32_t column, uint32_t rowsAgo)
+		{
+			if(channel>=nChannels || column>=width || rowsAgo>=min(rowsWritten, nRows)) return -1;
+			uint32_t row= (writeRow-1-rowsAgo)&(nRows-1);
+			return levels[(size_t(row)*nChannels+channel)*width+column];
+		}
+
+	private:
+		enum { MINROWS= 64, MAXROWS= 1024 };
+		uint32_t width;
+		unsigned nChannels;
+		uint32_t textureWidth, nRows;       // powers of two, so that the rows can wrap around
+		uint32_t writeRow;
+		uint32_t rowsWritten;
+		int colorMap;
+		uint32_t colors[256];               // RGBA bytes of each level, in memory order
+		vector<uint8_t> levels;             // nRows rows, each with the columns of all channels
+		vector<uint32_t> pixels;
+		vector<GLuint> textures;
+		bool texturesValid;
+
+	public:
+		// RGBA bytes of the 256 levels of a ColorMap, in memory order
+		static void buildColorMap(int colorMap, uint32_t *colors)
+		{
+			// level, red, green, blue
+			static const float heat[][4]= { {0,0,0,0}, {.3,.5,0,0}, {.6,1,.5,0}, {.85,1,1,.3}, {1,1,1,1} },
+				viridis[][4]= { {0,.267,.005,.329}, {.25,.229,.322,.546}, {.5,.128,.567,.551}, {.75,.369,.789,.383}, {1,.993,.906,.144} },
+				phosphor[][4]= { {0,0,0,0}, {.5,.05,.5,.1}, {.85,.1,1,.25}, {1,.8,1,.8} },
+				gray[][4]= { {0,0,0,0}, {1,1,1,1} };
+			static const struct { const float (*points)[4]; int nPoints; } maps[CM_COUNT]=
+			{
+				{ heat, 5 }, { viridis, 5 }, { phosphor, 4 }, { gray, 2 }
+			};
+			const float (*points)[4]= maps[colorMap].points;
+			for(int i= 0, p= 0; i<256; i++)
+			{
+				float level= i/255.0f;
+				while(p+2<maps[colorMap].nPoints && level>points[p+1][0]) p++;
+				float f= (level-points[p][0])/(points[p+1][0]-points[p][0]);
+				uint8_t rgba[4]= { 0, 0, 0, 255 };
+				for(int c= 0; c<3; c++)
+					rgba[c]= uint8_t((points[p][c+1] + (points[p+1][c+1]-points[p][c+1])*f)*255+.5f);
+				memcpy(&colors[i], rgba, 4);
+			}
+		}
+
+	private:
+		void convertRow(unsigned channel, uint32_t row, uint32_t *dest)
+		{
+			const uint8_t *src= &levels[(size_t(row)*nChannels+channel)*width];
+			for(uint32_t i= 0; i<width; i++)
+				dest[i]= colors[src[i]];
+		}
+
+		// (re)create the textures from the levels
+		void uploadTextures()
+		{
+			if(textures.size()<nChannels)
+			{
+				size_t first= textures.size();
+				textures.resize(nChannels);
+				glGenTextures(nChannels-first, &textures[first]);
+			}
+			pixels.assign(size_t(textureWidth)*nRows, colors[0]);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				for(uint32_t row= 0; row<nRows; row++)
+					convertRow(ch, row, &pixels[size_t(row)*textureWidth]);
+				glBindTexture(GL_TEXTURE_2D, textures[ch]);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, nRows, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+			texturesValid= true;
+		}
+};
+
+// draws the images of the persistence display, one texture per channel stretched over its lane, through
+// one of the waterfall's color maps
+class PhosphorDisplay
+{
+	public:
+		PhosphorDisplay(): width(0), rows(0), nChannels(0), textureWidth(0), textureRows(0), colorMap(-1), serial(0)
+		{
+			setColorMap(WaterfallDisplay::CM_HEAT);
+		}
+
+		void setColorMap(int map)
+		{
+			map= (map<0 || map>=WaterfallDisplay::CM_COUNT? WaterfallDisplay::CM_HEAT: map);
+			if(map==colorMap) return;
+			colorMap= map;
+			WaterfallDisplay::buildColorMap(colorMap, colors);
+			serial= 0;
+		}
+
+		// upload a new frame, unless it is already there. needs a current GL context.
+		void update(const PhosphorFrame &frame)
+		{
+			if(!frame.width || !frame.rows || !frame.nChannels || frame.serial==serial) return;
+			serial= frame.serial;
+			bool resize= (frame.width>textureWidth || frame.rows>textureRows || frame.nChannels>textures.size());
+			width= frame.width;
+			rows= frame.rows;
+			nChannels= frame.nChannels;
+			if(resize)
+			{
+				textureWidth= textureRows= 64;
+				while(textureWidth<width) textureWidth*= 2;
+				while(textureRows<rows) textureRows*= 2;
+				if(textures.size()<nChannels)
+				{
+					size_t first= textures.size();
+					textures.resize(nChannels);
+					glGenTextures(nChannels-first, &textures[first]);
+				}
+				for(unsigned ch= 0; ch<textures.size(); ch++)
+				{
+					glBindTexture(GL_TEXTURE_2D, textures[ch]);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+					glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureRows, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+				}
+			}
+			size_t n= size_t(width)*rows;
+			pixels.resize(n);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				const uint8_t *levels= frame.getChannel(ch);
+				for(size_t i= 0; i<n; i++)
+					pixels[i]= colors[levels[i]];
+				glBindTexture(GL_TEXTURE_2D, textures[ch]);
+				glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+			}
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		// draw the first nLanes channels. without a renderer, the fixed function pipeline is used.
+		void draw(GLSignalRenderer *renderer, float x, float y, float laneWidth, float laneHeight, unsigned nLanes)
+		{
+			if(!width) return;
+			nLanes= min(nLanes, nChannels);
+			float s1= float(width)/textureWidth, t1= float(rows)/textureRows;
+			if(!renderer)
+			{
+				glEnable(GL_TEXTURE_2D);
+				glColor4f(1,1,1,1);
+			}
+			for(unsigned lane= 0; lane<nLanes; lane++)
+			{
+				float top= y + laneHeight*lane;
+				if(renderer)
+				{
+					renderer->drawTexture(textures[lane], x, top, laneWidth, laneHeight, 0, 0, s1, t1);
+					continue;
+				}
+				glBindTexture(GL_TEXTURE_2D, textures[lane]);
+				glBegin(GL_QUADS);
+				glTexCoord2f(0, 0); glVertex2f(x, top);
+				glTexCoord2f(s1, 0); glVertex2f(x+laneWidth, top);
+				glTexCoord2f(s1, t1); glVertex2f(x+laneWidth, top+laneHeight);
+				glTexCoord2f(0, t1); glVertex2f(x, top+laneHeight);
+				glEnd();
+			}
+			if(!renderer)
+			{
+				glBindTexture(GL_TEXTURE_2D, 0);
+				glDisable(GL_TEXTURE_2D);
+			}
+		}
+
+	private:
+		uint32_t width, rows;
+		unsigned nChannels;
+		uint32_t textureWidth, textureRows;     // powers of two
+		int colorMap;
+		uint32_t colors[256];
+		uint32_t serial;                        // of the frame in the textures
+		vector<uint32_t> pixels;
+		vector<GLuint> textures;
+};
+
+// the points of the XY display and the goniometer. the points from the processor are kept in a ring with
+// their serial numbers, and the renderer's point buffer mirrors the ring, so every point is uploaded once.
+// with additive blending, the points pile up where the trace spends its time, and they fade with their age.
+class XYDisplay
+{
+	public:
+		enum { CAPACITY= 1<<18 };
+
+		XYDisplay(): points(size_t(CAPACITY)*3), serial(0), uploadedSerial(0), uploadValid(false)
+		{ }
+
+		void clear()
+		{
+			serial= uploadedSerial= 0;
+			uploadValid= false;
+		}
+
+		// move the new points out of the processor's queue
+		void readPoints(SampleRingBuffer &queue)
+		{
+			jack_default_audio_sample_t *channels[2];
+			uint32_t n;
+			while( (n= queue.getReadPointers(channels)) )
+			{
+				for(uint32_t i= 0; i<n; i++, serial++)
+				{
+					float *p= &points[size_t(serial&(CAPACITY-1))*3];
+					p[0]= channels[0][i];
+					p[1]= channels[1][i];
+					p[2]= float(serial&0xFFFFFF);
+				}
+				queue.commitRead(n);
+			}
+		}
+
+		// points that were queued for another mode
+		void skipPoints(SampleRingBuffer &queue)
+		{ queue.commitRead(queue.getReadSpace()); }
+
+		// draw the points into the square of radius pixels around cx, cy. the points fade to 1/e over
+		// fadePoints points, 0 shows all points in the ring without fading. without a renderer, the fixed
+		// function pipeline is used.
+		void draw(GLSignalRenderer *renderer, float cx, float cy, float radius, float scale, float fadePoints)
+		{
+			// older points than 5 times the fading are left out, they are at less than 1% intensity
+			uint32_t n= min(serial, uint32_t(CAPACITY));
+			if(fadePoints>0) n= uint32_t(min(double(n), ceil(fadePoints*5.0)));
+			if(!n) return;
+			float decay= (fadePoints>0? 1/fadePoints: 0), alpha= .35;
+			uint32_t first= (serial-n)&(CAPACITY-1), newest= serial-1;
+			if(renderer)
+			{
+				upload(renderer);
+				renderer->drawPoints(first, n, float(newest&0xFFFFFF), decay, cx, cy, radius, scale, 2, alpha);
+				return;
+			}
+			glPointSize(2);
+			glBegin(GL_POINTS);
+			for(uint32_t i= 0; i<n; i++)
+			{
+				const float *p= &points[size_t((first+i)&(CAPACITY-1))*3];
+				float x= p[0]*scale, y= p[1]*scale;
+				if(fabs(x)>1 || fabs(y)>1) continue;
+				glColor4f(.1,1,.25, alpha*exp(-float(n-1-i)*decay));
+				glVertex2f(cx+x*radius, cy-y*radius);
+			}
+			glEnd();
+			glPointSize(1);
+		}
+
+	private:
+		vector<float> points;       // x, y and serial of each point
+		uint32_t serial;            // of the next point, its position in the ring is serial%CAPACITY
+		uint32_t uploadedSerial;    // the points before this one are in the renderer's buffer
+		bool uploadValid;
+
+		void upload(GLSignalRenderer *renderer)
+		{
+			uint32_t newPoints= serial-uploadedSerial;
+			if(!uploadValid || newPoints>=CAPACITY)
+				renderer->uploadPoints(CAPACITY, 0, &points[0], CAPACITY);
+			else if(newPoints)
+			{
+				uint32_t first= uploadedSerial&(CAPACITY-1), n1= min(newPoints, CAPACITY-first);
+				renderer->uploadPoints(CAPACITY, first, &points[size_t(first)*3], n1);
+				if(n1<newPoints)
+					renderer->uploadPoints(CAPACITY, 0, &points[0], newPoints-n1);
+			}
+			uploadedSerial= serial;
+			uploadValid= true;
+		}
+};
+
+// the scope settings which are stored in the config file, and the controls for them. every change is
+// passed on to the processor. the oscilloscope window is built on this; without a GUI, it can be used
+// on its own to run the processing engine.
+class ScopeControl: public configOptionHandler
+{
+	public:
+		ScopeControl(ScopeProcessor &myProcessor):
+			configOptionHandler("OscWindow"),
+			processor(myProcessor),
+			nChannels(2), triggerLevel(0.2), triggerEnabled(true), triggerPositive(true),
+			triggerType(TriggerSettings::TT_EDGE), triggerMode(TriggerSettings::TM_NORMAL), triggerSource(0),
+			triggerHysteresis(0), triggerHoldoff(0), triggerPulseWidth(0.001), triggerRuntLevel(0.5), triggerPosition(0),
+			triggerArmCount(0), peakEnvelope(false), sincInterpolation(false), spectrumView(false), waterfallView(false), fftSize(4096), fftWindow(SpectrumSettings::W_HANN),
+			fftOverlap(0.5), fftAverages(4), spectrumRange(120), filterType(FilterSettings::FT_OFF), lowpassFrequency(1000),
+			highpassFrequency(100), dcRemoval(false), filterTriggerOnly(false), decimation(1), phosphorView(false),
+			phosphorPersistence(0.5), phosphorRows(256), phosphorRange(1), xyMode(XYSettings::XY_OFF), xyInputX(0), xyInputY(1),
+			measurements(false), maskTest(false), segments(0), segmentArmCount(0), samplingRate(48000), displaySamples(0), columns(0)
+		{
+			setDisplayTime(0.01);
+
+			addConfigOption("channels", &nChannels);
+			ADD_CONFIG_OPTION(displayTime);
+			ADD_CONFIG_OPTION(triggerLevel);
+			ADD_CONFIG_OPTION(triggerPositive);
+			ADD_CONFIG_OPTION(triggerEnabled);
+			ADD_CONFIG_OPTION(triggerType);
+			ADD_CONFIG_OPTION(triggerMode);
+			ADD_CONFIG_OPTION(triggerSource);
+			ADD_CONFIG_OPTION(triggerHysteresis);
+			ADD_CONFIG_OPTION(triggerHoldoff);
+			ADD_CONFIG_OPTION(triggerPulseWidth);
+			ADD_CONFIG_OPTION(triggerRuntLevel);
+			ADD_CONFIG_OPTION(triggerPosition);
+			ADD_CONFIG_OPTION(peakEnvelope);
+			ADD_CONFIG_OPTION(sincInterpolation);
+			ADD_CONFIG_OPTION(spectrumView);
+			ADD_CONFIG_OPTION(waterfallView);
+			ADD_CONFIG_OPTION(fftSize);
+			ADD_CONFIG_OPTION(fftWindow);
+			ADD_CONFIG_OPTION(fftOverlap);
+			ADD_CONFIG_OPTION(fftAverages);
+			ADD_CONFIG_OPTION(spectrumRange);
+			ADD_CONFIG_OPTION(filterType);
+			ADD_CONFIG_OPTION(lowpassFrequency);
+			ADD_CONFIG_OPTION(highpassFrequency);
+			ADD_CONFIG_OPTION(dcRemoval);
+			ADD_CONFIG_OPTION(filterTriggerOnly);
+			ADD_CONFIG_OPTION(decimation);
+			ADD_CONFIG_OPTION(phosphorView);
+			ADD_CONFIG_OPTION(phosphorPersistence);
+			ADD_CONFIG_OPTION(xyMode);
+			ADD_CONFIG_OPTION(xyInputX);
+			ADD_CONFIG_OPTION(xyInputY);
+			ADD_CONFIG_OPTION(measurements);
+			ADD_CONFIG_OPTION(maskTest);
+			ADD_CONFIG_OPTION(segments);
+		}
+
+		// the longest display time in seconds
+		enum { MAX_DISPLAY_TIME= 10 };
+
+		void setDisplayTime(double time)
+		{ setDisplaySamples(int(time*samplingRate)); }
+
+		double getDisplayTime()
+		{ return displayTime; }
+
+		void setDisplaySamples(int nFrames)
+		{
+			if(nFrames<10) nFrames= 10;
+			else if(nFrames>samplingRate*MAX_DISPLAY_TIME) nFrames= samplingRate*MAX_DISPLAY_TIME;
+			displaySamples= nFrames;
+			displayTime= double(nFrames)/samplingRate;
+			updateProcessorSettings();
+		}
+
+		void enableTrigger(bool enabled)
+		{ triggerEnabled= enabled; updateProcessorSettings(); }
+
+		void setTriggerLevel(float level)
+		{ triggerLevel= level; updateProcessorSettings(); }
+
+		void setTriggerDir(bool positive)
+		{ triggerPositive= positive; updateProcessorSettings(); }
+
+		// one of TriggerSettings::Type
+		void setTriggerType(int type)
+		{ triggerType= type; updateProcessorSettings(); }
+
+		int getTriggerType()
+		{ return triggerType; }
+
+		// one of TriggerSettings::Mode
+		void setTriggerMode(int mode)
+		{ triggerMode= mode; updateProcessorSettings(); }
+
+		int getTriggerMode()
+		{ return triggerMode; }
+
+		// re-arm the trigger in single shot mode
+		void armSingleShot()
+		{ triggerArmCount++; updateProcessorSettings(); }
+
+		void setTriggerSource(int channel)
+		{ triggerSource= channel; updateProcessorSettings(); }
+
+		int getTriggerSource()
+		{ return getTriggerSourceChannel(); }
+
+		void setTriggerHysteresis(float hysteresis)
+		{ triggerHysteresis= hysteresis; updateProcessorSettings(); }
+
+		float getTriggerHysteresis()
+		{ return triggerHysteresis; }
+
+		void setTriggerHoldoff(float holdoff)
+		{ triggerHoldoff= holdoff; updateProcessorSettings(); }
+
+		float getTriggerHoldoff()
+		{ return triggerHoldoff; }
+
+		void setTriggerPulseWidth(float width)
+		{ triggerPulseWidth= width; updateProcessorSettings(); }
+
+		float getTriggerPulseWidth()
+		{ return triggerPulseWidth; }
+
+		void setTriggerRuntLevel(float level)
+		{ triggerRuntLevel= level; updateProcessorSettings(); }
+
+		float getTriggerRuntLevel()
+		{ return triggerRuntLevel; }
+
+		// fraction of the display before the trigger event
+		void setTriggerPosition(float position)
+		{ triggerPosition= position; updateProcessorSettings(); }
+
+		float getTriggerPosition()
+		{ return triggerPosition; }
+
+		int getNumChannels()
+		{ return nChannels; }
+
+		void setNumChannels(int n)
+		{
+			nChannels= (n<1? 1: n>MAXCHANNELS? MAXCHANNELS: n);
+			updateProcessorSettings();
+		}
+
+		enum { MAXCHANNELS= 256 };
+
+		// also re-applies the display time, which may have been changed by reading the config file
+		void setSamplingRate(float s)
+		{ samplingRate= s; setDisplayTime(displayTime); }
+
+		bool isTriggerEnabled()
+		{ return triggerEnabled; }
+
+		// zoomed out display shows the filtered peak envelope instead of min/max bars
+		void enablePeakEnvelope(bool enabled)
+		{ peakEnvelope= enabled; updateProcessorSettings(); }
+
+		bool isPeakEnvelopeEnabled()
+		{ return peakEnvelope; }
+
+		// zoomed in line display is interpolated with a windowed sinc instead of linearly
+		void enableSincInterpolation(bool enabled)
+		{ sincInterpolation= enabled; updateProcessorSettings(); }
+
+		bool isSincInterpolationEnabled()
+		{ return sincInterpolation; }
+
+		// show the spectra of the channels instead of the signals
+		void enableSpectrum(bool enabled)
+		{ spectrumView= enabled; updateProcessorSettings(); }
+
+		bool isSpectrumEnabled()
+		{ return spectrumView; }
+
+		// show a scrolling spectrogram of the channels
+		void enableWaterfall(bool enabled)
+		{ waterfallView= enabled; updateProcessorSettings(); }
+
+		bool isWaterfallEnabled()
+		{ return waterfallView; }
+
+		// transform size in frames, rounded up to a power of two
+		void setFFTSize(int size)
+		{ fftSize= size; updateProcessorSettings(); }
+
+		int getFFTSize()
+		{ return getSpectrumSettings().fftSize; }
+
+		// one of SpectrumSettings::Window
+		void setFFTWindow(int window)
+		{ fftWindow= window; updateProcessorSettings(); }
+
+		int getFFTWindow()
+		{ return getSpectrumSettings().window; }
+
+		// one of FilterSettings::Type
+		void setFilterType(int type)
+		{ filterType= type; updateProcessorSettings(); }
+
+		int getFilterType()
+		{ return getFilterSettings().type; }
+
+		void setLowpassFrequency(float f)
+		{ lowpassFrequency= f; updateProcessorSettings(); }
+
+		float getLowpassFrequency()
+		{ return lowpassFrequency; }
+
+		void setHighpassFrequency(float f)
+		{ highpassFrequency= f; updateProcessorSettings(); }
+
+		float getHighpassFrequency()
+		{ return highpassFrequency; }
+
+		void enableDCRemoval(bool enabled)
+		{ dcRemoval= enabled; updateProcessorSettings(); }
+
+		// filter only the signal the trigger sees
+		void setFilterTriggerOnly(bool triggerOnly)
+		{ filterTriggerOnly= triggerOnly; updateProcessorSettings(); }
+
+		bool isFilterTriggerOnly()
+		{ return filterTriggerOnly; }
+
+		void setDecimation(int factor)
+		{ decimation= factor; updateProcessorSettings(); }
+
+		// accumulate the sweeps in an intensity graded persistence display
+		void enablePhosphor(bool enabled)
+		{ phosphorView= enabled; updateProcessorSettings(); }
+
+		bool isPhosphorEnabled()
+		{ return phosphorView; }
+
+		// seconds for the persistence display and the XY points to fade to 1/e, 0 for infinite persistence
+		void setPhosphorPersistence(float seconds)
+		{ phosphorPersistence= seconds; updateProcessorSettings(); }
+
+		float getPhosphorPersistence()
+		{ return phosphorPersistence; }
+
+		// one of XYSettings::Mode
+		void setXYMode(int mode)
+		{ xyMode= mode; updateProcessorSettings(); }
+
+		int getXYMode()
+		{ return (xyMode<0 || xyMode>XYSettings::XY_GONIOMETER? XYSettings::XY_OFF: xyMode); }
+
+		// the channels plotted against each other, or the left and right channel of the goniometer
+		void setXYInputs(int x, int y)
+		{ xyInputX= x; xyInputY= y; updateProcessorSettings(); }
+
+		int getXYInputX()
+		{ return clampChannel(xyInputX); }
+
+		int getXYInputY()
+		{ return clampChannel(xyInputY); }
+
+		// measure each channel and show the results over its lane
+		void enableMeasurements(bool enabled)
+		{ measurements= enabled; updateProcessorSettings(); }
+
+		bool isMeasurementsEnabled()
+		{ return measurements; }
+
+		// test each sweep against the mask, if one has been loaded. the counts start over when it is enabled.
+		void enableMaskTest(bool enabled)
+		{ maskTest= enabled; updateProcessorSettings(); }
+
+		bool isMaskTestEnabled()
+		{ return maskTest; }
+
+		// number of sweeps in a sequence acquisition, 0 to turn it off
+		void setSegments(int n)
+		{ segments= max(n, 0); updateProcessorSettings(); }
+
+		int getSegments()
+		{ return segments; }
+
+		// start a new sequence
+		void armSegments()
+		{ segmentArmCount++; updateProcessorSettings(); }
+
+		// sampling rate of what is displayed, after decimation
+		float getProcessingRate()
+		{ return samplingRate/getFilterSettings().decimation; }
+
+		bool isTriggerPositive()
+		{ return triggerPositive; }
+
+		float getTriggerLevel()
+		{ return triggerLevel; }
+
+		// number of display columns, 0 if nothing is displayed
+		void setColumns(uint32_t n)
+		{ columns= n; updateProcessorSettings(); }
+
+	protected:
+		ScopeProcessor &processor;
+		int nChannels;
+		float triggerLevel;
+		bool triggerEnabled;
+		bool triggerPositive;
+		int triggerType;
+		int triggerMode;
+		int triggerSource;
+		float triggerHysteresis;
+		float triggerHoldoff;
+		float triggerPulseWidth;
+		float triggerRuntLevel;
+		float triggerPosition;
+		uint32_t triggerArmCount;
+		bool peakEnvelope;
+		bool sincInterpolation;
+		bool spectrumView;
+		bool waterfallView;
+		int fftSize;
+		int fftWindow;
+		float fftOverlap;
+		int fftAverages;
+		float spectrumRange;
+		int filterType;
+		float lowpassFrequency;
+		float highpassFrequency;
+		bool dcRemoval;
+		bool filterTriggerOnly;
+		int decimation;
+		bool phosphorView;
+		float phosphorPersistence;
+		uint32_t phosphorRows;          // lane height and value range of the display, set by the window
+		float phosphorRange;
+		int xyMode;
+		int xyInputX, xyInputY;
+		bool measurements;
+		bool maskTest;
+		int segments;
+		uint32_t segmentArmCount;
+		float samplingRate;
+		float displayTime;
+		uint32_t displaySamples;
+		uint32_t columns;
+
+		void updateProcessorSettings()
+		{
+			ScopeSettings s;
+			s.filter= getFilterSettings();
+			s.channels= nChannels;
+			s.displaySamples= max(displaySamples/s.filter.decimation, 1u);
+			s.maxDisplaySamples= uint32_t(samplingRate*MAX_DISPLAY_TIME)/s.filter.decimation;
+			s.columns= columns;
+			s.trigger.enabled= triggerEnabled;
+			s.trigger.positive= triggerPositive;
+			s.trigger.type= triggerType;
+			s.trigger.mode= triggerMode;
+			s.trigger.sourceChannel= getTriggerSourceChannel();
+			s.trigger.level= triggerLevel;
+			s.trigger.hysteresis= triggerHysteresis;
+			s.trigger.holdoff= triggerHoldoff;
+			s.trigger.pulseWidth= triggerPulseWidth;
+			s.trigger.runtLevel= triggerRuntLevel;
+			s.trigger.position= triggerPosition;
+			s.trigger.armCount= triggerArmCount;
+			s.peakEnvelope= peakEnvelope;
+			s.sincInterpolation= sincInterpolation;
+			s.samplingRate= samplingRate/s.filter.decimation;
+			s.spectrum= getSpectrumSettings();
+			s.phosphor.enabled= phosphorView;
+			s.phosphor.rows= phosphorRows;
+			s.phosphor.range= phosphorRange;
+			s.phosphor.persistence= max(phosphorPersistence, 0.0f);
+			s.xy.mode= getXYMode();
+			s.xy.xChannel= getXYInputX();
+			s.xy.yChannel= getXYInputY();
+			s.measurements= measurements;
+			s.maskTest= maskTest;
+			s.segments= max(segments, 0);
+			s.segmentArmCount= segmentArmCount;
+			processor.setSettings(s);
+		}
+
+		FilterSettings getFilterSettings()
+		{
+			FilterSettings s;
+			s.type= (filterType<0 || filterType>=FilterSettings::FT_COUNT? FilterSettings::FT_OFF: filterType);
+			s.lowpassFrequency= lowpassFrequency;
+			s.highpassFrequency= highpassFrequency;
+			s.dcRemoval= dcRemoval;
+			s.triggerOnly= filterTriggerOnly;
+			s.decimation= (decimation<1? 1: decimation>64? 64: decimation);
+			return s;
+		}
+
+		// the spectrum settings as read from the config file may be out of range
+		SpectrumSettings getSpectrumSettings()
+		{
+			SpectrumSettings s;
+			s.enabled= spectrumView || waterfallView;
+			s.waterfall= waterfallView;
+			s.fftSize= 1024;
+			while(int(s.fftSize)<fftSize && s.fftSize<65536) s.fftSize*= 2;
+			s.window= (fftWindow<0 || fftWindow>=SpectrumSettings::W_COUNT? SpectrumSettings::W_HANN: fftWindow);
+			s.overlap= (fftOverlap<0? 0: fftOverlap>0.95? 0.95: fftOverlap);
+			s.averages= max(fftAverages, 1);
+			s.range= (spectrumRange<10? 10: spectrumRange>200? 200: spectrumRange);
+			return s;
+		}
+
+		// the source channel as read from the config file may be out of range
+		unsigned getTriggerSourceChannel()
+		{ return clampChannel(triggerSource); }
+
+		unsigned clampChannel(int channel)
+		{ return (channel<0? 0: channel>=nChannels? nChannels-1: channel); }
+};
+
+class fluxOscWindow: public fluxWindowBase, public ScopeControl
+{
+	public:
+		fluxOscWindow(ScopeProcessor &myProcessor, int x, int y, int w, int h, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
+			fluxWindowBase(x,y, w,h, CB_MOUSE_FLAG|CB_PAINT_FLAG, parent, alignment),
+			ScopeControl(myProcessor),
+			verticalScaling(1.0),
+			draggingHorizScale(false), cursorPos(-1), cursorY(0), cursorChannel(0), shaderRendering(true), rendererInitialized(false),
+			history(0), browsingHistory(false), historyFollow(true), historyEnd(0), historySpan(60), historyDirty(true),
+			historyBuiltEnd(0), historySerial(0), historyDrag(HD_NONE), browsingSegments(false), selectedSegment(-1),
+			segmentCopiesSequence(0), segmentLinesSequence(0), segmentLinesCount(0), segmentLinesX(0), segmentLinesY(0), segmentLinesWidth(0), segmentLinesHeight(0), segmentLinesScaling(0),
+			segmentLinesSelected(-1), segmentLinesAlpha(0),
+			waterfallColors(WaterfallDisplay::CM_HEAT), configPane(0)
+		{
+			ADD_CONFIG_OPTION(verticalScaling);
+			ADD_CONFIG_OPTION(waterfallColors);
+		}
+
+		~fluxOscWindow()
+		{
+		}
+
+		void setConfigPane(class fluxOscWindowConfigPane *myConfigPane)
+		{
+			configPane= myConfigPane;
+		}
+
+		float getVerticalScaling()
+		{ return verticalScaling; }
+
+		void setVerticalScaling(float s)
+		{ verticalScaling= (s<0.1? 0.1: s>100? 100: s); }
+
+		// draw with shaders and vertex buffers when the GL context supports it. otherwise, or when
+		// this is disabled, the fixed function pipeline is used.
+		void enableShaderRendering(bool enabled)
+		{ shaderRendering= enabled; }
+
+		// the long-term history which can be browsed instead of the live signal
+		void setHistory(HistoryStore *h)
+		{ history= h; }
+
+		bool hasHistory()
+		{ return history; }
+
+		void browseHistory(bool enable)
+		{
+			if(!history) enable= false;
+			if(enable==browsingHistory) return;
+			browsingHistory= enable;
+			historyFollow= true;
+			historyDirty= true;
+			renderer.invalidate();
+		}
+
+		bool isBrowsingHistory()
+		{ return browsingHistory; }
+
+		enum ViewMode
+		{
+			VM_SCOPE= 0,
+			VM_SPECTRUM,
+			VM_WATERFALL,
+			VM_PHOSPHOR,
+			VM_XY,
+			VM_GONIOMETER,
+			VM_SEGMENTS,
+			VM_HISTORY
+		};
+
+		// one of ViewMode. the history view is only available with a history.
+		void setViewMode(int mode)
+		{
+			if(mode==VM_HISTORY && !history) mode= VM_SCOPE;
+			browseHistory(mode==VM_HISTORY);
+			browsingSegments= (mode==VM_SEGMENTS);
+			if((mode==VM_SPECTRUM)!=spectrumView)
+			{
+				enableSpectrum(mode==VM_SPECTRUM);
+				renderer.invalidate();
+			}
+			if((mode==VM_WATERFALL)!=waterfallView)
+			{
+				enableWaterfall(mode==VM_WATERFALL);
+				waterfall.clear();
+			}
+			if((mode==VM_PHOSPHOR)!=phosphorView)
+				enablePhosphor(mode==VM_PHOSPHOR);
+			int xy= (mode==VM_XY? XYSettings::XY_PLOT: mode==VM_GONIOMETER? XYSettings::XY_GONIOMETER: XYSettings::XY_OFF);
+			if(xy!=getXYMode())
+			{
+				setXYMode(xy);
+				xyDisplay.clear();
+				xyDisplay.skipPoints(processor.getXYPoints());
+			}
+		}
+
+		int getViewMode()
+		{
+			return browsingHistory? VM_HISTORY: browsingSegments? VM_SEGMENTS: spectrumView? VM_SPECTRUM: waterfallView? VM_WATERFALL:
+				   phosphorView? VM_PHOSPHOR: getXYMode()==XYSettings::XY_PLOT? VM_XY:
+				   getXYMode()==XYSettings::XY_GONIOMETER? VM_GONIOMETER: VM_SCOPE;
+		}
+
+		// one of WaterfallDisplay::ColorMap
+		void setWaterfallColors(int map)
+		{ waterfallColors= map; }
+
+		int getWaterfallColors()
+		{ return waterfallColors; }
+
+	private:
+		float verticalScaling;
+		bool draggingHorizScale;
+		int horizScaleClickPos;
+		int cursorPos, cursorY;
+		unsigned cursorChannel;
+		bool shaderRendering;
+		bool rendererInitialized;
+		GLSignalRenderer renderer;
+		LineBatch overlayLines, cursorMarker;
+		MaskResults maskResults;
+		HistoryStore *history;
+		bool browsingHistory;
+		bool historyFollow;         // keep the newest frames in view
+		double historyEnd;          // frame at the right edge of the view
+		double historySpan;         // seconds in view
+		bool historyDirty;
+		uint64_t historyBuiltEnd;
+		uint32_t historySerial;
+		DisplayFrame historyFrame;
+		vector<HistoryStore::Entry> historyColumns;
+		enum { HD_NONE, HD_PAN, HD_ZOOM } historyDrag;
+		int historyDragPos;
+		WaterfallDisplay waterfall;
+		SpectrumRow spectrumRow;
+		PhosphorDisplay phosphor;
+		XYDisplay xyDisplay;
+		bool browsingSegments;
+		int selectedSegment;        // the segment shown, -1 for all of them overlaid
+		LineBatch segmentLines;     // the traces of the segments view, built again when anything in it changes
+		vector<SweepCapture> segmentCopies;     // the segments of the sequence read so far
+		vector<double> segmentTimes;            // of each copy, after the first one
+		uint32_t segmentCopiesSequence;
+		uint32_t segmentLinesSequence, segmentLinesCount;
+		int segmentLinesX, segmentLinesY, segmentLinesWidth, segmentLinesHeight;
+		float segmentLinesScaling;
+		int segmentLinesSelected;
+		float segmentLinesAlpha;
+		LineBatch meterLines;
+		vector<Measurement> measurementResults;
+		int waterfallColors;
+		class fluxOscWindowConfigPane *configPane;
+
+		// the display frame of the history view. it is read from the history again when the view has
+		// changed, or when it follows the newest frames and there are new ones.
+		const DisplayFrame &getHistoryFrame(uint32_t width)
+		{
+			double rate= history->getSamplingRate();
+			uint64_t end= history->getEndFrame();
+			if(historyFollow) historyEnd= end;
+			DisplayFrame &frame= historyFrame;
+			if(!historyDirty && frame.width==width && frame.nChannels==unsigned(nChannels) &&
+			   frame.peakEnvelope==peakEnvelope && (!historyFollow || end==historyBuiltEnd))
+				return frame;
+			historyDirty= false;
+			historyBuiltEnd= end;
+			history->readColumns(historyEnd-historySpan*rate, historySpan*rate/max(width, 1u), width, historyColumns);
+
+			frame.nChannels= nChannels;
+			frame.width= width;
+			frame.resizeColumns();
+			frame.lineDisplayPeaks= true;
+			frame.peakEnvelope= peakEnvelope;
+			frame.triggerEnabled= false;
+			frame.fillColumn= (width? width-1: 0);     // no scrolling
+			frame.displayTime= historySpan;
+			for(unsigned ch= 0; ch<unsigned(nChannels); ch++)
+			{
+				for(uint32_t column= 0; column<width; column++)
+				{
+					HistoryStore::Entry e= { 0, 0, 0, 0 };
+					if(ch<history->getNumChannels()) e= historyColumns[size_t(ch)*width+column];
+					frame.setPeakColumn(ch, column, e.min, peakEnvelope? max(fabsf(e.min), fabsf(e.max)): e.max, e.rms(), peakEnvelope);
+				}
+			}
+			// every column changes, so the renderer uploads the whole frame
+			frame.serial= ++historySerial;
+			frame.changesSince= frame.serial;
+			frame.changedColumns.clear();
+			frame.changedColumns.add(0, width);
+			return frame;
+		}
+
+		// in the history view, the left button drags the view along the time axis and the right button zooms it.
+		// returns true if the event was used.
+		bool historyMouse(int type, int x, int btn)
+		{
+			if(type==MOUSE_DOWN && (btn==MOUSE_BTN1 || btn==MOUSE_BTNRIGHT))
+			{
+				historyDrag= (btn==MOUSE_BTN1? HD_PAN: HD_ZOOM);
+				historyDragPos= x;
+				cursorPos= -1;
+				wnd_set_mouse_capture(fluxHandle);
+				return true;
+			}
+			if(type==MOUSE_UP && historyDrag!=HD_NONE)
+			{
+				historyDrag= HD_NONE;
+				wnd_set_mouse_capture(NOWND);
+				return true;
+			}
+			if(type!=MOUSE_OVER || historyDrag==HD_NONE)
+				return false;
+
+			double rate= history->getSamplingRate();
+			if(historyDrag==HD_PAN)
+			{
+				historyEnd-= (x-historyDragPos)*historySpan*rate/max(wnd_getw(fluxHandle), 1);
+				uint64_t end= history->getEndFrame();
+				// dragging past the newest frames follows them again
+				historyFollow= (historyEnd>=end);
+				if(historyFollow) historyEnd= end;
+			}
+			else
+			{
+				historySpan*= exp((historyDragPos-x)*0.01);
+				historySpan= (historySpan<0.001? 0.001: historySpan>1e6? 1e6: historySpan);
+			}
+			historyDragPos= x;
+			historyDirty= true;
+			return true;
+		}
+
+		bool showingSpectrum()
+		{ return getViewMode()==VM_SPECTRUM; }
+
+		bool showingWaterfall()
+		{ return getViewMode()==VM_WATERFALL; }
+
+		bool showingPhosphor()
+		{ return getViewMode()==VM_PHOSPHOR; }
+
+		bool showingXY()
+		{ return getViewMode()==VM_XY || getViewMode()==VM_GONIOMETER; }
+
+		bool showingSegments()
+		{ return getViewMode()==VM_SEGMENTS; }
+
+		// the trace of one segment on each lane, with a min..max bar for the samples of each column
+		void addSegmentLines(LineBatch &lines, const SweepCapture &s, int x, int y, int width, int laneHeight, float alpha)
+		{
+			float scale= verticalScaling*laneHeight*.5;
+			double step= double(s.nFrames)/max(width, 1);
+			for(unsigned ch= 0; ch<s.nChannels && ch<unsigned(nChannels); ch++)
+			{
+				const jack_default_audio_sample_t *samples= s.getChannel(ch);
+				float center= y + laneHeight*ch + laneHeight*.5, prev= 0;
+				for(int column= 0; column<width; column++)
+				{
+					uint32_t begin= uint32_t(column*step), end= min(max(uint32_t((column+1)*step), begin+1), s.nFrames);
+					if(begin>=s.nFrames) break;
+					float lo= samples[begin], hi= lo;
+					for(uint32_t i= begin+1; i<end; i++)
+						lo= min(lo, samples[i]), hi= max(hi, samples[i]);
+					if(column) lines.add(x+column-1, center-prev*scale, x+column, center-samples[begin]*scale, .1,1,.2,alpha);
+					if(hi>lo) lines.add(x+column, center-hi*scale, x+column, center-lo*scale, .1,1,.2,alpha);
+					prev= samples[end-1];
+				}
+			}
+		}
+
+		// copy the segments which have been added since the last call. filled segments don't change until
+		// the sequence starts over, then the copies are dropped and read again.
+		void updateSegmentCopies()
+		{
+			uint32_t count, capacity;
+			uint32_t sequence= processor.getSegmentCount(count, capacity);
+			if(sequence!=segmentCopiesSequence)
+			{
+				segmentCopies.clear();
+				segmentTimes.clear();
+				// filling up the sequence doesn't move the copies around
+				segmentCopies.reserve(capacity);
+				segmentCopiesSequence= sequence;
+			}
+			while(segmentCopies.size()<count)
+			{
+				segmentCopies.push_back(SweepCapture());
+				segmentTimes.push_back(0);
+				if(!processor.readSegment(sequence, segmentCopies.size()-1, segmentCopies.back(), segmentTimes.back()))
+				{
+					// started over in the meantime, the next call reads the new sequence
+					segmentCopies.pop_back();
+					segmentTimes.pop_back();
+					break;
+				}
+			}
+		}
+
+		// update the lines if the segments or the view have changed. all segments are overlaid with a
+		// brightness which adds up to about full for a trace they have in common.
+		void updateSegmentLines(int x, int y, int width, int laneHeight)
+		{
+			updateSegmentCopies();
+			uint32_t count= segmentCopies.size();
+			if(selectedSegment>=int(count)) selectedSegment= int(count)-1;
+			float alpha= min(1.0f, max(2.0f/max(count, 1u), 0.15f));
+			bool sameView= (segmentCopiesSequence==segmentLinesSequence && x==segmentLinesX && y==segmentLinesY &&
+							width==segmentLinesWidth && laneHeight==segmentLinesHeight && verticalScaling==segmentLinesScaling &&
+							selectedSegment==segmentLinesSelected);
+			if(sameView && count==segmentLinesCount && !segmentLines.empty())
+				return;
+			// new segments are drawn on top of the overlay as long as the brightness stays the same
+			uint32_t first= 0;
+			if(sameView && selectedSegment<0 && alpha==segmentLinesAlpha && count>segmentLinesCount)
+				first= segmentLinesCount;
+			else
+				segmentLines.clear();
+			segmentLinesSequence= segmentCopiesSequence;
+			segmentLinesCount= count;
+			segmentLinesX= x;
+			segmentLinesY= y;
+			segmentLinesWidth= width;
+			segmentLinesHeight= laneHeight;
+			segmentLinesScaling= verticalScaling;
+			segmentLinesSelected= selectedSegment;
+			segmentLinesAlpha= alpha;
+			if(selectedSegment>=0)
+			{
+				addSegmentLines(segmentLines, segmentCopies[selectedSegment], x, y, width, laneHeight, 1);
+				return;
+			}
+			for(uint32_t i= first; i<count; i++)
+				addSegmentLines(segmentLines, segmentCopies[i], x, y, width, laneHeight, alpha);
+		}
+
+		// the segment shown, or the last one of the overlay. 0 if there is none.
+		const SweepCapture *getShownSegment() const
+		{
+			if(segmentCopies.empty()) return 0;
+			return &segmentCopies[min(size_t(max(segmentLinesSelected, 0)), segmentCopies.size()-1)];
+		}
+
+		// the XY plot is a square in the window, below the correlation meter
+		void getXYArea(const rect *absPos, float &cx, float &cy, float &radius)
+		{
+			float top= absPos->y+24, bottom= absPos->btm-8;
+			radius= max(min(float(absPos->rgt-absPos->x-16), bottom-top)*.5f, 1.0f);
+			cx= (absPos->x+absPos->rgt)*.5f;
+			cy= (top+bottom)*.5f;
+		}
+
+		// the spectrum always spans the lane height
+		float getDisplayScaling()
+		{ return showingSpectrum()? 1: verticalScaling; }
+
+		double getValueAtCursorPos(const DisplayFrame &frame)
+		{
+		    if(cursorPos<0 || cursorPos>=(int)frame.width || cursorChannel>=frame.nChannels)
+                return 0;
+            const gl2DCoords *coords= &frame.coords[frame.channelOffset(cursorChannel)];
+            if(frame.triggerEnabled)
+                return coords[cursorPos].y;
+            else
+            {
+                int offset= frame.fillColumn + cursorPos;
+                offset%= frame.width;
+                return coords[offset].y;
+            }
+		}
+
+		void updateGuiParam(void *paramAddress);
+
+        // grid lines of all lanes, in window coordinates. lanes which are too small
+        // for the full grid get fewer horizontal lines.
+        static int formatTime(char *text, size_t size, const char *label, float seconds)
+        {
+            if(seconds>=1) return snprintf(text, size, "%s %.3fs  ", label, seconds);
+            if(seconds>=1e-3) return snprintf(text, size, "%s %.3fms  ", label, seconds*1e3);
+            return snprintf(text, size, "%s %.1fus  ", label, seconds*1e6);
+        }
+
+        // one line with the results of the measurements of a channel. the period values are left out while
+        // there is no period, the rise and fall times while there are no edges.
+        static void formatMeasurement(const Measurement &m, char *text, size_t size)
+        {
+            size_t n= snprintf(text, size, "RMS %.4f  Mean %+.4f  P-P %.4f  ", m.rms, m.mean, m.peakToPeak());
+            if(m.frequency>=1000 && n<size)
+                n+= snprintf(text+n, size-n, "%.4fkHz  ", m.frequency*1e-3);
+            else if(m.frequency>0 && n<size)
+                n+= snprintf(text+n, size-n, "%.3fHz  ", m.frequency);
+            if(m.frequency>0 && n<size)
+                n+= snprintf(text+n, size-n, "Duty %.1f%%  ", m.dutyCycle*100);
+            if(m.riseTime>0 && n<size)
+                n+= formatTime(text+n, size-n, "Rise", m.riseTime);
+            if(m.fallTime>0 && n<size)
+                n+= formatTime(text+n, size-n, "Fall", m.fallTime);
+        }
+
+        // frame, axes and graticule of the XY plot. the goniometer has the left and right axes on the diagonals.
+        void addXYGridLines(LineBatch &lines, float cx, float cy, float radius, bool goniometer)
+        {
+            float l= cx-radius, r= cx+radius, t= cy-radius, b= cy+radius;
+            lines.add(l, t, r, t, .5,.5,.5,1);
+            lines.add(r, t, r, b, .5,.5,.5,1);
+            lines.add(r, b, l, b, .5,.5,.5,1);
+            lines.add(l, b, l, t, .5,.5,.5,1);
+            for(int i= 1; i<8; i++)
+            {
+                float d= radius*(i-4)/4;
+                lines.add(cx+d, t, cx+d, b, 1,1,1, i==4? .5: .2);
+                lines.add(l, cy+d, r, cy+d, 1,1,1, i==4? .5: .2);
+            }
+            if(goniometer)
+            {
+                lines.add(l, t, r, b, 1,1,1,.3);
+                lines.add(r, t, l, b, 1,1,1,.3);
+            }
+        }
+
+        // correlation meter from -1 at the left to +1 at the right, above the XY plot
+        void addCorrelationMeter(LineBatch &lines, LineBatch &bar, float cx, float radius, float y, float correlation)
+        {
+            lines.add(cx-radius, y, cx+radius, y, .5,.5,.5,1);
+            for(int i= 0; i<=4; i++)
+            {
+                float tx= cx+radius*(i-2)/2;
+                lines.add(tx, y-5, tx, y+5, 1,1,1, i==2? .6: .3);
+            }
+            // green for signals in phase, red for those out of phase, which would cancel in mono
+            if(correlation>=0)
+                bar.add(cx, y, cx+radius*correlation, y, .1,1,.25,.8);
+            else
+                bar.add(cx+radius*correlation, y, cx, y, 1,.2,.1,.8);
+        }
+
+        void addGridLines(LineBatch &lines, int x, int y, int width, int laneHeight, unsigned nLanes, int steps= 16)
+        {
+            int hSteps= (laneHeight>=64? steps: laneHeight>=16? 4: 2);
+            int height= laneHeight*nLanes;
+
+            for(unsigned lane= 0; lane<nLanes; lane++)
+            {
+                float top= y + laneHeight*lane;
+
+                // lane separator
+                lines.add(x, top, x+width, top, .5,.5,.5,1);
+
+                // horizontal segments
+                for(int i= 1; i<hSteps; i++)
+                {
+                    float ly= top + float(laneHeight)*i/hSteps;
+                    lines.add(x, ly, x+width, ly, 1,1,1, (i&1)? .2: .3);
+                }
+
+                // center line
+                lines.add(x, top + laneHeight*.5, x+width, top + laneHeight*.5, 1,1,1,.5);
+            }
+
+            // vertical segments across all lanes
+            for(int i= 1; i<steps; i++)
+            {
+                float lx= x + float(width)*i/steps;
+                lines.add(lx, y, lx, y+height, 1,1,1, (i&1)? .2: .3);
+            }
+        }
+
+        // grid of the spectrum views: a vertical line at 1, 2 and 5 times each power of ten on the log
+        // frequency axis, and with levels, a horizontal one every 10dB
+        void addSpectrumGridLines(LineBatch &lines, int x, int y, int width, int laneHeight, unsigned nLanes, bool levels)
+        {
+            SpectrumSettings s= getSpectrumSettings();
+            double fMax= SpectrumAnalyzer::getColumnFrequency(width-1, width, getProcessingRate());
+            double logRange= log(fMax/SpectrumAnalyzer::MINFREQUENCY);
+            int height= laneHeight*nLanes;
+
+            for(unsigned lane= 0; lane<nLanes; lane++)
+            {
+                float top= y + laneHeight*lane;
+                lines.add(x, top, x+width, top, .5,.5,.5,1);
+                for(int db= 10; levels && db<s.range; db+= 10)
+                {
+                    float ly= top + laneHeight*db/s.range;
+                    if(laneHeight>=64 || !(db%20))
+                        lines.add(x, ly, x+width, ly, 1,1,1, (db%20)? .2: .3);
+                }
+            }
+
+            for(double decade= 1; decade<fMax; decade*= 10)
+            {
+                static const int steps[]= { 1, 2, 5 };
+                for(int i= 0; i<3; i++)
+                {
+                    double f= decade*steps[i];
+                    if(f<=SpectrumAnalyzer::MINFREQUENCY || f>=fMax) continue;
+                    float lx= x + (width-1)*log(f/SpectrumAnalyzer::MINFREQUENCY)/logRange;
+                    lines.add(lx, y, lx, y+height, 1,1,1, i? .2: .4);
+                }
+            }
+        }
+
+        // trigger level, runt level and trigger point on the lane of the trigger source
+        void addTriggerLines(LineBatch &lines, const DisplayFrame &frame, int x, int y, int width, int laneHeight)
+        {
+            float top= y + laneHeight*getTriggerSourceChannel(), center= top + laneHeight*.5;
+            float levelY= center - triggerLevel*verticalScaling*laneHeight*.5,
+                  runtY= center - triggerRuntLevel*verticalScaling*laneHeight*.5;
+            if(levelY>=top && levelY<=top+laneHeight)
+                lines.add(x, levelY, x+width, levelY, 0,1,1,.5);
+            if(triggerType==TriggerSettings::TT_RUNT && runtY>=top && runtY<=top+laneHeight)
+                lines.add(x, runtY, x+width, runtY, 0,1,1,.25);
+            if(frame.triggerEnabled)
+            {
+                float tx= x + frame.triggerPosition*width;
+                lines.add(tx, top, tx, top+laneHeight, 0,1,1,.3);
+            }
+        }
+
+        // the upper and lower limits of the mask on each lane which has them
+        void addMaskLines(LineBatch &lines, const Mask &mask, int x, int y, int width, int laneHeight)
+        {
+            float scale= verticalScaling*laneHeight*.5;
+            for(unsigned lane= 0; lane<unsigned(nChannels); lane++)
+            {
+                const vector<Mask::Point> *points= mask.getPoints(lane);
+                if(!points) continue;
+                float top= y + laneHeight*lane, center= top + laneHeight*.5;
+                // the limits stay level before the first point and after the last one
+                const Mask::Point *prev= &points->front();
+                float prevX= x;
+                for(size_t i= 0; i<=points->size(); i++)
+                {
+                    const Mask::Point &p= (i<points->size()? (*points)[i]: points->back());
+                    float px= (i<points->size()? x + min(max(p.position, 0.0f), 1.0f)*width: x+width);
+                    for(int k= 0; k<2; k++)
+                    {
+                        float y0= center - (k? prev->upper: prev->lower)*scale, y1= center - (k? p.upper: p.lower)*scale;
+                        lines.add(prevX, min(max(y0, top), top+laneHeight), px, min(max(y1, top), top+laneHeight), 1,.15,.1,.6);
+                    }
+                    prev= &p;
+                    prevX= px;
+                }
+            }
+        }
+
+        // vertical line at the cursor position, and a cross marking the value at the cursor
+        void addCursorLines(LineBatch &lines, LineBatch &marker, const DisplayFrame &frame, int x, int y, int width, int laneHeight)
+        {
+            if(cursorPos<0 || cursorPos>=width || cursorChannel>=(unsigned)nChannels) return;
+            float top= y + laneHeight*cursorChannel, cx= x + cursorPos;
+            if(showingWaterfall() || showingXY() || showingSegments())
+            {
+                // the waterfall has levels everywhere, the cursor is a crosshair
+                lines.add(cx, top, cx, top+laneHeight, 1,.9,.2,.8);
+                lines.add(x, y+cursorY, x+width, y+cursorY, 1,.9,.2,.8);
+                return;
+            }
+            float cy= top + laneHeight*.5 - getValueAtCursorPos(frame)*getDisplayScaling()*laneHeight*.5;
+            lines.add(cx, top, cx, top+laneHeight, 1,.9,.2,.8);
+            if(cy>=top && cy<=top+laneHeight)
+            {
+                marker.add(cx-4, cy+4, cx+4, cy-4, 1,.9,.2,.8);
+                marker.add(cx+4, cy+4, cx-4, cy-4, 1,.9,.2,.8);
+            }
+        }
+
+        // draw a batch of lines, with the shader renderer if it is available
+        void paintLines(const LineBatch &lines, float lineWidth= 1, bool smooth= false)
+        {
+            if(lines.empty()) return;
+            if(useShaderRenderer())
+            {
+                renderer.drawLines(lines, lineWidth, smooth);
+                return;
+            }
+            glLineWidth(lineWidth);
+            if(smooth) glEnable(GL_LINE_SMOOTH);
+            glBegin(GL_LINES);
+            for(size_t i= 0; i<lines.vertices.size(); i++)
+            {
+                const LineBatch::Vertex &v= lines.vertices[i];
+                glColor4f(v.r, v.g, v.b, v.a);
+                glVertex2f(v.x, v.y);
+            }
+            glEnd();
+            glDisable(GL_LINE_SMOOTH);
+            glLineWidth(1);
+        }
+
+        // the renderer is set up on first use, when there is a GL context
+        bool useShaderRenderer()
+        {
+            if(!shaderRendering) return false;
+            if(!rendererInitialized)
+            {
+                rendererInitialized= true;
+                if(!renderer.init())
+                    printf("shader rendering not available, using fixed function rendering\n");
+            }
+            return renderer.isAvailable();
+        }
+
+        // set up the transformation so that a lane spans 0..1 horizontally and -1..1 vertically,
+        // and clip to it
+        void setLaneTransform(const rect *absPos, int laneHeight, unsigned lane)
+        {
+            int width= absPos->rgt - absPos->x,
+                x= absPos->x, y= absPos->y + laneHeight*lane;
+            glTranslatef(x, y + laneHeight*.5, 0);
+            glScalef(width, -laneHeight*.5, 1);
+            glScissor(x, viewport.btm-(y+laneHeight), width, laneHeight);
+        }
+
+        // draw columns [first, first+count) of a channel at x positions starting at 0.
+        // the client state for the kind of display in the frame is set up by the caller.
+        void paintColumns(const DisplayFrame &frame, int channel, int first, int count, bool rms)
+        {
+            if(count<=0) return;
+            uint32_t index= frame.channelOffset(channel)+first;
+            if(rms)
+            {
+                glVertexPointer(2, GL_FLOAT, 2*4, (void*)&frame.rmsCoords[index]);
+                glDrawArrays(GL_LINES, 0, count*2);
+            }
+            else if(frame.lineDisplayPeaks)
+            {
+                glVertexPointer(2, GL_FLOAT, 2*4, (void*)&frame.coords[index]);
+                glColorPointer(3, GL_FLOAT, 0, &frame.colors[index]);
+                glDrawArrays(GL_LINES, 0, count*2);
+                if(frame.peakEnvelope)
+                {
+                    glScalef(1, -1, 1);
+                    glDrawArrays(GL_LINES, 0, count*2);
+                    glScalef(1, -1, 1);
+                }
+            }
+            else
+            {
+                glVertexPointer(2, GL_FLOAT, 4*4, (void*)&frame.coords[index]);
+                glDrawArrays(GL_LINE_STRIP, 0, count);
+            }
+        }
+
+        void paintSignalLines(const DisplayFrame &frame, int channel, bool rms)
+        {
+            int width= frame.width;
+
+            if(frame.triggerEnabled)
+            {
+                // draw everything when trigger is on
+                paintColumns(frame, channel, 0, width, rms);
+            }
+            else
+            {
+                // trigger disabled: scroll
+                int endIndex= frame.fillColumn+1;
+                while(endIndex>width) endIndex-= width;
+                int right= width-endIndex;
+
+                glTranslatef(right, 0, 0);
+                paintColumns(frame, channel, 0, endIndex, rms);
+                glTranslatef(-right-endIndex, 0, 0);
+                paintColumns(frame, channel, endIndex, right, rms);
+            }
+        }
+
+        // draw the signals of all lanes. the GL state is set up once, for each lane only the
+        // transformation and the array pointers change.
+        void paintSignals(const DisplayFrame &frame, const rect *absPos, int laneHeight)
+        {
+            unsigned nLanes= min((unsigned)nChannels, frame.nChannels);
+
+            glColor4f(.1,1,.25,.75);
+            if(frame.lineDisplayPeaks) glDisable(GL_LINE_SMOOTH);
+            else glEnable(GL_LINE_SMOOTH);
+            glHint(GL_LINE_SMOOTH_HINT, GL_NICEST);
+            glLineWidth(1.0);
+            glEnableClientState(GL_VERTEX_ARRAY);
+            if(frame.lineDisplayPeaks)
+                glEnableClientState(GL_COLOR_ARRAY);
+
+            for(unsigned lane= 0; lane<nLanes; lane++)
+            {
+                glPushMatrix();
+                setLaneTransform(absPos, laneHeight, lane);
+                glScaled(1.0/frame.width, getDisplayScaling(), 1);
+                paintSignalLines(frame, lane, false);
+                glPopMatrix();
+            }
+
+            if(frame.lineDisplayPeaks && !frame.peakEnvelope)
+            {
+                // rms bars in a second pass, in a constant color
+                glDisableClientState(GL_COLOR_ARRAY);
+                glColor4f(.1,1,.8,.35);
+                for(unsigned lane= 0; lane<nLanes; lane++)
+                {
+                    glPushMatrix();
+                    setLaneTransform(absPos, laneHeight, lane);
+                    glScaled(1.0/frame.width, getDisplayScaling(), 1);
+                    paintSignalLines(frame, lane, true);
+                    glPopMatrix();
+                }
+            }
+
+            glDisableClientState(GL_VERTEX_ARRAY);
+            glDisableClientState(GL_COLOR_ARRAY);
+            glDisable(GL_LINE_SMOOTH);
+        }
+
+
+		void cbPaint(primitive *self, rect *absPos, const rectlist *dirtyRects)
+		{
+			unsigned windowWidth= absPos->rgt - absPos->x;
+			int windowHeight= absPos->btm - absPos->y;
+
+			if(columns!=windowWidth)
+			{
+				columns= windowWidth;
+				updateProcessorSettings();
+			}
+			if(phosphorView && nChannels)
+			{
+				// the persistence display has one row per pixel of a lane, over the visible value range
+				uint32_t rows= max(windowHeight/nChannels, 1);
+				float range= 1/verticalScaling;
+				if(rows!=phosphorRows || range!=phosphorRange)
+				{
+					phosphorRows= rows;
+					phosphorRange= range;
+					updateProcessorSettings();
+				}
+			}
+
+			processor.updateDisplayFrame();
+			processor.updateSpectrumFrame();
+			const DisplayFrame &frame= (browsingHistory? getHistoryFrame(windowWidth):
+										spectrumView || waterfallView? processor.getSpectrumFrame(): processor.getDisplayFrame());
+
+			if(!windowWidth) return;
+
+			fill_rect(absPos, 0);
+
+			glEnable(GL_SCISSOR_TEST);
+			glEnable(GL_BLEND);
+			glDisable(GL_LINE_SMOOTH);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+            glMatrixMode(GL_MODELVIEW);
+
+            int laneHeight= windowHeight/nChannels;
+            glScissor(absPos->x, viewport.btm-absPos->btm, windowWidth, windowHeight);
+
+            // the overlays are blended additively, so they can all be drawn in one batch before the signals
+            overlayLines.clear();
+            cursorMarker.clear();
+            meterLines.clear();
+            float xyX, xyY, xyRadius;
+            getXYArea(absPos, xyX, xyY, xyRadius);
+            if(showingXY())
+            {
+                addXYGridLines(overlayLines, xyX, xyY, xyRadius, getViewMode()==VM_GONIOMETER);
+                addCorrelationMeter(overlayLines, meterLines, xyX, xyRadius, absPos->y+12, processor.getCorrelation());
+            }
+            else if(showingSpectrum())
+                addSpectrumGridLines(overlayLines, absPos->x, absPos->y, windowWidth, laneHeight, nChannels, true);
+            else if(showingWaterfall())
+                addSpectrumGridLines(overlayLines, absPos->x, absPos->y, windowWidth, laneHeight, nChannels, false);
+            else
+                addGridLines(overlayLines, absPos->x, absPos->y, windowWidth, laneHeight, nChannels);
+            if(triggerEnabled && (getViewMode()==VM_SCOPE || getViewMode()==VM_PHOSPHOR))
+                addTriggerLines(overlayLines, frame, absPos->x, absPos->y, windowWidth, laneHeight);
+            if(showingSegments())
+                updateSegmentLines(absPos->x, absPos->y, windowWidth, laneHeight);
+            if(maskTest && processor.getMask() && (getViewMode()==VM_SCOPE || getViewMode()==VM_PHOSPHOR))
+                addMaskLines(overlayLines, *processor.getMask(), absPos->x, absPos->y, windowWidth, laneHeight);
+            addCursorLines(overlayLines, cursorMarker, frame, absPos->x, absPos->y, windowWidth, laneHeight);
+            paintLines(overlayLines);
+            paintLines(meterLines, 6);
+
+            if(showingWaterfall())
+            {
+                waterfall.setColorMap(waterfallColors);
+                while(processor.readSpectrumRow(spectrumRow))
+                    waterfall.addRow(spectrumRow, laneHeight);
+                waterfall.draw(useShaderRenderer()? &renderer: 0, absPos->x, absPos->y, windowWidth, laneHeight, nChannels);
+            }
+            else if(showingPhosphor())
+            {
+                processor.updatePhosphorFrame();
+                phosphor.setColorMap(waterfallColors);
+                phosphor.update(processor.getPhosphorFrame());
+                phosphor.draw(useShaderRenderer()? &renderer: 0, absPos->x, absPos->y, windowWidth, laneHeight, nChannels);
+            }
+            else if(showingSegments())
+                paintLines(segmentLines);
+            else if(showingXY())
+            {
+                xyDisplay.readPoints(processor.getXYPoints());
+                xyDisplay.draw(useShaderRenderer()? &renderer: 0, xyX, xyY, xyRadius, getDisplayScaling(),
+                               max(getPhosphorPersistence(), 0.0f)*getProcessingRate());
+            }
+            else if(frame.width)
+            {
+                if(useShaderRenderer())
+                    renderer.drawSignals(frame, absPos->x, absPos->y, windowWidth, laneHeight, nChannels, getDisplayScaling());
+                else
+                {
+                    paintSignals(frame, absPos, laneHeight);
+                    glScissor(absPos->x, viewport.btm-absPos->btm, windowWidth, windowHeight);
+                }
+            }
+
+            paintLines(cursorMarker, 2, true);
+
+			if(measurements && (getViewMode()==VM_SCOPE || getViewMode()==VM_PHOSPHOR))
+			{
+				processor.getMeasurements(measurementResults);
+				for(unsigned lane= 0; lane<measurementResults.size() && lane<unsigned(nChannels); lane++)
+				{
+					char text[256];
+					formatMeasurement(measurementResults[lane], text, sizeof(text));
+					draw_text(_font_getloc(FONT_DEFAULT), text, absPos->x+4,absPos->y+laneHeight*lane+4, *absPos, 0xc8c8c8);
+				}
+			}
+
+			if(cursorPos>=0 && cursorPos<absPos->rgt-absPos->x)
+			{
+				char cursorText[128];
+				double windowPos= double(cursorPos)/windowWidth;
+				double valueAtCursor= getValueAtCursorPos(frame);
+				double timeIdx= windowPos*frame.displayTime;
+				if(frame.triggerEnabled) timeIdx-= frame.triggerPosition*frame.displayTime;
+				if(browsingHistory)
+				{
+					// time since the history started
+					double t= max(historyEnd/history->getSamplingRate() - historySpan*(1-windowPos), 0.0);
+					snprintf(cursorText, 128, "%d:%02d:%06.3f Value: %7.4f %s", int(t/3600), int(fmod(t/60, 60)), fmod(t, 60),
+							 valueAtCursor, frame.peakEnvelope? "(peak)": "(max)");
+				}
+				else if(showingSegments())
+				{
+					// the time after the trigger event, and the value of the segment shown
+					const SweepCapture *segment= getShownSegment();
+					double t= segment && segment->samplingRate?
+						(windowPos*segment->nFrames-segment->triggerOffset+segment->triggerFraction)/segment->samplingRate: 0;
+					int n= snprintf(cursorText, 128, "%+.2fms", t*1000);
+					if(segmentLinesSelected>=0 && segment && cursorChannel<segment->nChannels && segment->nFrames)
+						snprintf(cursorText+n, 128-n, " Value: %7.4f",
+								 segment->getChannel(cursorChannel)[min(uint32_t(windowPos*segment->nFrames), segment->nFrames-1)]);
+				}
+				else if(showingXY())
+				{
+					float x= (absPos->x+cursorPos-xyX)/(xyRadius*getDisplayScaling()),
+						  y= (xyY-absPos->y-cursorY)/(xyRadius*getDisplayScaling());
+					if(getViewMode()==VM_GONIOMETER)
+						snprintf(cursorText, 128, "L: %7.4f R: %7.4f", (y-x)*M_SQRT1_2, (y+x)*M_SQRT1_2);
+					else
+						snprintf(cursorText, 128, "X: %7.4f Y: %7.4f", x, y);
+				}
+				else if(spectrumView)
+					snprintf(cursorText, 128, "%.1fHz Level: %.1fdB",
+							 SpectrumAnalyzer::getColumnFrequency(cursorPos, windowWidth, getProcessingRate()),
+							 SpectrumAnalyzer::valueToDb(valueAtCursor, getSpectrumSettings().range));
+				else if(waterfallView)
+				{
+					// the rows are one transform hop apart
+					SpectrumSettings s= getSpectrumSettings();
+					int rowsAgo= cursorY-laneHeight*int(cursorChannel);
+					int level= waterfall.getLevel(cursorChannel, cursorPos, max(rowsAgo, 0));
+					double hop= max(int(s.fftSize*(1-s.overlap)), 1)/getProcessingRate();
+					int n= snprintf(cursorText, 128, "%.1fHz %.2fs ago", SpectrumAnalyzer::getColumnFrequency(cursorPos, windowWidth, getProcessingRate()),
+									rowsAgo*hop);
+					if(level>=0)
+						snprintf(cursorText+n, 128-n, " Level: %.1fdB", level/255.0*s.range-s.range);
+				}
+				else
+					snprintf(cursorText, 128, "%+.2fms Value: %7.4f %s", timeIdx*1000, valueAtCursor,
+							 !frame.lineDisplayPeaks? "": frame.peakEnvelope? "(peak)": "(max)");
+				draw_text(_font_getloc(FONT_DEFAULT), cursorText, 4,absPos->btm-4-13, *absPos, 0x10f008);
+			}
+
+			if(browsingHistory)
+			{
+				const char *text= (historyFollow? "History (live)": "History");
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4,
+						  *absPos, 0xc8c8c8);
+			}
+			else if(spectrumView || waterfallView)
+			{
+				static const char *windowText[]= { "Rectangle", "Hann", "Blackman-Harris", "Flat Top" };
+				SpectrumSettings s= getSpectrumSettings();
+				char text[128];
+				snprintf(text, 128, "FFT %u, %s, %.1fHz/bin", s.fftSize, windowText[s.window], getProcessingRate()/s.fftSize);
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4,
+						  *absPos, 0xc8c8c8);
+			}
+			else if(showingSegments())
+			{
+				uint32_t count, capacity;
+				processor.getSegmentCount(count, capacity);
+				char text[128];
+				if(!capacity)
+					snprintf(text, 128, "No segments");
+				else if(segmentLinesSelected>=0 && segmentLinesSelected<int(segmentTimes.size()))
+					snprintf(text, 128, "Segment %d of %u, %+.3fms", segmentLinesSelected+1, count, segmentTimes[segmentLinesSelected]*1000);
+				else
+					snprintf(text, 128, "%u of %u segments%s", count, capacity, count==capacity? ", complete": "");
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4,
+						  *absPos, count==capacity && capacity? 0x10f008: 0xc8c8c8);
+			}
+			else if(showingXY())
+			{
+				char text[128];
+				snprintf(text, 128, "Correlation %+.2f", processor.getCorrelation());
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4,
+						  *absPos, 0xc8c8c8);
+			}
+			else if(showingPhosphor())
+			{
+				static const char *statusText[]= { "", ", Waiting", ", Trig'd", ", Auto", ", Stop" };
+				char text[128];
+				snprintf(text, 128, "%.0f wfm/s%s", processor.getPhosphorFrame().waveformRate,
+						 statusText[frame.triggerEnabled? frame.triggerStatus+1: 0]);
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4,
+						  *absPos, 0xc8c8c8);
+			}
+			else if(frame.triggerEnabled)
+			{
+				static const char *statusText[]= { "Waiting", "Trig'd", "Auto", "Stop" };
+				const char *text= statusText[frame.triggerStatus];
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4,
+						  *absPos, frame.triggerStatus==DisplayFrame::TS_TRIGGERED? 0x10f008: 0xc8c8c8);
+			}
+
+			if(maskTest && processor.getMask() && (getViewMode()==VM_SCOPE || getViewMode()==VM_PHOSPHOR))
+			{
+				processor.getMaskResults(maskResults);
+				char text[128];
+				snprintf(text, 128, "Mask %u sweeps, %u failed", maskResults.sweeps, maskResults.failedSweeps);
+				draw_text(_font_getloc(FONT_DEFAULT), text, absPos->rgt-4-font_gettextwidth(FONT_DEFAULT, text),absPos->y+4+16,
+						  *absPos, maskResults.failedSweeps? 0xf04020: 0x10f008);
+			}
+
+			glDisable(GL_SCISSOR_TEST);
+		}
+
+		void moveCursor(int x, int y)
+		{
+			cursorPos= x;
+			cursorY= y;
+			cursorChannel= y/max(wnd_geth(fluxHandle)/nChannels, 1);
+			if(cursorChannel>=unsigned(nChannels)) cursorChannel= nChannels-1;
+		}
+
+		void cbMouse(primitive *self, int type, int x, int y, int btn)
+		{
+			if(browsingHistory && historyMouse(type, x, btn))
+				return;
+			if(showingSpectrum() || showingWaterfall())
+			{
+				// the spectrum views only have the cursor
+				if(type==MOUSE_OVER) moveCursor(x, y);
+				else if(type==MOUSE_OUT) cursorPos= -1;
+				else if(type==MOUSE_UP) draggingHorizScale= false, wnd_set_mouse_capture(NOWND);
+				return;
+			}
+			if(showingSegments())
+			{
+				// the wheel steps through the segments, before the first one they are all overlaid
+				uint32_t count, capacity;
+				processor.getSegmentCount(count, capacity);
+				if(type==MOUSE_OVER) moveCursor(x, y);
+				else if(type==MOUSE_OUT) cursorPos= -1;
+				else if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELUP)
+					selectedSegment= min(selectedSegment+1, int(count)-1);
+				else if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELDOWN)
+					selectedSegment= max(selectedSegment-1, -1);
+				return;
+			}
+			if(showingXY())
+			{
+				// the plot has the cursor, the wheel zooms in and out
+				if(type==MOUSE_OVER) moveCursor(x, y);
+				else if(type==MOUSE_OUT) cursorPos= -1;
+				else if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELUP)
+					setVerticalScaling(verticalScaling*1.1), updateGuiParam(&verticalScaling);
+				else if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELDOWN)
+					setVerticalScaling(verticalScaling*0.9), updateGuiParam(&verticalScaling);
+				return;
+			}
+			if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELUP)
+				setVerticalScaling(verticalScaling*1.1),
+				updateGuiParam(&verticalScaling);
+			else if(type==MOUSE_DOWN && btn==MOUSE_BTNWHEELDOWN)
+				setVerticalScaling(verticalScaling*0.9),
+				updateGuiParam(&verticalScaling);
+			else if(type==MOUSE_DOWN && btn==MOUSE_BTNRIGHT)
+			{
+				draggingHorizScale= true;
+				horizScaleClickPos= x;
+				cursorPos= -1;
+			}
+			else if( btn==1 && triggerEnabled )
+			{
+				if(type==MOUSE_DOWN)
+					wnd_set_mouse_capture(fluxHandle);
+				rect absPos;
+				wnd_get_abspos(fluxHandle, &absPos);
+				int channelHeight= (absPos.btm-absPos.y)/nChannels;
+				if(channelHeight>0 && unsigned(y/channelHeight)==getTriggerSourceChannel())
+                {
+                    int y1= y%channelHeight;
+                    triggerLevel= double(channelHeight/2-y1)/verticalScaling/channelHeight*2;
+                    float triggerMinMax= 1.0/verticalScaling;
+                    if(triggerLevel>triggerMinMax) triggerLevel= triggerMinMax;
+                    if(triggerLevel<-triggerMinMax) triggerLevel= -triggerMinMax;
+                    updateProcessorSettings();
+                    updateGuiParam(&triggerLevel);
+                    cursorPos= -1;
+                }
+			}
+			else if(type==MOUSE_UP)
+			{
+				draggingHorizScale= false;
+				wnd_set_mouse_capture(NOWND);
+			}
+			else if(type==MOUSE_OVER && draggingHorizScale)
+			{
+				setDisplayTime(displayTime+(horizScaleClickPos-x)*0.0001);
+				updateGuiParam(&displayTime);
+				horizScaleClickPos= x;
+			}
+			else if(type==MOUSE_OVER)
+				moveCursor(x, y);
+			else if(type==MOUSE_OUT)
+			{
+				cursorPos= -1;
+			}
+		}
+};
+
+// receives callbacks when some kind of object has changed
+class changeListener
+{
+	public:
+		// this is called when some object has changed.
+		// override this in the subclass
+		virtual void valueChanged(class changeNotifier *which)
+		{ }
+};
+
+// calls back a changeListener when it has changed
+class changeNotifier
+{
+	private:
+		changeListener *myChangeListener;
+
+	public:
+		changeNotifier(changeListener *_myChangeListener):
+			myChangeListener(_myChangeListener)
+		{ }
+
+		// call this to notify the changeListener that this object has changed
+		void notifyChange()
+		{
+			if(myChangeListener) myChangeListener->valueChanged(this);
+		}
+};
+
+// base class for a label that can be changed in some way.
+// it just creates the text window and underlines it when the mouse enters the window.
+class fluxChangableLabelBase: public fluxWindowBase, public changeNotifier
+{
+	protected:
+		uint32_t labelHandle, lineHandle;
+
+		void cbMouse(primitive *self, int type, int x, int y, int btn)
+		{
+			if(type==MOUSE_IN)
+				wnd_show(lineHandle, true);
+			else if(type==MOUSE_OUT)
+				wnd_show(lineHandle, false);
+		}
+
+
+	public:
+		fluxChangableLabelBase(changeListener *_myChangeListener,
+							   int x, int y, uint32_t callbackFlags,
+							   int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
+			fluxWindowBase(x,y, 0,0, callbackFlags|CB_MOUSE_FLAG, parent, alignment),
+			changeNotifier(_myChangeListener)
+		{
+			labelHandle= create_text(fluxHandle, 0,0, 0,0, "text", COL_TEXT, FONT_DEFAULT, ALIGN_LEFT|ALIGN_RIGHT|ALIGN_TOP|ALIGN_BOTTOM);
+			lineHandle= create_rect(fluxHandle, 0,0, 0,1, COL_TEXT, ALIGN_LEFT|ALIGN_RIGHT|ALIGN_BOTTOM);
+			wnd_show(lineHandle, false);
+			rect_setcolor(fluxHandle, TRANSL_NOPAINT);
+			setText("Label");
+		}
+
+		~fluxChangableLabelBase()
+		{
+			wnd_destroy(labelHandle);
+			wnd_destroy(lineHandle);
+		}
+
+		void setText(const char *text)
+		{
+			text_settext(labelHandle, text);
+			wnd_setsize(fluxHandle, font_gettextwidth(FONT_DEFAULT, text), font_gettextheight(FONT_DEFAULT, text));
+		}
+};
+
+class fluxDraggableLabel: public fluxChangableLabelBase
+{
+	public:
+		enum DisplayMode
+		{
+			DM_PLAIN= 0,
+			DM_SECONDS,
+			DM_PERCENTAGE,
+			DM_HERTZ
+		};
+
+		fluxDraggableLabel(changeListener *_myChangeListener, int x, int y, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
+			fluxChangableLabelBase(_myChangeListener, x,y, 0, parent, alignment),
+			isDragging(false)
+		{
+			enableRelativeMode(true);
+			enableVerticalMode(false);
+			setRelativeModeSpeed(0.01);
+			setMinimumValue(0.01);
+			setMaximumValue(10);
+			setValue((minimumValue+maximumValue)/2, false);
+			setDisplayMode(DM_PLAIN);
+		}
+
+		void setRelativeModeSpeed(float speed)
+		{ relativeModeSpeed= speed; }
+
+		float getRelativeModeSpeed()
+		{ return relativeModeSpeed; }
+
+		void enableRelativeMode(bool enabled)
+		{ relativeModeEnabled= enabled; }
+
+		bool isRelativeModeEnabled()
+		{ return relativeModeEnabled; }
+
+		void setMinimumValue(float min)
+		{ minimumValue= min; }
+
+		void setMaximumValue(float max)
+		{ maximumValue= max; }
+
+		void setValue(float val, bool doNotify= true)
+		{
+			if(val<minimumValue) val= minimumValue;
+			else if(val>maximumValue) val= maximumValue;
+			value= val;
+			if(doNotify) notifyChange();
+			updateDisplay();
+		}
+
+		float getValue()
+		{ return value; }
+
+		void enableVerticalMode(bool enabled)
+		{ verticalMode= enabled; }
+
+		void setDisplayMode(DisplayMode mode, int precision= 3)
+		{ displayMode= mode; displayPrecision= precision; updateDisplay(); }
+
+	protected:
+		virtual void doDrag(int dx, int dy)
+		{
+			if(relativeModeEnabled)
+				setValue(value + (verticalMode? -dy: dx) * relativeModeSpeed);
+		}
+
+		virtual void updateDisplay()
+		{
+			char ch[128];
+			switch(displayMode)
+			{
+				case DM_PLAIN: snprintf(ch, 128, "%.*f", displayPrecision, value); break;
+				case DM_SECONDS: snprintf(ch, 128, "%.*fs", displayPrecision, value); break;
+				case DM_PERCENTAGE: snprintf(ch, 128, "%.*f%%", displayPrecision, value*100); break;
+				case DM_HERTZ: snprintf(ch, 128, "%.*fHz", displayPrecision, value); break;
+			}
+			setText(ch);
+		}
+
+
+	private:
+		float relativeModeSpeed;
+		bool relativeModeEnabled;
+		float minimumValue;
+		float maximumValue;
+		float value;
+		bool isDragging;
+		int dragStartX, dragStartY;
+		bool verticalMode;
+		enum DisplayMode displayMode;
+		int displayPrecision;
+
+		void cbMouse(primitive *self, int type, int x, int y, int btn)
+		{
+			fluxChangableLabelBase::cbMouse(self, type, x, y, btn);
+			if(type==MOUSE_DOWN && btn==MOUSE_BTNLEFT)
+			{
+				isDragging= true;
+				wnd_set_mouse_capture(fluxHandle);
+				dragStartX= x; dragStartY= y;
+			}
+			else if(type==MOUSE_UP)
+			{
+				isDragging= false;
+				wnd_set_mouse_capture(NOWND);
+			}
+			else if(type==MOUSE_OVER && isDragging)
+			{
+				rect abspos;
+				wnd_get_abspos(fluxHandle, &abspos);
+				SDL_WarpMouse(abspos.x+dragStartX, abspos.y+dragStartY);
+				doDrag(x-dragStartX, y-dragStartY);
+			}
+		}
+};
+
+
+class fluxChoiceLabel: public fluxChangableLabelBase
+{
+	public:
+		fluxChoiceLabel(changeListener *_myChangeListener, int x, int y, int parent= NOPARENT, int alignment= ALIGN_LEFT|ALIGN_TOP):
+			fluxChangableLabelBase(_myChangeListener, x,y, 0, parent, alignment)
+		{
+			setText("Choice");
+		}
+
+		virtual void selectChoice(int choice, bool doNotify= true)
+		{
+			if(!choiceList.size()) return;
+			while(choice<0) choice+= choiceList.size();
+			choiceIndex= choice%choiceList.size();
+			setText(choiceList[choiceIndex].c_str());
+			if(doNotify) notifyChange();
+		}
+
+		void addChoice(const char *choiceText)
+		{
+			choiceList.push_back(string(choiceText));
+			if(choiceList.size()==1) selectChoice(0, false);
+		}
+
+		int getChoiceIndex()
+		{ return choiceIndex; }
+
+		std::string getChoiceText()
+		{ return (choiceIndex<choiceList.size()? choiceList[choiceIndex]: "None"); }
+
+	protected:
+		vector<string> choiceList;
+		uint32_t choiceIndex;
+
+	private:
+		void cbMouse(primitive *self, int type, int x, int y, int btn)
+		{
+			fluxChangableLabelBase::cbMouse(self, type, x, y, btn);
+
+			if(type==MOUSE_DOWN)
+			{
+				if(btn==MOUSE_BTN1 || btn==MOUSE_BTNWHEELUP)
+					selectChoice(++choiceIndex);
+				else if(btn==MOUSE_BTN2 || btn==MOUSE_BTNWHEELDOWN)
+					selectChoice(--choiceIndex);
+			}
+		}
+};
+
+
+class fluxOscWindowConfigPane: public fluxWindowBase, public changeListener
+{
+	private:
+		fluxOscWindow &oscWindow;
+		fluxChoiceLabel *triggerTypeChoiceLabel;
+		uint32_t triggerTypeText;
+		fluxDraggableLabel *displayTimeLabel;
+		uint32_t displayTimeText;
+		fluxDraggableLabel *verticalScalingLabel;
+		uint32_t verticalScalingText;
+		fluxChoiceLabel *peakDisplayChoiceLabel;
+		uint32_t peakDisplayText;
+		fluxDraggableLabel *triggerLevelLabel;
+		uint32_t triggerLevelText;
+		fluxChoiceLabel *triggerSlopeChoiceLabel;
+		uint32_t triggerSlopeText;
+		fluxChoiceLabel *triggerSourceChoiceLabel;
+		uint32_t triggerSourceText;
+		fluxDraggableLabel *triggerHysteresisLabel;
+		uint32_t triggerHysteresisText;
+		fluxDraggableLabel *triggerHoldoffLabel;
+		uint32_t triggerHoldoffText;
+		fluxChoiceLabel *triggerModeChoiceLabel;
+		uint32_t triggerModeText;
+		fluxChoiceLabel *singleShotArmLabel;
+		fluxDraggableLabel *triggerPulseWidthLabel;
+		uint32_t triggerPulseWidthText;
+		fluxDraggableLabel *triggerRuntLevelLabel;
+		uint32_t triggerRuntLevelText;
+		fluxDraggableLabel *triggerPositionLabel;
+		uint32_t triggerPositionText;
+		fluxChoiceLabel *viewChoiceLabel;
+		uint32_t viewText;
+		fluxChoiceLabel *fftSizeChoiceLabel;
+		uint32_t fftSizeText;
+		fluxChoiceLabel *fftWindowChoiceLabel;
+		uint32_t fftWindowText;
+		fluxChoiceLabel *waterfallColorsChoiceLabel;
+		uint32_t waterfallColorsText;
+		fluxChoiceLabel *filterChoiceLabel;
+		uint32_t filterText;
+		fluxDraggableLabel *lowpassFrequencyLabel;
+		uint32_t lowpassFrequencyText;
+		fluxDraggableLabel *highpassFrequencyLabel;
+		uint32_t highpassFrequencyText;
+		fluxChoiceLabel *interpolationChoiceLabel;
+		uint32_t interpolationText;
+		fluxDraggableLabel *phosphorPersistenceLabel;
+		uint32_t phosphorPersistenceText;
+		fluxChoiceLabel *xyInputXChoiceLabel;
+		uint32_t xyInputXText;
+		fluxChoiceLabel *xyInputYChoiceLabel;
+		uint32_t xyInputYText;
+		fluxChoiceLabel *measurementsChoiceLabel;
+		uint32_t measurementsText;
+		fluxChoiceLabel *maskTestChoiceLabel;
+		uint32_t maskTestText;
+		fluxDraggableLabel *segmentsLabel;
+		uint32_t segmentsText;
+		fluxChoiceLabel *segmentsArmLabel;
+
+	public:
+		fluxOscWindowConfigPane(fluxOscWindow &myOscWindow, int x, int y, int w, int h,
+								uint32_t parent= NOPARENT, int alignment= ALIGN_BOTTOM|ALIGN_LEFT|ALIGN_RIGHT):
+			fluxWindowBase(x,y, w,h, 0, parent, alignment),
+			oscWindow(myOscWindow)
+		{
+			uint32_t textColor= 0xc8c8c8;
+			int textWidth= 85;
+
+			triggerTypeText= create_text(fluxHandle, 8,8, 100,20, "Trigger Type: ", textColor, FONT_DEFAULT);
+			triggerTypeChoiceLabel= new fluxChoiceLabel(this, 8+textWidth,8, fluxHandle);
+			triggerTypeChoiceLabel->addChoice("Off");
+			triggerTypeChoiceLabel->addChoice("Edge");
+			triggerTypeChoiceLabel->addChoice("Pulse <");
+			triggerTypeChoiceLabel->addChoice("Pulse >");
+			triggerTypeChoiceLabel->addChoice("Runt");
+			triggerTypeChoiceLabel->selectChoice(!oscWindow.isTriggerEnabled()? 0: oscWindow.getTriggerType()+1, false);
+
+			triggerLevelText= create_text(fluxHandle, 8,24, 100,20, "Trigger Level: ", textColor, FONT_DEFAULT);
+			triggerLevelLabel= new fluxDraggableLabel(this, 8+textWidth,24, fluxHandle);
+			triggerLevelLabel->setMinimumValue(-50);
+			triggerLevelLabel->setMaximumValue(+50);
+			triggerLevelLabel->setRelativeModeSpeed(0.001);
+			triggerLevelLabel->enableVerticalMode(true);
+			triggerLevelLabel->setValue(oscWindow.getTriggerLevel());
+
+			triggerSlopeText= create_text(fluxHandle, 8,40, 100,20, "Slope: ", textColor, FONT_DEFAULT);
+			triggerSlopeChoiceLabel= new fluxChoiceLabel(this, 8+textWidth,40, fluxHandle);
+			triggerSlopeChoiceLabel->addChoice("Rising");
+			triggerSlopeChoiceLabel->addChoice("Falling");
+			triggerSlopeChoiceLabel->selectChoice(oscWindow.isTriggerPositive()? 0: 1, false);
+
+			triggerPositionText= create_text(fluxHandle, 8,56, 100,20, "Trig. Position: ", textColor, FONT_DEFAULT);
+			triggerPositionLabel= new fluxDraggableLabel(this, 8+textWidth,56, fluxHandle);
+			triggerPositionLabel->setMinimumValue(0);
+			triggerPositionLabel->setMaximumValue(1);
+			triggerPositionLabel->setRelativeModeSpeed(0.002);
+			triggerPositionLabel->setDisplayMode(fluxDraggableLabel::DM_PERCENTAGE, 0);
+			triggerPositionLabel->setValue(oscWindow.getTriggerPosition(), false);
+
+			// the filter type, either of all channels or just of the trigger source
+			filterText= create_text(fluxHandle, 8,72, 100,20, "Filter: ", textColor, FONT_DEFAULT);
+			filterChoiceLabel= new fluxChoiceLabel(this, 8+textWidth,72, fluxHandle);
+			filterChoiceLabel->addChoice("Off");
+			filterChoiceLabel->addChoice("Low Pass");
+			filterChoiceLabel->addChoice("High Pass");
+			filterChoiceLabel->addChoice("Band Pass");
+			filterChoiceLabel->addChoice("Trig. LP");
+			filterChoiceLabel->addChoice("Trig. HP");
+			filterChoiceLabel->addChoice("Trig. BP");
+			int filterType= oscWindow.getFilterType();
+			filterChoiceLabel->selectChoice(filterType && oscWindow.isFilterTriggerOnly()? filterType+3: filterType, false);
+
+			interpolationText= create_text(fluxHandle, 8,88, 100,20, "Interpolation: ", textColor, FONT_DEFAULT);
+			interpolationChoiceLabel= new fluxChoiceLabel(this, 8+textWidth,88, fluxHandle);
+			interpolationChoiceLabel->addChoice("Linear");
+			interpolationChoiceLabel->addChoice("Sinc");
+			interpolationChoiceLabel->selectChoice(oscWindow.isSincInterpolationEnabled()? 1: 0, false);
+
+			measurementsText= create_text(fluxHandle, 8,104, 100,20, "Measure: ", textColor, FONT_DEFAULT);
+			measurementsChoiceLabel= new fluxChoiceLabel(this, 8+textWidth,104, fluxHandle);
+			measurementsChoiceLabel->addChoice("Off");
+			measurementsChoiceLabel->addChoice("On");
+			measurementsChoiceLabel->selectChoice(oscWindow.isMeasurementsEnabled()? 1: 0, false);
+
+			textWidth= 80;
+			displayTimeText= create_text(fluxHandle, 190,8, 100,20, "Display Time: ", textColor, FONT_DEFAULT);
+			displayTimeLabel= new fluxDraggableLabel(this, 190+textWidth,8, fluxHandle);
+			displayTimeLabel->setMinimumValue(0.0005);
+			displayTimeLabel->setMaximumValue(10);
+			displayTimeLabel->setRelativeModeSpeed(0.001);
+			displayTimeLabel->setDisplayMode(fluxDraggableLabel::DM_SECONDS);
+			displayTimeLabel->setValue(oscWindow.getDisplayTime());
+
+			verticalScalingText= create_text(fluxHandle, 190,24, 100,20, "Vert. Scaling: ", textColor, FONT_DEFAULT);
+			verticalScalingLabel= new fluxDraggableLabel(this, 190+textWidth,24, fluxHandle);
+			verticalScalingLabel->setMinimumValue(0.1);
+			verticalScalingLabel->setMaximumValue(100.0);
+			verticalScalingLabel->setRelativeModeSpeed(0.005);
+			verticalScalingLabel->enableVerticalMode(true);
+			verticalScalingLabel->setDisplayMode(fluxDraggableLabel::DM_PERCENTAGE, 0);
+			verticalScalingLabel->setValue(oscWindow.getVerticalScaling());
+
+			triggerSourceText= create_text(fluxHandle, 190,40, 100,20, "Trig. Source: ", textColor, FONT_DEFAULT);
+			triggerSourceChoiceLabel= new fluxChoiceLabel(this, 190+textWidth,40, fluxHandle);
+			for(int i= 0; i<oscWindow.getNumChannels(); i++)
+			{
+				char ch[32];
+				snprintf(ch, 32, "Channel %d", i+1);
+				triggerSourceChoiceLabel->addChoice(ch);
+			}
+			triggerSourceChoiceLabel->selectChoice(oscWindow.getTriggerSource(), false);
+
+			fftSizeText= create_text(fluxHandle, 190,56, 100,20, "FFT Size: ", textColor, FONT_DEFAULT);
+			fftSizeChoiceLabel= new fluxChoiceLabel(this, 190+textWidth,56, fluxHandle);
+			for(int size= 1; size<=64; size*= 2)
+			{
+				char text[32];
+				snprintf(text, 32, "%dk", size);
+				fftSizeChoiceLabel->addChoice(text);
+			}
+			fftSizeChoiceLabel->selectChoice(__builtin_ctz(oscWindow.getFFTSize()/1024), false);
+
+			waterfallColorsText= create_text(fluxHandle, 190,72, 100,20, "Colors: ", textColor, FONT_DEFAULT);
+			waterfallColorsChoiceLabel= new fluxChoiceLabel(this, 190+textWidth,72, fluxHandle);
+			waterfallColorsChoiceLabel->addChoice("Heat");
+			waterfallColorsChoiceLabel->addChoice("Viridis");
+			waterfallColorsChoiceLabel->addChoice("Phosphor");
+			waterfallColorsChoiceLabel->addChoice("Gray");
+			waterfallColorsChoiceLabel->selectChoice(oscWindow.getWaterfallColors(), false);
+
+			phosphorPersistenceText= create_text(fluxHandle, 190,88, 100,20, "Persistence: ", textColor, FONT_DEFAULT);
+			phosphorPersistenceLabel= new fluxDraggableLabel(this, 190+textWidth,88, fluxHandle);
+			phosphorPersistenceLabel->setMinimumValue(0);
+			phosphorPersistenceLabel->setMaximumValue(60);
+			phosphorPersistenceLabel->setRelativeModeSpeed(0.005);
+			phosphorPersistenceLabel->setDisplayMode(fluxDraggableLabel::DM_SECONDS, 2);
+			phosphorPersistenceLabel->setValue(oscWindow.getPhosphorPersistence(), false);
+
+			maskTestText= create_text(fluxHandle, 190,104, 100,20, "Mask Test: ", textColor, FONT_DEFAULT);
+			maskTestChoiceLabel= new fluxChoiceLabel(this, 190+textWidth,104, fluxHandle);
+			maskTestChoiceLabel->addChoice("Off");
+			maskTestChoiceLabel->addChoice("On");
+			maskTestChoiceLabel->selectChoice(oscWindow.isMaskTestEnabled()? 1: 0, false);
+
+			peakDisplayText= create_text(fluxHandle, 370,8, 100,20, "Peak Display: ", textColor, FONT_DEFAULT);
+			peakDisplayChoiceLabel= new fluxChoiceLabel(this, 370+textWidth,8, fluxHandle);
+			peakDisplayChoiceLabel->addChoice("Min/Max");
+			peakDisplayChoiceLabel->addChoice("Envelope");
+			peakDisplayChoiceLabel->selectChoice(oscWindow.isPeakEnvelopeEnabled()? 1: 0, false);
+
+			triggerHysteresisText= create_text(fluxHandle, 370,24, 100,20, "Hysteresis: ", textColor, FONT_DEFAULT);
+			triggerHysteresisLabel= new fluxDraggableLabel(this, 370+textWidth,24, fluxHandle);
+			triggerHysteresisLabel->setMinimumValue(0);
+			triggerHysteresisLabel->setMaximumValue(10);
+			triggerHysteresisLabel->setRelativeModeSpeed(0.001);
+			triggerHysteresisLabel->enableVerticalMode(true);
+			triggerHysteresisLabel->setValue(oscWindow.getTriggerHysteresis(), false);
+
+			triggerHoldoffText= create_text(fluxHandle, 370,40, 100,20, "Holdoff: ", textColor, FONT_DEFAULT);
+			triggerHoldoffLabel= new fluxDraggableLabel(this, 370+textWidth,40, fluxHandle);
+			triggerHoldoffLabel->setMinimumValue(0);
+			triggerHoldoffLabel->setMaximumValue(10);
+			triggerHoldoffLabel->setRelativeModeSpeed(0.0005);
+			triggerHoldoffLabel->setDisplayMode(fluxDraggableLabel::DM_SECONDS, 4);
+			triggerHoldoffLabel->setValue(oscWindow.getTriggerHoldoff(), false);
+
+			viewText= create_text(fluxHandle, 370,56, 100,20, "View: ", textColor, FONT_DEFAULT);
+			viewChoiceLabel= new fluxChoiceLabel(this, 370+textWidth,56, fluxHandle);
+			viewChoiceLabel->addChoice("Scope");
+			viewChoiceLabel->addChoice("Spectrum");
+			viewChoiceLabel->addChoice("Waterfall");
+			viewChoiceLabel->addChoice("Phosphor");
+			viewChoiceLabel->addChoice("XY");
+			viewChoiceLabel->addChoice("Goniometer");
+			viewChoiceLabel->addChoice("Segments");
+			if(oscWindow.hasHistory())
+				viewChoiceLabel->addChoice("History");
+			viewChoiceLabel->selectChoice(oscWindow.getViewMode(), false);
+
+			lowpassFrequencyText= create_text(fluxHandle, 370,72, 100,20, "Low Pass: ", textColor, FONT_DEFAULT);
+			lowpassFrequencyLabel= new fluxDraggableLabel(this, 370+textWidth,72, fluxHandle);
+			lowpassFrequencyLabel->setMinimumValue(1);
+			lowpassFrequencyLabel->setMaximumValue(100000);
+			lowpassFrequencyLabel->setRelativeModeSpeed(10);
+			lowpassFrequencyLabel->setDisplayMode(fluxDraggableLabel::DM_HERTZ, 0);
+			lowpassFrequencyLabel->setValue(oscWindow.getLowpassFrequency(), false);
+
+			xyInputXText= create_text(fluxHandle, 370,88, 100,20, "X / Left: ", textColor, FONT_DEFAULT);
+			xyInputXChoiceLabel= new fluxChoiceLabel(this, 370+textWidth,88, fluxHandle);
+
+			// the sequence acquisition, and starting a new sequence
+			segmentsText= create_text(fluxHandle, 370,104, 100,20, "Segments: ", textColor, FONT_DEFAULT);
+			segmentsLabel= new fluxDraggableLabel(this, 370+textWidth,104, fluxHandle);
+			segmentsLabel->setMinimumValue(0);
+			segmentsLabel->setMaximumValue(10000);
+			segmentsLabel->setRelativeModeSpeed(1);
+			segmentsLabel->setDisplayMode(fluxDraggableLabel::DM_PLAIN, 0);
+			segmentsLabel->setValue(oscWindow.getSegments(), false);
+			segmentsArmLabel= new fluxChoiceLabel(this, 370+textWidth+50,104, fluxHandle);
+			segmentsArmLabel->addChoice("Arm");
+
+			triggerModeText= create_text(fluxHandle, 550,8, 100,20, "Trig. Mode: ", textColor, FONT_DEFAULT);
+			triggerModeChoiceLabel= new fluxChoiceLabel(this, 550+textWidth,8, fluxHandle);
+			triggerModeChoiceLabel->addChoice("Auto");
+			triggerModeChoiceLabel->addChoice("Normal");
+			triggerModeChoiceLabel->addChoice("Single");
+			triggerModeChoiceLabel->selectChoice(oscWindow.getTriggerMode(), false);
+			singleShotArmLabel= new fluxChoiceLabel(this, 550+textWidth+50,8, fluxHandle);
+			singleShotArmLabel->addChoice("Arm");
+
+			triggerPulseWidthText= create_text(fluxHandle, 550,24, 100,20, "Pulse Width: ", textColor, FONT_DEFAULT);
+			triggerPulseWidthLabel= new fluxDraggableLabel(this, 550+textWidth,24, fluxHandle);
+			triggerPulseWidthLabel->setMinimumValue(0.00001);
+			triggerPulseWidthLabel->setMaximumValue(10);
+			triggerPulseWidthLabel->setRelativeModeSpeed(0.00005);
+			triggerPulseWidthLabel->setDisplayMode(fluxDraggableLabel::DM_SECONDS, 5);
+			triggerPulseWidthLabel->setValue(oscWindow.getTriggerPulseWidth(), false);
+
+			triggerRuntLevelText= create_text(fluxHandle, 550,40, 100,20, "Runt Level: ", textColor, FONT_DEFAULT);
+			triggerRuntLevelLabel= new fluxDraggableLabel(this, 550+textWidth,40, fluxHandle);
+			triggerRuntLevelLabel->setMinimumValue(-50);
+			triggerRuntLevelLabel->setMaximumValue(+50);
+			triggerRuntLevelLabel->setRelativeModeSpeed(0.001);
+			triggerRuntLevelLabel->enableVerticalMode(true);
+			triggerRuntLevelLabel->setValue(oscWindow.getTriggerRuntLevel(), false);
+
+			fftWindowText= create_text(fluxHandle, 550,56, 100,20, "FFT Window: ", textColor, FONT_DEFAULT);
+			fftWindowChoiceLabel= new fluxChoiceLabel(this, 550+textWidth,56, fluxHandle);
+			fftWindowChoiceLabel->addChoice("Rectangle");
+			fftWindowChoiceLabel->addChoice("Hann");
+			fftWindowChoiceLabel->addChoice("Blackman-Harris");
+			fftWindowChoiceLabel->addChoice("Flat Top");
+			fftWindowChoiceLabel->selectChoice(oscWindow.getFFTWindow(), false);
+
+			highpassFrequencyText= create_text(fluxHandle, 550,72, 100,20, "High Pass: ", textColor, FONT_DEFAULT);
+			highpassFrequencyLabel= new fluxDraggableLabel(this, 550+textWidth,72, fluxHandle);
+			highpassFrequencyLabel->setMinimumValue(1);
+			highpassFrequencyLabel->setMaximumValue(100000);
+			highpassFrequencyLabel->setRelativeModeSpeed(1);
+			highpassFrequencyLabel->setDisplayMode(fluxDraggableLabel::DM_HERTZ, 0);
+			highpassFrequencyLabel->setValue(oscWindow.getHighpassFrequency(), false);
+
+			xyInputYText= create_text(fluxHandle, 550,88, 100,20, "Y / Right: ", textColor, FONT_DEFAULT);
+			xyInputYChoiceLabel= new fluxChoiceLabel(this, 550+textWidth,88, fluxHandle);
+			for(int i= 0; i<oscWindow.getNumChannels(); i++)
+			{
+				char ch[32];
+				snprintf(ch, 32, "Channel %d", i+1);
+				xyInputXChoiceLabel->addChoice(ch);
+				xyInputYChoiceLabel->addChoice(ch);
+			}
+			xyInputXChoiceLabel->selectChoice(oscWindow.getXYInputX(), false);
+			xyInputYChoiceLabel->selectChoice(oscWindow.getXYInputY(), false);
+		}
+
+		void updateTriggerLevelDisplay(float newTriggerLevel)
+		{ triggerLevelLabel->setValue(newTriggerLevel, false); }
+		void updateVerticalScalingDisplay(float newVertScale)
+		{ verticalScalingLabel->setValue(newVertScale, false); }
+		void updateDisplayTimeDisplay(float newDisplayTime)
+		{ displayTimeLabel->setValue(newDisplayTime, false); }
+
+		void valueChanged(changeNotifier *which)
+		{
+			if(which==triggerTypeChoiceLabel)
+			{
+				int choice= triggerTypeChoiceLabel->getChoiceIndex();
+				if(choice>0) oscWindow.setTriggerType(choice-1);
+				oscWindow.enableTrigger(choice>0);
+			}
+			else if(which==triggerSlopeChoiceLabel)
+				oscWindow.setTriggerDir(triggerSlopeChoiceLabel->getChoiceIndex()==0);
+			else if(which==triggerSourceChoiceLabel)
+				oscWindow.setTriggerSource(triggerSourceChoiceLabel->getChoiceIndex());
+			else if(which==triggerHysteresisLabel)
+				oscWindow.setTriggerHysteresis(triggerHysteresisLabel->getValue());
+			else if(which==triggerHoldoffLabel)
+				oscWindow.setTriggerHoldoff(triggerHoldoffLabel->getValue());
+			else if(which==triggerModeChoiceLabel)
+				oscWindow.setTriggerMode(triggerModeChoiceLabel->getChoiceIndex());
+			else if(which==singleShotArmLabel)
+				oscWindow.armSingleShot();
+			else if(which==triggerPulseWidthLabel)
+				oscWindow.setTriggerPulseWidth(triggerPulseWidthLabel->getValue());
+			else if(which==triggerRuntLevelLabel)
+				oscWindow.setTriggerRuntLevel(triggerRuntLevelLabel->getValue());
+			else if(which==triggerPositionLabel)
+				oscWindow.setTriggerPosition(triggerPositionLabel->getValue());
+			else if(which==triggerLevelLabel)
+				oscWindow.setTriggerLevel(triggerLevelLabel->getValue());
+			else if(which==displayTimeLabel)
+				oscWindow.setDisplayTime(displayTimeLabel->getValue());
+			else if(which==verticalScalingLabel)
+				oscWindow.setVerticalScaling(verticalScalingLabel->getValue());
+			else if(which==peakDisplayChoiceLabel)
+				oscWindow.enablePeakEnvelope(peakDisplayChoiceLabel->getChoiceIndex()==1);
+			else if(which==interpolationChoiceLabel)
+				oscWindow.enableSincInterpolation(interpolationChoiceLabel->getChoiceIndex()==1);
+			else if(which==measurementsChoiceLabel)
+				oscWindow.enableMeasurements(measurementsChoiceLabel->getChoiceIndex()==1);
+			else if(which==maskTestChoiceLabel)
+				oscWindow.enableMaskTest(maskTestChoiceLabel->getChoiceIndex()==1);
+			else if(which==segmentsLabel)
+				oscWindow.setSegments(int(segmentsLabel->getValue()+.5));
+			else if(which==segmentsArmLabel)
+				oscWindow.armSegments();
+			else if(which==viewChoiceLabel)
+				oscWindow.setViewMode(viewChoiceLabel->getChoiceIndex());
+			else if(which==fftSizeChoiceLabel)
+				oscWindow.setFFTSize(1024<<fftSizeChoiceLabel->getChoiceIndex());
+			else if(which==fftWindowChoiceLabel)
+				oscWindow.setFFTWindow(fftWindowChoiceLabel->getChoiceIndex());
+			else if(which==waterfallColorsChoiceLabel)
+				oscWindow.setWaterfallColors(waterfallColorsChoiceLabel->getChoiceIndex());
+			else if(which==phosphorPersistenceLabel)
+				oscWindow.setPhosphorPersistence(phosphorPersistenceLabel->getValue());
+			else if(which==xyInputXChoiceLabel || which==xyInputYChoiceLabel)
+				oscWindow.setXYInputs(xyInputXChoiceLabel->getChoiceIndex(), xyInputYChoiceLabel->getChoiceIndex());
+			else if(which==filterChoiceLabel)
+			{
+				int choice= filterChoiceLabel->getChoiceIndex();
+				oscWindow.setFilterTriggerOnly(choice>FilterSettings::FT_BANDPASS);
+				oscWindow.setFilterType(choice>FilterSettings::FT_BANDPASS? choice-3: choice);
+			}
+			else if(which==lowpassFrequencyLabel)
+				oscWindow.setLowpassFrequency(lowpassFrequencyLabel->getValue());
+			else if(which==highpassFrequencyLabel)
+				oscWindow.setHighpassFrequency(highpassFrequencyLabel->getValue());
+		}
+};
+
+// update the GUI to reflect a parameter change of the oscillator window
+void fluxOscWindow::updateGuiParam(void *paramAddress)
+{
+	if(!configPane) return;
+
+	if(paramAddress==&triggerLevel)
+		configPane->updateTriggerLevelDisplay(triggerLevel);
+	else if(paramAddress==&verticalScaling)
+		configPane->updateVerticalScalingDisplay(verticalScaling);
+	else if(paramAddress==&displayTime)
+		configPane->updateDisplayTimeDisplay(displayTime);
+}
+
+
+const char *getHomeDir()
+{
+	return getenv("HOME");
+}
+
+string getConfigDir()
+{
+	return string(getHomeDir()) + "/.fluxscope";
+}
+
+string getConfigFilename()
+{
+	return getConfigDir() + "/prefs";
+}
+
+bool createConfigDir()
+{
+	string cfgdir= getConfigDir();
+	struct stat st;
+	mkdir(cfgdir.c_str(), 0700);
+	int err= stat(cfgdir.c_str(), &st);
+	if(err==0 && st.st_mode&S_IFDIR)
+		return true;
+	else
+		return false;
+}
+
+bool createConfigFile()
+{
+	if(!createConfigDir()) return false;
+	FILE *f= fopen(getConfigFilename().c_str(), "w");
+	if(!f) return false;
+	fclose(f);
+	return true;
+}
+
+// fill one period of test signal: a sine wave on every channel, phase shifted per channel
+void makeTestPeriod(vector< vector<jack_default_audio_sample_t> > &period, uint32_t nFrames, double &phase, double phaseStep)
+{
+	for(uint32_t ch= 0; ch<period.size(); ch++)
+	{
+		period[ch].resize(nFrames);
+		for(uint32_t i= 0; i<nFrames; i++)
+			period[ch][i]= 0.8*sin(phase + i*phaseStep + ch);
+	}
+	phase= fmod(phase + nFrames*phaseStep, 2*M_PI);
+}
+
+// push synthetic periods through the processing side and print the cost per period for a range of window
+// widths and display times. only the columns covering the new samples are refreshed, width*period/displaySamples
+// of them, so the cost per period grows with the width and falls with the display time. the cost per
+// refreshed column, printed below it, should stay about flat where a period covers several columns. where it
+// covers less than one, the fixed cost of a period takes over.
+void benchmarkDisplayRefresh()
+{
+	const uint32_t periodSize= 64, nPeriods= 4000;
+	const float samplingRate= 48000;
+	const uint32_t widths[]= { 640, 1280, 2560, 5120 };
+	const float displayTimes[]= { 0.001, 0.01, 0.1, 1, 10 };
+	const int nWidths= sizeof(widths)/sizeof(widths[0]), nDisplayTimes= sizeof(displayTimes)/sizeof(displayTimes[0]);
+	double nsPerColumn[nDisplayTimes][nWidths][2];
+
+	printf("display refresh: us per %u-frame period, scroll/triggered\n", periodSize);
+	printf("%12s", "time \\ width");
+	for(int w= 0; w<nWidths; w++) printf(" %15u", widths[w]);
+	printf("\n");
+
+	for(int t= 0; t<nDisplayTimes; t++)
+	{
+		printf("%11.3fs", displayTimes[t]);
+		for(int w= 0; w<nWidths; w++)
+		{
+			double usPerPeriod[2];
+			for(int triggered= 0; triggered<2; triggered++)
+			{
+				SampleRingBuffer ringBuffer(2, periodSize*2);
+				ScopeProcessor processor;
+				ScopeSettings settings;
+				settings.displaySamples= uint32_t(displayTimes[t]*samplingRate);
+				settings.columns= widths[w];
+				settings.trigger.enabled= triggered;
+				settings.samplingRate= samplingRate;
+				processor.setSettings(settings);
+				processor.setRingBuffer(&ringBuffer);
+				processor.processPending();
+
+				vector< vector<jack_default_audio_sample_t> > period(2);
+				double phase= 0, phaseStep= 2*M_PI*440/samplingRate;
+				double elapsed= 0;
+				for(uint32_t p= 0; p<nPeriods; p++)
+				{
+					makeTestPeriod(period, periodSize, phase, phaseStep);
+					double start= getTime();
+					for(uint32_t ch= 0; ch<period.size(); ch++)
+						ringBuffer.writeChannel(ch, &period[ch][0], periodSize);
+					ringBuffer.commitWrite(periodSize);
+					processor.processPending();
+					processor.updateDisplayFrame();
+					elapsed+= getTime()-start;
+				}
+				usPerPeriod[triggered]= elapsed*1000000/nPeriods;
+				// a period refreshes at least the column it ends in, and at most the whole sweep
+				double newColumns= max(1.0, min(double(widths[w]), double(widths[w])*periodSize/settings.displaySamples));
+				nsPerColumn[t][w][triggered]= usPerPeriod[triggered]*1000/newColumns;
+			}
+			printf("   %5.1f / %5.1f", usPerPeriod[0], usPerPeriod[1]);
+		}
+		printf("\n");
+	}
+
+	printf("ns per refreshed column, scroll/triggered\n");
+	for(int t= 0; t<nDisplayTimes; t++)
+	{
+		printf("%11.3fs", displayTimes[t]);
+		for(int w= 0; w<nWidths; w++)
+			printf(" %7.1f / %5.1f", nsPerColumn[t][w][0], nsPerColumn[t][w][1]);
+		printf("\n");
+	}
+}
+
+// cost of a zoom step while dragging the horizontal scale: the display time and the number of columns change
+// before each period. the buffers are sized for the longest display time the controls allow, so once the
+// window widths have been seen nothing is allocated, and the samples are kept across the steps.
+bool benchmarkZoom()
+{
+	const uint32_t periodSize= 256, nSteps= 2000;
+	const unsigned nChannels= 8;
+	const float samplingRate= 48000;
+	SampleRingBuffer ringBuffer(nChannels, periodSize*2);
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= nChannels;
+	settings.maxDisplaySamples= uint32_t(samplingRate*10);
+	settings.trigger.enabled= false;
+	settings.samplingRate= samplingRate;
+	processor.setRingBuffer(&ringBuffer);
+
+	vector< vector<jack_default_audio_sample_t> > period(nChannels);
+	double phase= 0, phaseStep= 2*M_PI*440/samplingRate;
+	double elapsed= 0;
+	uint32_t allocations= 0, blankSteps= 0;
+	for(uint32_t step= 0; step<nSteps+400; step++)
+	{
+		// sweep from 10ms to 1s and back, while the window width changes as well. the first two sweeps
+		// fill the history and only warm up.
+		double t= double(step%200)/100;
+		settings.displaySamples= uint32_t(samplingRate*0.01*pow(100, t<1? t: 2-t));
+		settings.columns= 1280+(step%7)*64;
+		makeTestPeriod(period, periodSize, phase, phaseStep);
+		uint32_t allocationsBefore= __atomic_load_n(&gAllocationCount, __ATOMIC_RELAXED);
+		double start= getTime();
+		processor.setSettings(settings);
+		for(uint32_t ch= 0; ch<nChannels; ch++)
+			ringBuffer.writeChannel(ch, &period[ch][0], periodSize);
+		ringBuffer.commitWrite(periodSize);
+		processor.processPending();
+		processor.updateDisplayFrame();
+		if(step<400) continue;
+		elapsed+= getTime()-start;
+		allocations+= __atomic_load_n(&gAllocationCount, __ATOMIC_RELAXED)-allocationsBefore;
+		// the sine is on the whole trace, so a column of silence means the history was thrown away
+		const DisplayFrame &frame= processor.getDisplayFrame();
+		for(uint32_t c= 0; c<frame.width; c++)
+			if(frame.coords[c].y==0 && frame.coords[c].y1==0) { blankSteps++; break; }
+	}
+	processor.setRingBuffer(0);
+	printf("\nzoom: %.1fus per step, %u channels, %u allocations, %u steps with a blank trace\n",
+		   elapsed*1000000/nSteps, nChannels, allocations, blankSteps);
+	return !allocations && !blankSteps;
+}
+
+// processing cost per period for growing channel counts, scrolling 0.1s over 1280 columns. should grow
+// about linearly with the number of channels.
+void benchmarkChannelScaling()
+{
+	const uint32_t periodSize= 256, nPeriods= 1000, width= 1280;
+	const float samplingRate= 48000;
+	const unsigned channelCounts[]= { 2, 8, 32, 64 };
+
+	printf("\nchannel scaling: us per %u-frame period\n", periodSize);
+	for(unsigned c= 0; c<sizeof(channelCounts)/sizeof(channelCounts[0]); c++)
+	{
+		unsigned nChannels= channelCounts[c];
+		SampleRingBuffer ringBuffer(nChannels, periodSize*2);
+		ScopeProcessor processor;
+		ScopeSettings settings;
+		settings.channels= nChannels;
+		settings.displaySamples= uint32_t(0.1*samplingRate);
+		settings.columns= width;
+		settings.trigger.enabled= false;
+		settings.samplingRate= samplingRate;
+		processor.setSettings(settings);
+		processor.setRingBuffer(&ringBuffer);
+		processor.processPending();
+
+		vector< vector<jack_default_audio_sample_t> > period(nChannels);
+		double phase= 0, phaseStep= 2*M_PI*440/samplingRate;
+		double elapsed= 0;
+		for(uint32_t p= 0; p<nPeriods; p++)
+		{
+			makeTestPeriod(period, periodSize, phase, phaseStep);
+			double start= getTime();
+			for(uint32_t ch= 0; ch<nChannels; ch++)
+				ringBuffer.writeChannel(ch, &period[ch][0], periodSize);
+			ringBuffer.commitWrite(periodSize);
+			processor.processPending();
+			processor.updateDisplayFrame();
+			elapsed+= getTime()-start;
+		}
+		printf("  %3u channels: %7.1f\n", nChannels, elapsed*1000000/nPeriods);
+	}
+}
+
+// replay a generated float WAV file through the whole processing thread as fast as possible. checks that
+// every frame of the file has been processed, none dropped.
+bool benchmarkFileReplay()
+{
+	const unsigned nChannels= 8;
+	const uint32_t nFrames= 48000*20;
+	const float samplingRate= 48000;
+
+	char filename[]= "/tmp/fluxscope-replay-XXXXXX";
+	int fd= mkstemp(filename);
+	FILE *f= (fd>=0? fdopen(fd, "wb"): 0);
+	if(!f)
+	{
+		printf("\nfile replay: couldn't create a temporary file\n");
+		return false;
+	}
+	// float32 WAV header, then the samples. assumes a little endian host like the rest of the benchmarks.
+	uint32_t dataSize= nFrames*nChannels*4, u32;
+	uint16_t u16;
+	fwrite("RIFF", 4, 1, f); u32= 36+dataSize; fwrite(&u32, 4, 1, f); fwrite("WAVEfmt ", 8, 1, f);
+	u32= 16; fwrite(&u32, 4, 1, f);
+	u16= 3; fwrite(&u16, 2, 1, f); u16= nChannels; fwrite(&u16, 2, 1, f);
+	u32= samplingRate; fwrite(&u32, 4, 1, f); u32= samplingRate*nChannels*4; fwrite(&u32, 4, 1, f);
+	u16= nChannels*4; fwrite(&u16, 2, 1, f); u16= 32; fwrite(&u16, 2, 1, f);
+	fwrite("data", 4, 1, f); fwrite(&dataSize, 4, 1, f);
+	vector<float> frame(nChannels);
+	for(uint32_t i= 0; i<nFrames; i++)
+	{
+		for(unsigned ch= 0; ch<nChannels; ch++)
+			frame[ch]= 0.5*sin(2*M_PI*(440+110*ch)*i/samplingRate);
+		fwrite(&frame[0], 4, nChannels, f);
+	}
+	bool written= !ferror(f);
+	if(fclose(f) || !written)
+	{
+		printf("\nfile replay: couldn't write %s\n", filename);
+		unlink(filename);
+		return false;
+	}
+
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= nChannels;
+	settings.displaySamples= uint32_t(0.1*samplingRate);
+	settings.columns= 1280;
+	settings.trigger.enabled= true;
+	settings.trigger.level= 0.1;
+	settings.samplingRate= samplingRate;
+	processor.setSettings(settings);
+	processor.enableSignalStats(true);
+
+	FileInputSource input(filename);
+	input.setSpeed(0);
+	double start= getTime();
+	bool ok= input.initialize(nChannels);
+	SampleRingBuffer *ringBuffer= input.getRingBuffer();
+	if(ok)
+	{
+		processor.setRingBuffer(ringBuffer);
+		processor.start();
+		while(!input.isFinished() || ringBuffer->getReadSpace())
+			SDL_Delay(1);
+	}
+	double elapsed= getTime()-start;
+	processor.stop();
+	processor.setRingBuffer(0);
+	input.shutdown();
+	unlink(filename);
+
+	vector<SignalStats> stats;
+	uint32_t sweeps;
+	processor.takeSignalStats(stats, sweeps);
+	ok= ok && stats.size()==nChannels && stats[0].count==nFrames && !ringBuffer->getDroppedFrames();
+	printf("\nfile replay: %u channels, %.1f s of samples in %.3f s (%.0fx realtime, %u sweeps)%s\n",
+		   nChannels, nFrames/samplingRate, elapsed, nFrames/samplingRate/elapsed, sweeps, ok? "": " FAILED");
+	return ok;
+}
+
+// the original PeakTracker::run which scans the whole window for every sample.
+// kept as reference for benchmarkPeakTracker().
+class ScanningPeakTracker
+{
+    public:
+        enum { MAXSAMPLES= 16 };
+
+        ScanningPeakTracker(): peak(0), peakFiltered(0), sampleIndex(0)
+        { memset(buf, 0, sizeof(buf)); setNumSamples(1); }
+
+        void setNumSamples(double n)
+        {
+            if(n>128) n= 128;
+            peakStep= 1.0/pow(n, 1.5);
+            peakStep2= 10*peakStep; if(peakStep2>1.0) peakStep2= 1.0;
+            n= (n>MAXSAMPLES-1? MAXSAMPLES-1: n<1? 1: n);
+            nSamples= n+0.5;
+        }
+
+        float run(float value)
+        {
+            buf[sampleIndex&(MAXSAMPLES-1)]= value;
+            peak= 0;
+            for(int i= nSamples-1; i>=0; i--)
+            {
+                float sample= buf[(sampleIndex+MAXSAMPLES-i) & (MAXSAMPLES-1)];
+                float sAbs= fabs(sample);
+                if(sAbs>peak)
+                    peak= sAbs;
+            }
+            sampleIndex++;
+            peakFiltered+= (peak-peakFiltered) * (peak>peakFiltered? peakStep2: peakStep);
+            return peakFiltered;
+        }
+
+    private:
+        float peak;
+        double peakFiltered;
+        float peakStep, peakStep2;
+        unsigned nSamples, sampleIndex;
+        float buf[MAXSAMPLES];
+};
+
+// compare the block-based PeakTracker against the original per-sample scan, for output and speed, on
+// 8 channels like the processing does. the window size changes now and then, like it does when zooming.
+bool benchmarkPeakTracker()
+{
+	const uint32_t periodSize= 64, nPeriods= 10000, nChannels= 8;
+	const double windowSizes[]= { 1, 4, 8, 15 };
+	bool ok= true;
+
+	printf("\npeak tracker: Msamples/s, %u channels, scan -> block\n", nChannels);
+	for(unsigned w= 0; w<sizeof(windowSizes)/sizeof(windowSizes[0]); w++)
+	{
+		vector<ScanningPeakTracker> scanning(nChannels);
+		vector<PeakTracker> block(nChannels);
+		uint32_t nFrames= periodSize*nPeriods;
+		vector<float> input(nFrames*nChannels), scanOutput(input.size()), blockOutput(input.size());
+		srand(w);
+		for(uint32_t i= 0; i<input.size(); i++)
+			input[i]= sin(i*0.001)*(rand()&0xFFFF)/65536.0;
+
+		double start= getTime();
+		for(uint32_t p= 0; p<nPeriods; p++)
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				scanning[ch].setNumSamples(windowSizes[w] * (p%1000<500? 1: 0.6));
+				for(uint32_t i= ch*nFrames+p*periodSize; i<ch*nFrames+(p+1)*periodSize; i++)
+					scanOutput[i]= scanning[ch].run(input[i]);
+			}
+		double scanTime= getTime()-start;
+
+		start= getTime();
+		for(uint32_t p= 0; p<nPeriods; p++)
+		{
+			const float *in[nChannels];
+			float *out[nChannels];
+			for(unsigned ch= 0; ch<nChannels; ch++)
+			{
+				block[ch].setNumSamples(windowSizes[w] * (p%1000<500? 1: 0.6));
+				in[ch]= &input[ch*nFrames+p*periodSize];
+				out[ch]= &blockOutput[ch*nFrames+p*periodSize];
+			}
+			PeakTracker::run(&block[0], in, out, nChannels, periodSize);
+		}
+		double blockTime= getTime()-start;
+
+		bool identical= !memcmp(&scanOutput[0], &blockOutput[0], input.size()*sizeof(float));
+		printf("  window %4.1f: %8.1f -> %8.1f  (%.1fx) %s\n", windowSizes[w],
+			   input.size()/scanTime/1e6, input.size()/blockTime/1e6, scanTime/blockTime,
+			   identical? "identical": "OUTPUT DIFFERS");
+		if(!identical) ok= false;
+	}
+	return ok;
+}
+
+// compare every supported edge search kernel against the scalar one on random data (including values
+// exactly at the trigger level and NaNs), then measure throughput on a block of many channels
+bool benchmarkTriggerSearch()
+{
+	KernelList<EdgeSearchFunc> kernels= getEdgeSearchKernels();
+	bool ok= true;
+	unsigned nCases= 0, nMismatches= 0;
+	vector<float> data(256);
+	srand(1);
+	for(int trial= 0; trial<20000; trial++)
+	{
+		uint32_t offset= rand()%8, nFrames= rand()%(data.size()-offset);
+		float level= (rand()%5-2)*0.25f;
+		for(uint32_t i= 0; i<data.size(); i++)
+		{
+			int r= rand()%64;
+			data[i]= (r==0? NAN: r<8? level: (rand()%9-4)*0.25f + (r&1? 0: (rand()&0xFF)/1024.0f));
+		}
+		// mostly sparse crossings so that the vector loops run for a while
+		if(trial&1) for(uint32_t i= 0; i+1<data.size(); i++)
+			if(rand()%32) data[i+1]= (level>0? level-1: level+1);
+		float prev= data[offset?offset-1:0];
+		for(int rising= 0; rising<2; rising++)
+		{
+			int expected= findEdgeScalar(&data[offset], nFrames, prev, level, rising);
+			for(unsigned k= 0; k<kernels.size(); k++)
+			{
+				if(!kernels[k].supported) continue;
+				nCases++;
+				if(kernels[k].func(&data[offset], nFrames, prev, level, rising)!=expected)
+					nMismatches++;
+			}
+		}
+	}
+	printf("\ntrigger search: %u cases, %u mismatches\n", nCases, nMismatches);
+	if(nMismatches) ok= false;
+
+	// 64 channels of one second at 192kHz, searched channel by channel. the signal has a trigger
+	// every 4096 samples, like a scope triggering on a ~47Hz signal. the whole block doesn't fit into the
+	// caches, so the kernels are also timed on the first 16k samples of a channel, which do. the kernels
+	// take turns, so that a changing clock speed doesn't favour any of them, and each figure is the best
+	// of a few runs.
+	const uint32_t rate= 192000, nChannels= 64, cachedFrames= 16384, nRuns= 5;
+	vector<float> block(rate*nChannels);
+	for(uint32_t i= 0; i<block.size(); i++)
+		block[i]= sin(i*2*M_PI/4096.0)*0.5;
+	vector<double> best(kernels.size()*2, 1e9);
+	unsigned nTriggers= 0;
+	for(uint32_t run= 0; run<nRuns; run++)
+		for(unsigned k= 0; k<kernels.size(); k++)
+		{
+			if(!kernels[k].supported) continue;
+			for(int whole= 0; whole<2; whole++)
+			{
+				uint32_t nFrames= (whole? rate: cachedFrames), channels= (whole? nChannels: 1), repeat= (whole? 1: 64);
+				nTriggers= 0;
+				double start= getTime();
+				for(uint32_t r= 0; r<repeat; r++)
+					for(uint32_t ch= 0; ch<channels; ch++)
+					{
+						const float *chanData= &block[ch*rate];
+						float prev= 0;
+						uint32_t pos= 0;
+						while(pos<nFrames)
+						{
+							int found= kernels[k].func(chanData+pos, nFrames-pos, prev, 0.25f, true);
+							if(found<0) break;
+							nTriggers++;
+							pos+= found;
+							prev= chanData[pos++];
+						}
+					}
+				best[k*2+whole]= min(best[k*2+whole], (getTime()-start)/(double(nFrames)*channels*repeat));
+			}
+		}
+	printf("trigger search: Msamples/s in cache / %u channels at %u Hz\n", nChannels, rate);
+	for(unsigned k= 0; k<kernels.size(); k++)
+	{
+		if(!kernels[k].supported)
+			printf("  %-8s not supported by this CPU\n", kernels[k].name);
+		else
+			printf("  %-8s %8.1f / %8.1f  (%u triggers, %.0fx realtime)\n", kernels[k].name,
+				   1e-6/best[k*2], 1e-6/best[k*2+1], nTriggers, 1/(best[k*2+1]*rate));
+	}
+	return ok;
+}
+
+// trigger engine throughput on a noisy 1kHz sine at 192kHz, fed in jack sized periods. the trigger
+// counts show how hysteresis suppresses retriggering on noise.
+void benchmarkTriggerEngine()
+{
+	const uint32_t rate= 192000, periodSize= 256, nSamples= rate*4;
+	vector<float> signal(nSamples);
+	srand(2);
+	for(uint32_t i= 0; i<nSamples; i++)
+		signal[i]= sin(i*2*M_PI*1000/rate)*0.5 + ((rand()&0xFFFF)/65536.0-0.5)*0.2;
+
+	struct { const char *name; int type; float hysteresis; } configs[]=
+	{
+		{ "edge", TriggerSettings::TT_EDGE, 0 },
+		{ "edge, hysteresis 0.25", TriggerSettings::TT_EDGE, 0.25 },
+		{ "pulse < 0.4ms", TriggerSettings::TT_PULSE_SHORTER, 0.25 },
+		{ "pulse > 0.4ms", TriggerSettings::TT_PULSE_LONGER, 0.25 },
+		{ "runt", TriggerSettings::TT_RUNT, 0.25 },
+	};
+	printf("\ntrigger engine: Msamples/s, %u seconds at %u Hz\n", nSamples/rate, rate);
+	for(unsigned c= 0; c<sizeof(configs)/sizeof(configs[0]); c++)
+	{
+		TriggerSettings s;
+		s.type= configs[c].type;
+		s.level= 0.1;
+		s.hysteresis= configs[c].hysteresis;
+		s.pulseWidth= 0.0004;
+		s.runtLevel= 0.6;
+		TriggerEngine engine;
+		engine.setSettings(s, rate);
+		unsigned nTriggers= 0;
+		double start= getTime();
+		for(uint32_t period= 0; period<nSamples; period+= periodSize)
+		{
+			const float *data= &signal[period];
+			uint32_t pos= 0;
+			int found;
+			while(pos<periodSize && (found= engine.find(data+pos, periodSize-pos))>=0)
+			{
+				nTriggers++;
+				pos+= found;
+				engine.skip(data+pos, 1);
+				pos++;
+				engine.arm();
+			}
+		}
+		double elapsed= getTime()-start;
+		printf("  %-22s %8.1f  (%u triggers)\n", configs[c].name, nSamples/elapsed/1e6, nTriggers);
+	}
+}
+
+// checks the FFT against a direct DFT and with a full scale tone at each size, and compares the
+// butterfly kernels. the throughput is given as transforms per second and as the number of channels
+// which could be analyzed at 192kHz with 50% overlap.
+bool benchmarkFFT()
+{
+	KernelList<ButterflyFunc> kernels= getButterflyKernels();
+	bool ok= true;
+
+	// direct DFT of noise, in double precision
+	const uint32_t dftSize= 1024;
+	vector<float> input(dftSize), power(dftSize/2+1);
+	srand(3);
+	for(uint32_t i= 0; i<dftSize; i++)
+		input[i]= (rand()&0xFFFF)/32768.0-1;
+	double maxError= 0, maxMagnitude= 0;
+	for(unsigned k= 0; k<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		RealFFT fft;
+		fft.setSize(dftSize);
+		fft.setButterflyFunc(kernels[k].func);
+		fft.powerSpectrum(&input[0], &power[0]);
+		for(uint32_t bin= 0; bin<=dftSize/2; bin++)
+		{
+			double re= 0, im= 0;
+			for(uint32_t i= 0; i<dftSize; i++)
+				re+= input[i]*cos(2*M_PI*bin*i/dftSize),
+				im-= input[i]*sin(2*M_PI*bin*i/dftSize);
+			double magnitude= sqrt(re*re+im*im);
+			maxMagnitude= max(maxMagnitude, magnitude);
+			maxError= max(maxError, fabs(sqrt(power[bin])-magnitude));
+		}
+	}
+	printf("\nFFT: error against direct DFT %.2g (relative to the largest bin)\n", maxError/maxMagnitude);
+	if(maxError/maxMagnitude>1e-4) ok= false;
+
+	printf("FFT: microseconds per transform, channels at 192kHz with 50%% overlap\n");
+	printf("  %-6s", "size");
+	for(unsigned k= 0; k<kernels.size(); k++)
+		if(kernels[k].supported) printf(" %20s", kernels[k].name);
+	printf("   tone\n");
+	for(uint32_t size= 1024; size<=65536; size*= 2)
+	{
+		// a full scale tone centered on bin size/8 should show up there at 0dB with the analyzer's scaling
+		input.resize(size);
+		power.resize(size/2+1);
+		for(uint32_t i= 0; i<size; i++)
+			input[i]= sin(2*M_PI*i/8)*(0.5-0.5*cos(2*M_PI*i/size));
+		printf("  %-6u", size);
+		float tone= 0;
+		for(unsigned k= 0; k<kernels.size(); k++)
+		{
+			if(!kernels[k].supported) continue;
+			RealFFT fft;
+			fft.setSize(size);
+			fft.setButterflyFunc(kernels[k].func);
+			uint32_t nRuns= max(4*1048576/size, 8u);
+			double start= getTime();
+			for(uint32_t run= 0; run<nRuns; run++)
+				fft.powerSpectrum(&input[0], &power[0]);
+			double perTransform= (getTime()-start)/nRuns;
+			printf(" %9.1f (%5.0f ch)", perTransform*1e6, 1/(perTransform*192000.0/(size/2)));
+			uint32_t peak= max_element(power.begin(), power.end())-power.begin();
+			tone= 10*log10(power[size/8]*4/(size*.5*size*.5));
+			if(peak!=size/8 || fabs(tone)>0.01) ok= false;
+		}
+		printf("   %.3fdB\n", tone);
+	}
+	return ok;
+}
+
+// largest difference of the line display between the frames published while a sine is triggered on. the
+// period is not a whole number of samples, so every sweep starts at a different sub-sample offset.
+float measureSweepJitter(bool sinc, double frequency, float rate)
+{
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= 1;
+	settings.columns= 800;
+	settings.displaySamples= 24;
+	settings.samplingRate= rate;
+	settings.trigger.level= 0.2;
+	settings.trigger.position= 0.5;
+	settings.sincInterpolation= sinc;
+	processor.setSettings(settings);
+	SampleRingBuffer ringBuffer(1, 4096);
+	processor.setRingBuffer(&ringBuffer);
+	vector<float> period(256), reference;
+	float maxDifference= 0;
+	for(uint32_t n= 0; n<400; n++)
+	{
+		for(uint32_t i= 0; i<period.size(); i++)
+			period[i]= sin(2*M_PI*frequency*(n*period.size()+i)/rate)*0.5;
+		ringBuffer.writeChannel(0, &period[0], period.size());
+		ringBuffer.commitWrite(period.size());
+		processor.processPending();
+		if(!processor.updateDisplayFrame()) continue;
+		const DisplayFrame &frame= processor.getDisplayFrame();
+		if(frame.triggerStatus!=DisplayFrame::TS_TRIGGERED || n<10) continue;
+		if(reference.empty())
+		{
+			for(uint32_t i= 0; i<frame.width; i++)
+				reference.push_back(frame.coords[i].y);
+			continue;
+		}
+		for(uint32_t i= 0; i<frame.width; i++)
+			maxDifference= max(maxDifference, float(fabs(frame.coords[i].y-reference[i])));
+	}
+	processor.setRingBuffer(0);
+	return maxDifference;
+}
+
+bool benchmarkSubSample()
+{
+	bool ok= true;
+	const float rate= 48000;
+	const double frequency= 1234.5;
+	const uint32_t nSamples= 48000;
+	vector<float> signal(nSamples);
+	for(uint32_t i= 0; i<nSamples; i++)
+		signal[i]= sin(2*M_PI*frequency*i/rate)*0.5;
+
+	// trigger crossings against the exact ones, with and without the interpolated fraction
+	TriggerSettings ts;
+	ts.level= 0.2;
+	TriggerEngine engine;
+	engine.setSettings(ts, rate);
+	double crossingPhase= asin(0.4)/(2*M_PI), maxError= 0, maxWholeError= 0;
+	for(uint32_t pos= 0; pos<nSamples; )
+	{
+		int found= engine.find(&signal[pos], nSamples-pos);
+		if(found<0) break;
+		pos+= found;
+		double cycles= pos*frequency/rate-crossingPhase;
+		double exact= (floor(cycles)+crossingPhase)*rate/frequency;
+		maxError= max(maxError, fabs(pos-engine.getTriggerFraction()-exact));
+		maxWholeError= max(maxWholeError, fabs(pos-exact));
+		engine.skip(&signal[pos], 1);
+		pos++;
+	}
+	printf("\nsub-sample trigger: crossing error %.4f samples (%.4f without interpolation)\n", maxError, maxWholeError);
+	if(maxError>0.02) ok= false;
+
+	// reconstruction of a band-limited signal between its samples
+	const double tones[]= { 0.05, 0.17, 0.31 };
+	const uint32_t n= 4096;
+	vector<float> bandLimited(n);
+	for(uint32_t i= 0; i<n; i++)
+		bandLimited[i]= 0.3*(sin(2*M_PI*tones[0]*i) + sin(2*M_PI*tones[1]*i+1) + sin(2*M_PI*tones[2]*i+2));
+	SincInterpolator sinc;
+	const int before= SincInterpolator::TAPS/2-1;
+	const uint32_t nPoints= 10000, nRuns= 100;
+	vector<uint32_t> positions(nPoints);
+	vector<float> fractions(nPoints);
+	srand(7);
+	for(uint32_t k= 0; k<nPoints; k++)
+		positions[k]= before + rand()%(n-SincInterpolator::TAPS),
+		fractions[k]= (rand()&0xFFFF)/65536.0;
+	float sum= 0;
+	double start= getTime();
+	for(uint32_t run= 0; run<nRuns; run++)
+		for(uint32_t k= 0; k<nPoints; k++)
+			sum+= sinc.interpolate(&bandLimited[positions[k]-before], fractions[k]);
+	double elapsed= getTime()-start;
+	double sincError= 0, linearError= 0;
+	for(uint32_t k= 0; k<nPoints; k++)
+	{
+		uint32_t i= positions[k];
+		float fraction= fractions[k];
+		double t= i+fraction,
+			   exact= 0.3*(sin(2*M_PI*tones[0]*t) + sin(2*M_PI*tones[1]*t+1) + sin(2*M_PI*tones[2]*t+2));
+		sincError= max(sincError, fabs(sinc.interpolate(&bandLimited[i-before], fraction)-exact));
+		linearError= max(linearError, fabs(bandLimited[i]+(bandLimited[i+1]-bandLimited[i])*fraction-exact));
+	}
+	printf("sinc reconstruction: error %.4f (linear %.4f), %.1f ns per point%s\n", sincError, linearError,
+		   elapsed/(nPoints*nRuns)*1e9, sum==12345? " ": "");
+	if(sincError>0.05 || sincError>linearError) ok= false;
+
+	// the displayed trace shouldn't move between sweeps
+	float linearJitter= measureSweepJitter(false, frequency, rate), sincJitter= measureSweepJitter(true, frequency, rate);
+	printf("sweep to sweep jitter at 0.5ms/sweep: %.4f linear, %.4f sinc (%.4f for one sample)\n", linearJitter, sincJitter,
+		   0.5*2*M_PI*frequency/rate);
+	if(sincJitter>0.05) ok= false;
+	return ok;
+}
+
+// gain of a filter chain for a sine of the given frequency in dB, measured after the filters have settled
+double measureFilterGain(const FilterSettings &settings, float rate, double frequency)
+{
+	FilterChain chain;
+	chain.setSettings(settings, 1, rate, 0);
+	uint32_t nFrames= uint32_t(rate/2);
+	vector<jack_default_audio_sample_t> input(nFrames);
+	for(uint32_t i= 0; i<nFrames; i++)
+		input[i]= sin(2*M_PI*frequency*i/rate);
+	jack_default_audio_sample_t *data= &input[0];
+	uint32_t n= chain.process(&data, nFrames);
+	const jack_default_audio_sample_t *out= chain.getOutputs()[0];
+	double sumSquares= 0;
+	for(uint32_t i= n/2; i<n; i++)
+		sumSquares+= out[i]*out[i];
+	return 10*log10(sumSquares/(n-n/2)*2);
+}
+
+bool benchmarkFilterBank()
+{
+	KernelList<BiquadFunc> kernels= getBiquadKernels();
+	bool ok= true;
+#if defined(__i386__) || defined(__x86_64__)
+	_mm_setcsr(_mm_getcsr() | 0x8040);
+#endif
+
+	// 12 channels of noise, so that one group of lanes is only partly used, each with its own cutoff,
+	// against the double precision cascade
+	const unsigned nChannels= 12;
+	const uint32_t nFrames= 10000;
+	const float rate= 48000;
+	vector< vector<float> > input(nChannels, vector<float>(nFrames)), output(nChannels, vector<float>(nFrames));
+	vector<float*> inPointers(nChannels), outPointers(nChannels);
+	srand(5);
+	for(unsigned ch= 0; ch<nChannels; ch++)
+	{
+		for(uint32_t i= 0; i<nFrames; i++)
+			input[ch][i]= (rand()&0xFFFF)/32768.0-1;
+		inPointers[ch]= &input[ch][0];
+		outPointers[ch]= &output[ch][0];
+	}
+	double maxError= 0;
+	for(unsigned k= 0; k<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		BiquadBank bank;
+		bank.setKernel(kernels[k].func);
+		vector<Butterworth> reference(nChannels);
+		for(unsigned ch= 0; ch<nChannels; ch++)
+		{
+			reference[ch].setFrequency(200+ch*700, rate, ch&1);
+			if(!ch) bank.setup(nChannels, reference[ch].getNumSections());
+			for(int i= 0; i<reference[ch].getNumSections(); i++)
+				bank.setSection(ch, i, reference[ch].getSection(i));
+		}
+		// odd block sizes, so that the blocks of the bank don't line up with the calls
+		unsigned phase= 0;
+		for(uint32_t pos= 0; pos<nFrames; )
+		{
+			uint32_t n= min(nFrames-pos, 777u);
+			vector<float*> in(nChannels), out(nChannels);
+			for(unsigned ch= 0; ch<nChannels; ch++)
+				in[ch]= inPointers[ch]+pos, out[ch]= outPointers[ch]+pos;
+			bank.process(&in[0], &out[0], n, 1, phase);
+			pos+= n;
+		}
+		for(unsigned ch= 0; ch<nChannels; ch++)
+			for(uint32_t i= 0; i<nFrames; i++)
+				maxError= max(maxError, fabs(output[ch][i]-reference[ch].run(input[ch][i])));
+	}
+	printf("\nfilter bank: error against double precision Butterworth %.2g\n", maxError);
+	if(maxError>1e-4) ok= false;
+
+	// response of the filter chain at 48kHz, and the anti-aliasing of 4x decimation at 192kHz
+	FilterSettings lowpass, highpass, decimate;
+	lowpass.type= FilterSettings::FT_LOWPASS;
+	lowpass.lowpassFrequency= 1000;
+	highpass.type= FilterSettings::FT_HIGHPASS;
+	highpass.highpassFrequency= 1000;
+	decimate.decimation= 4;
+	struct { const char *name; FilterSettings *settings; float rate; double frequency, minGain, maxGain; } responses[]=
+	{
+		{ "low pass 1kHz", &lowpass, 48000, 100, -0.1, 0.1 },
+		{ "low pass 1kHz", &lowpass, 48000, 1000, -3.1, -2.9 },
+		{ "low pass 1kHz", &lowpass, 48000, 10000, -200, -70 },
+		{ "high pass 1kHz", &highpass, 48000, 100, -200, -70 },
+		{ "high pass 1kHz", &highpass, 48000, 10000, -0.1, 0.1 },
+		{ "decimate 4x", &decimate, 192000, 1000, -0.1, 0.1 },
+		{ "decimate 4x", &decimate, 192000, 40000, -200, -40 },
+	};
+	printf("filter chain: response\n");
+	for(unsigned i= 0; i<sizeof(responses)/sizeof(responses[0]); i++)
+	{
+		double gain= measureFilterGain(*responses[i].settings, responses[i].rate, responses[i].frequency);
+		bool pass= (gain>=responses[i].minGain && gain<=responses[i].maxGain);
+		printf("  %-15s %6.0fHz %8.2fdB%s\n", responses[i].name, responses[i].frequency, gain, pass? "": " FAILED");
+		if(!pass) ok= false;
+	}
+
+	// 64 channels through 4 sections, like a band pass
+	printf("filter bank: 64 channels, 4 sections; million frames per second, channels at 192kHz\n");
+	const unsigned nBig= 64;
+	const uint32_t blockFrames= 1024;
+	vector< vector<float> > big(nBig, vector<float>(blockFrames));
+	vector<float*> bigPointers(nBig);
+	for(unsigned ch= 0; ch<nBig; ch++)
+	{
+		for(uint32_t i= 0; i<blockFrames; i++)
+			big[ch][i]= (rand()&0xFFFF)/32768.0-1;
+		bigPointers[ch]= &big[ch][0];
+	}
+	Butterworth design;
+	design.setFrequency(1000, rate);
+	for(unsigned k= 0; k<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		BiquadBank bank;
+		bank.setKernel(kernels[k].func);
+		bank.setup(nBig, 4);
+		for(unsigned ch= 0; ch<nBig; ch++)
+			for(unsigned i= 0; i<4; i++)
+				bank.setSection(ch, i, design.getSection(i&1));
+		uint32_t nRuns= 500;
+		unsigned phase= 0;
+		double start= getTime();
+		for(uint32_t run= 0; run<nRuns; run++)
+			bank.process(&bigPointers[0], &bigPointers[0], blockFrames, 1, phase);
+		double elapsed= getTime()-start;
+		double framesPerSecond= double(nRuns)*blockFrames/elapsed;
+		printf("  %-8s %8.2f %8.0f\n", kernels[k].name, framesPerSecond*1e-6, framesPerSecond/192000*nBig);
+	}
+	return ok;
+}
+
+bool benchmarkPhosphor()
+{
+	KernelList<PhosphorFuncs> kernels= getPhosphorKernels();
+	bool ok= true;
+
+	// the kernels against the scalar one, on a histogram with an odd size
+	const size_t nPixels= 100003;
+	vector<float> random(nPixels);
+	srand(11);
+	for(size_t i= 0; i<nPixels; i++)
+		random[i]= (rand()%8? 0: rand()%1000);
+	const PhosphorFuncs &scalar= kernels.back().func;
+	vector<float> reference(random);
+	vector<uint8_t> referenceLevels(nPixels), levels(nPixels);
+	float referenceLargest= scalar.decay(&reference[0], nPixels, 0.9f);
+	scalar.levels(&reference[0], &referenceLevels[0], nPixels, 255*255/referenceLargest);
+	for(unsigned k= 0; k+1<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		vector<float> hits(random);
+		float largest= kernels[k].func.decay(&hits[0], nPixels, 0.9f);
+		kernels[k].func.levels(&hits[0], &levels[0], nPixels, 255*255/largest);
+		if(largest!=referenceLargest || hits!=reference || levels!=referenceLevels)
+		{
+			printf("phosphor kernel %s differs from the scalar one\n", kernels[k].name);
+			ok= false;
+		}
+	}
+
+	// NaN, infinity and negative values come out the same in all kernels, in the SIMD part as well
+	float special[32];
+	uint8_t referenceSpecial[32], specialLevels[32];
+	for(int i= 0; i<32; i++)
+		special[i]= (i%4==0? NAN: i%4==1? INFINITY: i%4==2? -1.0f: i*100.0f);
+	scalar.levels(special, referenceSpecial, 32, 1);
+	for(unsigned k= 0; k+1<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		kernels[k].func.levels(special, specialLevels, 32, 1);
+		if(memcmp(specialLevels, referenceSpecial, 32))
+		{
+			printf("phosphor kernel %s differs from the scalar one for NaN or infinity\n", kernels[k].name);
+			ok= false;
+		}
+	}
+
+	// a rare glitch among many sweeps of a flat line still lights up its pixels
+	const uint32_t width= 800, sweepSize= 200;
+	PhosphorSettings settings;
+	settings.enabled= true;
+	settings.persistence= 0;
+	PhosphorAccumulator accumulator;
+	accumulator.setSettings(settings, 1, width, sweepSize, 48000);
+	vector<float> sweep(sweepSize+2, 0.0f);
+	const float *sweepPointer= &sweep[0];
+	for(uint32_t i= 0; i<10000; i++)
+		accumulator.addSweep(&sweepPointer, sweepSize, 0);
+	sweep[1+sweepSize/2]= 0.9;
+	accumulator.addSweep(&sweepPointer, sweepSize, 0);
+	PhosphorFrame frame;
+	accumulator.fillFrame(frame, 0);
+	uint32_t glitchRow= uint32_t((1-0.9)/2*settings.rows);
+	int glitchLevel= frame.getChannel(0)[glitchRow*width+width/2], otherLevel= frame.getChannel(0)[glitchRow*width+width/4];
+	printf("\nphosphor: level of a glitch in 1 of 10000 sweeps %d, elsewhere %d\n", glitchLevel, otherLevel);
+	if(!glitchLevel || otherLevel) ok= false;
+
+	// a trace fades to 1/e after the persistence time, which shows as 1/sqrt(e) of the level of a new one
+	settings.persistence= 0.5;
+	accumulator.setSettings(settings, 1, width, sweepSize, 48000);
+	accumulator.clear();
+	sweep.assign(sweepSize+2, 0.5f);
+	accumulator.fillFrame(frame, 0);
+	accumulator.addSweep(&sweepPointer, sweepSize, 0);
+	sweep.assign(sweepSize+2, -0.5f);
+	accumulator.fillFrame(frame, 24000);
+	accumulator.addSweep(&sweepPointer, sweepSize, 0);
+	accumulator.fillFrame(frame, 24000);
+	int oldLevel= frame.getChannel(0)[settings.rows/4*width], newLevel= frame.getChannel(0)[settings.rows*3/4*width];
+	printf("phosphor: level after the persistence time %d, new trace %d (expected %d)\n", oldLevel, newLevel, int(255/sqrt(M_E)));
+	if(newLevel!=255 || abs(oldLevel-int(255/sqrt(M_E)))>1) ok= false;
+
+	// 4 channels of short sweeps of noise into 800x256 histograms, and the frames built from them
+	const unsigned nChannels= 4;
+	settings.persistence= 0.5;
+	accumulator.setSettings(settings, nChannels, width, sweepSize, 48000);
+	vector< vector<float> > noise(nChannels, vector<float>(sweepSize+2));
+	vector<const float*> noisePointers(nChannels);
+	for(unsigned ch= 0; ch<nChannels; ch++)
+	{
+		for(uint32_t i= 0; i<sweepSize+2; i++)
+			noise[ch][i]= (rand()&0xFFFF)/65536.0-.5;
+		noisePointers[ch]= &noise[ch][0];
+	}
+	const uint32_t nSweeps= 2000;
+	double start= getTime();
+	for(uint32_t i= 0; i<nSweeps; i++)
+		accumulator.addSweep(&noisePointers[0], sweepSize, (i&7)/8.0f);
+	double elapsed= getTime()-start;
+	printf("phosphor: %u channels, %ux%u: %.0f waveforms per second; ms per frame:\n", nChannels, width, settings.rows,
+		   nSweeps/elapsed);
+	for(unsigned k= 0; k<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		accumulator.setKernel(kernels[k].func);
+		const uint32_t nFrames= 100;
+		start= getTime();
+		for(uint32_t i= 0; i<nFrames; i++)
+			accumulator.fillFrame(frame, i*800);
+		elapsed= getTime()-start;
+		printf("  %-8s %8.3f\n", kernels[k].name, elapsed/nFrames*1000);
+	}
+	return ok;
+}
+
+// seconds of processing for seconds of 192kHz stereo, with the XY display in the given mode
+double measureXYProcessing(int mode, float seconds)
+{
+	const float rate= 192000;
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= 2;
+	settings.columns= 800;
+	settings.samplingRate= rate;
+	settings.displaySamples= 1920;
+	settings.xy.mode= mode;
+	processor.setSettings(settings);
+	SampleRingBuffer ringBuffer(2, 8192);
+	processor.setRingBuffer(&ringBuffer);
+	XYDisplay display;
+	vector<float> left(1024), right(1024);
+	for(uint32_t i= 0; i<1024; i++)
+		left[i]= sin(2*M_PI*i/64)*.5, right[i]= sin(2*M_PI*i/64+1)*.4;
+	double elapsed= 0;
+	for(uint32_t n= 0; n<uint32_t(seconds*rate/1024); n++)
+	{
+		ringBuffer.writeChannel(0, &left[0], 1024);
+		ringBuffer.writeChannel(1, &right[0], 1024);
+		ringBuffer.commitWrite(1024);
+		double start= getTime();
+		processor.processPending();
+		elapsed+= getTime()-start;
+		display.readPoints(processor.getXYPoints());
+	}
+	processor.setRingBuffer(0);
+	return elapsed;
+}
+
+bool benchmarkCorrelation()
+{
+	bool ok= true;
+	const float rate= 192000;
+	const uint32_t n= 192000;
+	vector<float> sine(n), inverted(n), cosine(n), noise(n), silence(n, 0.0f);
+	srand(13);
+	for(uint32_t i= 0; i<n; i++)
+	{
+		sine[i]= sin(2*M_PI*997*i/rate)*.5;
+		inverted[i]= -sine[i];
+		cosine[i]= cos(2*M_PI*997*i/rate)*.5;
+		noise[i]= (rand()&0xFFFF)/65536.0-.5;
+	}
+	struct { const char *name; const float *y; float min, max; } cases[]=
+	{
+		{ "same signal", &sine[0], .999, 1 },
+		{ "inverted", &inverted[0], -1, -.999 },
+		{ "90 degrees", &cosine[0], -.01, .01 },
+		{ "noise", &noise[0], -.05, .05 },
+		{ "silence", &silence[0], 0, 0 },
+	};
+	printf("\ncorrelation meter:\n");
+	for(unsigned i= 0; i<sizeof(cases)/sizeof(cases[0]); i++)
+	{
+		CorrelationMeter meter;
+		meter.setup(rate);
+		// uneven blocks, like jack periods of different sizes
+		for(uint32_t pos= 0; pos<n; pos+= 1000)
+			meter.add(&sine[pos], cases[i].y+pos, min(n-pos, 1000u));
+		float c= meter.get();
+		bool pass= (c>=cases[i].min && c<=cases[i].max);
+		printf("  %-12s %+7.4f%s\n", cases[i].name, c, pass? "": " FAILED");
+		if(!pass) ok= false;
+	}
+
+	// a signal only on the left shows up on the left diagonal of the goniometer
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= 2;
+	settings.xy.mode= XYSettings::XY_GONIOMETER;
+	processor.setSettings(settings);
+	SampleRingBuffer ringBuffer(2, 4096);
+	processor.setRingBuffer(&ringBuffer);
+	ringBuffer.writeChannel(0, &sine[0], 1000);
+	ringBuffer.writeChannel(1, &silence[0], 1000);
+	ringBuffer.commitWrite(1000);
+	processor.processPending();
+	jack_default_audio_sample_t *points[2];
+	uint32_t nPoints= processor.getXYPoints().getReadPointers(points);
+	float maxError= 0;
+	for(uint32_t i= 0; i<nPoints; i++)
+		maxError= max(maxError, float(fabs(points[0][i]+points[1][i]) + fabs(points[1][i]-sine[i]*M_SQRT1_2)));
+	printf("goniometer: %u points, largest distance from the left diagonal %.2g\n", nPoints, maxError);
+	if(nPoints!=1000 || maxError>1e-6) ok= false;
+	processor.setRingBuffer(0);
+
+	CorrelationMeter meter;
+	meter.setup(rate);
+	const uint32_t nRuns= 100;
+	double start= getTime();
+	for(uint32_t run= 0; run<nRuns; run++)
+		meter.add(&sine[0], &noise[0], n);
+	double elapsed= getTime()-start;
+	printf("correlation meter: %.0f million sample pairs per second\n", double(n)*nRuns/elapsed*1e-6);
+	double plain= measureXYProcessing(XYSettings::XY_OFF, 10), goniometer= measureXYProcessing(XYSettings::XY_GONIOMETER, 10);
+	printf("10s of 192kHz stereo: %.1fms processing, %.1fms with the goniometer\n", plain*1000, goniometer*1000);
+	return ok;
+}
+
+bool benchmarkMeasurements()
+{
+	bool ok= true;
+	const float rate= 48000;
+	const uint32_t n= 48000;
+	// a sine with an offset, and a trapezoid of 100Hz: rising over 20 samples, high for 80, falling over
+	// 40 and low for the rest of the 480 samples
+	vector<float> sine(n), pulse(n);
+	for(uint32_t i= 0; i<n; i++)
+	{
+		sine[i]= sin(2*M_PI*1234.5*i/rate)*.5+.1;
+		uint32_t t= i%480;
+		pulse[i]= (t<20? t/20.0: t<100? 1: t<140? 1-(t-100)/40.0: 0);
+	}
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= 2;
+	settings.samplingRate= rate;
+	settings.measurements= true;
+	processor.setSettings(settings);
+	SampleRingBuffer ringBuffer(2, 4096);
+	processor.setRingBuffer(&ringBuffer);
+	for(uint32_t pos= 0; pos<n; pos+= 480)
+	{
+		ringBuffer.writeChannel(0, &sine[pos], 480);
+		ringBuffer.writeChannel(1, &pulse[pos], 480);
+		ringBuffer.commitWrite(480);
+		processor.processPending();
+	}
+	processor.setRingBuffer(0);
+	vector<Measurement> results;
+	uint32_t serial= processor.getMeasurements(results);
+	printf("\nmeasurements: %u intervals\n", serial);
+	if(results.size()!=2 || serial!=uint32_t(n/(rate*ScopeProcessor::MEASUREMENT_INTERVAL)))
+		return false;
+	const Measurement &a= results[0], &b= results[1];
+	struct { const char *name; double value, expected, tolerance; } checks[]=
+	{
+		{ "sine rms", a.rms, sqrt(.1*.1+.125), 1e-3 },
+		{ "sine mean", a.mean, .1, 1e-3 },
+		{ "sine peak to peak", a.peakToPeak(), 1, 1e-3 },
+		{ "sine frequency", a.frequency, 1234.5, 0.1 },
+		{ "sine duty cycle", a.dutyCycle, .5, 2e-3 },
+		{ "pulse frequency", b.frequency, 100, 1e-3 },
+		{ "pulse duty cycle", b.dutyCycle, 110/480.0, 1e-3 },
+		{ "pulse rise time", b.riseTime, 16/rate, 1e-6 },
+		{ "pulse fall time", b.fallTime, 32/rate, 1e-6 },
+	};
+	for(unsigned i= 0; i<sizeof(checks)/sizeof(checks[0]); i++)
+	{
+		bool pass= (fabs(checks[i].value-checks[i].expected)<=checks[i].tolerance);
+		printf("  %-18s %12.6g, expected %12.6g%s\n", checks[i].name, checks[i].value, checks[i].expected, pass? "": " FAILED");
+		if(!pass) ok= false;
+	}
+
+	MeasurementEngine engine;
+	engine.setRate(rate);
+	Measurement m;
+	const uint32_t nRuns= 50;
+	double start= getTime();
+	for(uint32_t run= 0; run<nRuns; run++)
+	{
+		engine.add(&sine[0], n);
+		engine.take(m);
+	}
+	double elapsed= getTime()-start;
+	printf("measurement engine: %.2f ns per sample%s\n", elapsed/(double(n)*nRuns)*1e9, m.rms==12345? " ": "");
+	return ok;
+}
+
+bool benchmarkMaskTest()
+{
+	KernelList<MaskCompareFunc> kernels= getMaskKernels();
+	bool ok= true;
+
+	// the kernels against the scalar one, on noise with some NaNs and an odd length
+	const uint32_t n= 100003;
+	vector<float> data(n), lower(n), upper(n);
+	srand(23);
+	for(uint32_t i= 0; i<n; i++)
+	{
+		data[i]= (rand()%1000? (rand()&0xFFFF)/32768.0-1: NAN);
+		lower[i]= -0.9+(rand()%100)/1000.0;
+		upper[i]= 0.9-(rand()%100)/1000.0;
+	}
+	uint32_t reference= maskCompareScalar(&data[0], &lower[0], &upper[0], n);
+	printf("\nmask test: %u of %u samples outside of the limits\n", reference, n);
+	for(unsigned k= 0; k+1<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		for(uint32_t len= n-20; len<=n; len++)
+		{
+			if(kernels[k].func(&data[0], &lower[0], &upper[0], len)!=maskCompareScalar(&data[0], &lower[0], &upper[0], len))
+			{
+				printf("mask test kernel %s differs from the scalar one for %u samples\n", kernels[k].name, len);
+				ok= false;
+				break;
+			}
+		}
+	}
+
+	// a mask with limits for all channels and narrower ones for channel 1
+	char filename[]= "/tmp/fluxscope-mask-XXXXXX";
+	int fd= mkstemp(filename);
+	FILE *f= (fd>=0? fdopen(fd, "w"): 0);
+	if(!f)
+	{
+		printf("mask test: couldn't create a temporary file\n");
+		return false;
+	}
+	fprintf(f, "# channel position lower upper\n* 0 -0.6 0.6\n\n1 1 -0.2 0.2\n1 0 -0.2 0.2\n1 0.5 -0.4 0.4\n");
+	fclose(f);
+	Mask mask;
+	bool loaded= mask.load(filename);
+	unlink(filename);
+	if(!loaded) return false;
+	float l[5], u[5];
+	if(!mask.resample(1, 5, l, u) || u[0]!=.2f || fabs(u[1]-.3)>1e-6 || u[2]!=.4f || l[3]!=-.3f || !mask.resample(0, 5, l, u) ||
+	   l[4]!=-.6f || u[2]!=.6f || !mask.getPoints(7))
+	{
+		printf("mask test: the mask wasn't read or resampled correctly\n");
+		ok= false;
+	}
+
+	// free running sweeps of a sine on channel 0, and a glitch on channel 1 in just one of them
+	const float rate= 48000;
+	const uint32_t sweepSize= 480, nSweeps= 100, glitchPos= 37*sweepSize+240;
+	vector<float> sine(sweepSize*nSweeps), flat(sweepSize*nSweeps, 0.0f);
+	for(uint32_t i= 0; i<sine.size(); i++)
+		sine[i]= 0.5*sin(2*M_PI*1000*i/rate);
+	flat[glitchPos]= 0.5;
+	ScopeProcessor processor;
+	CaptureQueue failures;
+	processor.setMask(&mask);
+	processor.setMaskFailureQueue(&failures);
+	ScopeSettings settings;
+	settings.channels= 2;
+	settings.samplingRate= rate;
+	settings.displaySamples= sweepSize;
+	settings.trigger.enabled= false;
+	settings.maskTest= true;
+	processor.setSettings(settings);
+	SampleRingBuffer ringBuffer(2, 4096);
+	processor.setRingBuffer(&ringBuffer);
+	for(uint32_t pos= 0; pos<sine.size(); pos+= 256)
+	{
+		uint32_t len= min(256u, uint32_t(sine.size())-pos);
+		ringBuffer.writeChannel(0, &sine[pos], len);
+		ringBuffer.writeChannel(1, &flat[pos], len);
+		ringBuffer.commitWrite(len);
+		processor.processPending();
+	}
+	processor.setRingBuffer(0);
+	MaskResults results;
+	processor.getMaskResults(results);
+	SweepCapture failure;
+	bool captured= failures.read(failure);
+	printf("mask test: %u sweeps, %u failed, %llu and %llu samples outside\n", results.sweeps, results.failedSweeps,
+		   (unsigned long long)(results.violations.size()>0? results.violations[0]: 0),
+		   (unsigned long long)(results.violations.size()>1? results.violations[1]: 0));
+	if(results.sweeps!=nSweeps || results.failedSweeps!=1 || results.violations.size()!=2 || results.violations[0] ||
+	   results.violations[1]!=1 || !captured || failures.read(failure) ||
+	   failure.getChannel(1)[glitchPos%sweepSize]!=0.5f || failure.nFrames!=sweepSize ||
+	   results.lastFailurePos!=failure.streamPos)
+	{
+		printf("mask test: the failed sweep wasn't found\n");
+		ok= false;
+	}
+
+	// 8 channels of 4096 sample sweeps
+	const uint32_t size= 4096, nChannels= 8, nRuns= 2000;
+	MaskTester tester;
+	tester.setup(&mask, nChannels, size, size);
+	for(unsigned k= 0; k<kernels.size(); k++)
+	{
+		if(!kernels[k].supported) continue;
+		tester.setKernel(kernels[k].func);
+		uint32_t count= 0;
+		double start= getTime();
+		for(uint32_t run= 0; run<nRuns; run++)
+			for(unsigned ch= 0; ch<nChannels; ch++)
+				count+= tester.test(ch, &data[ch*size], size-run%64, &data[(ch+nChannels)*size]);
+		double elapsed= getTime()-start;
+		printf("mask test kernel %-6s %8.1f Msamples/s%s\n", kernels[k].name, double(size)*nChannels*nRuns/elapsed/1e6,
+			   count==12345? " ": "");
+	}
+	return ok;
+}
+
+// bursts of pulses, many of them in each block, into a sequence acquisition
+bool benchmarkSegments()
+{
+	bool ok= true;
+	const float rate= 48000;
+	const uint32_t pulsePeriod= 100, sweepSize= 64, nSegments= 200, blockSize= 1024;
+	vector<float> pulses(48000);
+	for(uint32_t i= 0; i<pulses.size(); i++)
+		pulses[i]= (i%pulsePeriod>=50? 1: 0);
+	ScopeProcessor processor;
+	ScopeSettings settings;
+	settings.channels= 1;
+	settings.samplingRate= rate;
+	settings.displaySamples= sweepSize;
+	settings.trigger.enabled= true;
+	settings.trigger.mode= TriggerSettings::TM_NORMAL;
+	settings.trigger.level= 0.5;
+	settings.segments= nSegments;
+	processor.setSettings(settings);
+	SampleRingBuffer ringBuffer(1, 8192);
+	processor.setRingBuffer(&ringBuffer);
+	for(int sequence= 0; sequence<2; sequence++)
+	{
+		if(sequence)
+		{
+			// a new sequence starts where the input is now
+			settings.segmentArmCount++;
+			processor.setSettings(settings);
+		}
+		double start= getTime();
+		for(uint32_t pos= 0; pos<pulses.size(); pos+= blockSize)
+		{
+			uint32_t n= min(blockSize, uint32_t(pulses.size())-pos);
+			ringBuffer.writeChannel(0, &pulses[pos], n);
+			ringBuffer.commitWrite(n);
+			processor.processPending();
+		}
+		double elapsed= getTime()-start;
+		uint32_t count, capacity;
+		uint32_t segmentSequence= processor.getSegmentCount(count, capacity);
+		// every trigger event is caught, one pulse period apart, and the segments hold the samples around them
+		SweepCapture segment, first;
+		double time= 0, firstTime;
+		uint32_t missed= 0, wrong= 0;
+		processor.readSegment(segmentSequence, 0, first, firstTime);
+		for(uint32_t i= 0; i<count; i++)
+		{
+			processor.readSegment(segmentSequence, i, segment, time);
+			if(segment.streamPos!=first.streamPos+i*pulsePeriod || fabs(time-double(i*pulsePeriod)/rate)>1e-9) missed++;
+			for(uint32_t k= 0; k<sweepSize; k++)
+				if(segment.getChannel(0)[k]!=(k<50? 1: 0)) { wrong++; break; }
+		}
+		printf("%ssegments: %u of %u filled from %u trigger events per block, %u out of step, %u with wrong samples, last at %.3fms, %.2fms for 1s of input\n",
+			   sequence? "": "\n", count, capacity, blockSize/pulsePeriod, missed, wrong, time*1000, elapsed*1000);
+		if(count!=nSegments || capacity!=nSegments || missed || wrong || first.triggerStatus!=DisplayFrame::TS_TRIGGERED ||
+		   (sequence && first.streamPos<48000))
+			ok= false;
+	}
+	processor.setRingBuffer(0);
+	return ok;
+}
+
+int runBenchmarks()
+{
+	bool ok= true;
+	benchmarkDisplayRefresh();
+	benchmarkChannelScaling();
+	if(!benchmarkZoom()) ok= false;
+	if(!benchmarkPeakTracker()) ok= false;
+	if(!benchmarkTriggerSearch()) ok= false;
+	benchmarkTriggerEngine();
+	if(!benchmarkFileReplay()) ok= false;
+	if(!benchmarkFFT()) ok= false;
+	if(!benchmarkFilterBank()) ok= false;
+	if(!benchmarkSubSample()) ok= false;
+	if(!benchmarkPhosphor()) ok= false;
+	if(!benchmarkCorrelation()) ok= false;
+	if(!benchmarkMeasurements()) ok= false;
+	if(!benchmarkMaskTest()) ok= false;
+	if(!benchmarkSegments()) ok= false;
+	return ok? 0: 1;
+}
+
+// apply NAME=VALUE settings from the command line, on top of those read from the config file
+bool applySettingOverrides(configOptionHandler &handler, const vector<string> &overrides)
+{
+	for(size_t i= 0; i<overrides.size(); i++)
+	{
+		size_t eq= overrides[i].find('=');
+		if(eq==string::npos || !handler.readItem(overrides[i].substr(0, eq).c_str(), overrides[i].substr(eq+1).c_str()))
+		{
+			fprintf(stderr, "unknown setting: %s\n", overrides[i].c_str());
+			return false;
+		}
+	}
+	return true;
+}
+
+// options of the headless mode
+struct HeadlessOptions
+{
+	const char *captureDest;    // directory to write sweep captures to, "-" for stdout, 0 for none
+	const char *statsDest;      // file to append signal statistics to, "-" for stdout, 0 for none
+	double statsInterval;       // seconds
+	uint32_t maxCaptures;       // stop after this many captures, 0 for no limit
+	double duration;            // stop after this many seconds, 0 for no limit
+	const Mask *mask;           // test the sweeps against this mask, 0 for no mask test
+	const char *maskCaptureDest;    // directory to write the sweeps which fail the mask test to, "-" for stdout, 0 for none
+
+	HeadlessOptions(): captureDest(0), statsDest(0), statsInterval(1), maxCaptures(0), duration(0), mask(0), maskCaptureDest(0)
+	{ }
+};
+
+volatile sig_atomic_t gHeadlessQuit= 0;
+
+void headlessSignalHandler(int)
+{ gHeadlessQuit= 1; }
+
+// write a capture as CSV: the time relative to the trigger event, then one column per channel
+bool writeCapture(FILE *f, const SweepCapture &c, uint32_t index)
+{
+	static const char *statusText[]= { "waiting", "triggered", "auto", "stopped" };
+	fprintf(f, "# capture %u, stream position %llu, %u frames, %u channels, %.0f Hz, %s\n", index,
+			(unsigned long long)c.streamPos, c.nFrames, c.nChannels, c.samplingRate, statusText[c.triggerStatus]);
+	fprintf(f, "time");
+	for(unsigned ch= 0; ch<c.nChannels; ch++)
+		fprintf(f, ",input%02u", ch);
+	fputc('\n', f);
+	for(uint32_t i= 0; i<c.nFrames; i++)
+	{
+		fprintf(f, "%.7f", (double(i)-c.triggerOffset+c.triggerFraction)/c.samplingRate);
+		for(unsigned ch= 0; ch<c.nChannels; ch++)
+			fprintf(f, ",%.6f", c.getChannel(ch)[i]);
+		fputc('\n', f);
+	}
+	return !ferror(f);
+}
+
+bool saveCapture(const char *dest, const SweepCapture &c, uint32_t index)
+{
+	if(!strcmp(dest, "-"))
+	{
+		bool ok= writeCapture(stdout, c, index);
+		fputc('\n', stdout);
+		fflush(stdout);
+		return ok;
+	}
+	char filename[1024];
+	snprintf(filename, sizeof(filename), "%s/capture-%06u.csv", dest, index);
+	FILE *f= fopen(filename, "w");
+	if(!f) return false;
+	bool ok= writeCapture(f, c, index);
+	if(fclose(f)) ok= false;
+	return ok;
+}
+
+void writeSignalStats(FILE *f, double time, const vector<SignalStats> &stats, uint32_t sweeps, uint32_t dropped,
+					  const MaskResults *mask= 0)
+{
+	fprintf(f, "%.3f sweeps %u dropped %u", time, sweeps, dropped);
+	if(mask) fprintf(f, " mask sweeps %u failed %u", mask->sweeps, mask->failedSweeps);
+	for(size_t ch= 0; ch<stats.size(); ch++)
+		fprintf(f, " | input%02u min %.4f max %.4f mean %.4f rms %.4f", unsigned(ch),
+				stats[ch].min, stats[ch].max, stats[ch].mean(), stats[ch].rms());
+	fputc('\n', f);
+	fflush(f);
+}
+
+// write the sweeps which have failed the mask test so far. returns false if one couldn't be written.
+bool saveMaskFailures(const char *dest, CaptureQueue &failures, SweepCapture &capture, uint32_t &nFailures)
+{
+	bool ok= true;
+	while(failures.read(capture))
+	{
+		if(!saveCapture(dest, capture, nFailures++))
+		{
+			fprintf(stderr, "couldn't write mask failure to %s\n", dest);
+			ok= false;
+		}
+	}
+	return ok;
+}
+
+// run the processing engine without any GUI. the scope settings come from the config file, the command
+// line can override them. completed sweeps are written as captures and the signal statistics are written
+// at regular intervals, until the limits set in the options are reached, the input has ended or the
+// process is interrupted. with a mask, returns 2 if any sweep has failed the mask test.
+int runHeadless(const HeadlessOptions &options, InputSource &input, StreamRecorder *recorder, int nChannels,
+				const vector<string> &settingOverrides)
+{
+	ScopeProcessor processor;
+	ScopeControl control(processor);
+	CaptureQueue captures;
+
+	gConfigHandler.readFromFile(getConfigFilename().c_str());
+	if(!applySettingOverrides(control, settingOverrides)) return 1;
+	control.setNumChannels(nChannels? nChannels: control.getNumChannels());
+
+	FILE *statsFile= 0;
+	if(options.statsDest)
+	{
+		statsFile= (strcmp(options.statsDest, "-")? fopen(options.statsDest, "a"): stdout);
+		if(!statsFile)
+		{
+			fprintf(stderr, "couldn't open %s: %s\n", options.statsDest, strerror(errno));
+			return 1;
+		}
+		processor.enableSignalStats(true);
+	}
+	if(options.captureDest)
+		processor.setCaptureQueue(&captures);
+	CaptureQueue maskFailures;
+	if(options.mask)
+	{
+		processor.setMask(options.mask);
+		if(options.maskCaptureDest) processor.setMaskFailureQueue(&maskFailures);
+		control.enableMaskTest(true);
+	}
+
+	signal(SIGINT, headlessSignalHandler);
+	signal(SIGTERM, headlessSignalHandler);
+
+	input.initialize(control.getNumChannels());
+	double startTime= getTime(), lastInputTry= startTime, lastStatsTime= startTime;
+	control.setSamplingRate(input.getSamplingRate());
+	processor.setRingBuffer(input.getRingBuffer());
+	if(recorder && recorder->start(input.getSamplingRate(), control.getNumChannels()))
+		processor.addSampleSink(recorder);
+	processor.start();
+
+	SweepCapture capture;
+	vector<SignalStats> stats;
+	MaskResults maskResults;
+	uint32_t nCaptures= 0, nMaskFailures= 0, sweeps;
+	bool ok= true;
+	while(!gHeadlessQuit && ok)
+	{
+		SDL_Delay(10);
+		double time= getTime();
+		// once the input has ended, everything it delivered has been processed when the ring buffer is empty
+		SampleRingBuffer *ringBuffer= input.getRingBuffer();
+		bool inputDone= input.isFinished() && (!ringBuffer || !ringBuffer->getReadSpace());
+
+		while(options.captureDest && captures.read(capture))
+		{
+			if(!saveCapture(options.captureDest, capture, nCaptures++))
+			{
+				fprintf(stderr, "couldn't write capture to %s\n", options.captureDest);
+				ok= false;
+			}
+			if(options.maxCaptures && nCaptures>=options.maxCaptures) break;
+		}
+		if(options.maskCaptureDest && !saveMaskFailures(options.maskCaptureDest, maskFailures, capture, nMaskFailures))
+			ok= false;
+
+		if(statsFile && (time-lastStatsTime>=options.statsInterval || inputDone))
+		{
+			lastStatsTime= time;
+			processor.takeSignalStats(stats, sweeps);
+			processor.getMaskResults(maskResults);
+			writeSignalStats(statsFile, time-startTime, stats, sweeps, captures.getDroppedCount(), options.mask? &maskResults: 0);
+		}
+
+		if(!input.isRunning() && !input.isFinished() && time-lastInputTry>5.0)
+		{
+			lastInputTry= time;
+			processor.setRingBuffer(0);
+			input.initialize(control.getNumChannels());
+			processor.setRingBuffer(input.getRingBuffer());
+			control.setSamplingRate(input.getSamplingRate());
+		}
+
+		if(inputDone || (options.maxCaptures && nCaptures>=options.maxCaptures) ||
+		   (options.duration>0 && time-startTime>=options.duration))
+			break;
+	}
+
+	processor.stop();
+	processor.setRingBuffer(0);
+	if(recorder && recorder->isRecording())
+	{
+		processor.removeSampleSink(recorder);
+		recorder->stop();
+		if(recorder->getDroppedFrames())
+			fprintf(stderr, "recording: %u frames dropped\n", recorder->getDroppedFrames());
+		if(recorder->hasFailed()) ok= false;
+	}
+	input.shutdown();
+	if(statsFile && statsFile!=stdout) fclose(statsFile);
+	if(captures.getDroppedCount())
+		fprintf(stderr, "%u captures dropped\n", captures.getDroppedCount());
+	if(options.mask)
+	{
+		if(options.maskCaptureDest && !saveMaskFailures(options.maskCaptureDest, maskFailures, capture, nMaskFailures))
+			ok= false;
+		processor.getMaskResults(maskResults);
+		fprintf(stderr, "mask test: %u sweeps, %u failed", maskResults.sweeps, maskResults.failedSweeps);
+		for(size_t ch= 0; ch<maskResults.violations.size(); ch++)
+			fprintf(stderr, ", input%02u %llu samples outside", unsigned(ch), (unsigned long long)maskResults.violations[ch]);
+		fputc('\n', stderr);
+		if(maskFailures.getDroppedCount())
+			fprintf(stderr, "%u mask failures not written\n", maskFailures.getDroppedCount());
+		if(ok && maskResults.failedSweeps) return 2;
+	}
+	return ok? 0: 1;
+}
+
+int main(int argc, char* argv[])
+{
+	int nChannels= 0;
+	bool legacyGL= false, vsync= false, showStats= false, headless= false;
+	double maxFrameRate= 100;
+	const char *inputFile= 0;
+	double replaySpeed= 1;
+	bool loopInput= false;
+	int rawRate= 48000, rawChannels= 1;
+	const char *recordDir= 0;
+	vector<unsigned> recordChannels;
+	double rotateSize= 0, rotateTime= 0;
+	const char *historyDir= 0;
+	double historyLength= 0;
+	const char *maskFile= 0;
+	HeadlessOptions headlessOptions;
+	vector<string> settingOverrides;
+	for(int i= 1; i<argc; i++)
+	{
+		if(!strcmp(argv[i], "--benchmark"))
+			return runBenchmarks();
+		else if(!strcmp(argv[i], "--headless"))
+			headless= true;
+		else if(!strcmp(argv[i], "--capture") && i+1<argc)
+			headlessOptions.captureDest= argv[++i];
+		else if(!strcmp(argv[i], "--max-captures") && i+1<argc && atoi(argv[i+1])>0)
+			headlessOptions.maxCaptures= atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--signal-stats") && i+1<argc)
+			headlessOptions.statsDest= argv[++i];
+		else if(!strcmp(argv[i], "--stats-interval") && i+1<argc && atof(argv[i+1])>0)
+			headlessOptions.statsInterval= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--duration") && i+1<argc && atof(argv[i+1])>0)
+			headlessOptions.duration= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--set") && i+1<argc)
+			settingOverrides.push_back(argv[++i]);
+		else if(!strcmp(argv[i], "--channels") && i+1<argc && atoi(argv[i+1])>0)
+			nChannels= atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--input") && i+1<argc)
+			inputFile= argv[++i];
+		else if(!strcmp(argv[i], "--speed") && i+1<argc && atof(argv[i+1])>=0)
+			replaySpeed= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--loop"))
+			loopInput= true;
+		else if(!strcmp(argv[i], "--raw-rate") && i+1<argc && atoi(argv[i+1])>0)
+			rawRate= atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--raw-channels") && i+1<argc && atoi(argv[i+1])>0)
+			rawChannels= atoi(argv[++i]);
+		else if(!strcmp(argv[i], "--record") && i+1<argc)
+			recordDir= argv[++i];
+		else if(!strcmp(argv[i], "--record-channels") && i+1<argc)
+		{
+			istringstream list(argv[++i]);
+			string item;
+			while(getline(list, item, ','))
+				recordChannels.push_back(atoi(item.c_str()));
+		}
+		else if(!strcmp(argv[i], "--rotate-size") && i+1<argc && atof(argv[i+1])>0)
+			rotateSize= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--rotate-time") && i+1<argc && atof(argv[i+1])>0)
+			rotateTime= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--history") && i+1<argc)
+			historyDir= argv[++i];
+		else if(!strcmp(argv[i], "--history-length") && i+1<argc && atof(argv[i+1])>0)
+			historyLength= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--mask") && i+1<argc)
+			maskFile= argv[++i];
+		else if(!strcmp(argv[i], "--mask-captures") && i+1<argc)
+			headlessOptions.maskCaptureDest= argv[++i];
+		else if(!strcmp(argv[i], "--legacy-gl"))
+			legacyGL= true;
+		else if(!strcmp(argv[i], "--vsync"))
+			vsync= true;
+		else if(!strcmp(argv[i], "--max-fps") && i+1<argc && atof(argv[i+1])>0)
+			maxFrameRate= atof(argv[++i]);
+		else if(!strcmp(argv[i], "--stats"))
+			showStats= true;
+		else
+		{
+			printf("usage: %s [--benchmark] [--channels N] [--set NAME=VALUE]... [--legacy-gl] [--vsync] [--max-fps N] [--stats]\n"
+				   "                 [--history DIR [--history-length SECONDS]]\n"
+				   "       %s --headless [--channels N] [--set NAME=VALUE]... [--capture DIR|-] [--max-captures N]\n"
+				   "                 [--signal-stats FILE|-] [--stats-interval SECONDS] [--duration SECONDS]\n"
+				   "input from a file instead of jack, for both modes (speed 0 replays as fast as possible):\n"
+				   "       --input FILE.wav|FILE.raw [--speed FACTOR] [--loop] [--raw-rate HZ] [--raw-channels N]\n"
+				   "record the input to WAV files, for both modes:\n"
+				   "       --record DIR [--record-channels N,N,...] [--rotate-size MB] [--rotate-time SECONDS]\n"
+				   "test the sweeps against a mask, for both modes (headless exits with 2 if any sweep has failed):\n"
+				   "       --mask FILE [--mask-captures DIR|-]\n", argv[0], argv[0]);
+			return 1;
+		}
+	}
+
+	Mask mask;
+	if(maskFile)
+	{
+		if(!mask.load(maskFile)) return 1;
+		headlessOptions.mask= &mask;
+	}
+
+	JackInterface jackInput;
+	FileInputSource fileInput(inputFile? inputFile: "");
+	fileInput.setSpeed(replaySpeed);
+	fileInput.setLoop(loopInput);
+	fileInput.setRawFormat(rawRate, rawChannels);
+	InputSource &input= (inputFile? static_cast<InputSource&>(fileInput): jackInput);
+
+	StreamRecorder recorder;
+	recorder.setDirectory(recordDir? recordDir: "");
+	recorder.setChannels(recordChannels);
+	recorder.setRotation(uint64_t(rotateSize*1048576), rotateTime);
+
+	if(headless)
+		return runHeadless(headlessOptions, input, recordDir? &recorder: 0, nChannels, settingOverrides);
+
+	bool doQuit= false;
+	double time, lastTime= getTime(), lastInputTry, lastStatsTime= lastTime, lastEventTime= lastTime;
+	uint32_t lastOverflowCount= 0;
+	ScopeProcessor processor;
+	RenderScheduler scheduler(maxFrameRate);
+	processor.setScheduler(&scheduler);
+	if(!setVideoMode(800, 400, vsync)) exit(1);
+
+	fluxOscWindow oscWindow(processor, 0,0, 0,128, NOPARENT, ALIGN_LEFT|ALIGN_RIGHT|ALIGN_TOP|ALIGN_BOTTOM);
+	if(!gConfigHandler.readFromFile(getConfigFilename().c_str()))
+		printf("couldn't read config file %s\n", getConfigFilename().c_str());
+	applySettingOverrides(oscWindow, settingOverrides);
+	// the channel count from the command line overrides the config file
+	oscWindow.setNumChannels(nChannels? nChannels: oscWindow.getNumChannels());
+	oscWindow.enableShaderRendering(!legacyGL);
+	// the history is kept on disk, for browsing back further than the display time
+	HistoryStore history;
+	history.setDirectory(historyDir? historyDir: "");
+	history.setMaxLength(historyLength);
+	if(historyDir) oscWindow.setHistory(&history);
+	CaptureQueue maskFailures;
+	SweepCapture maskFailure;
+	uint32_t nMaskFailures= 0;
+	if(maskFile)
+	{
+		processor.setMask(&mask);
+		if(headlessOptions.maskCaptureDest) processor.setMaskFailureQueue(&maskFailures);
+		oscWindow.enableMaskTest(true);
+	}
+	fluxOscWindowConfigPane configPane(oscWindow, 0,0, 0,128, NOPARENT, ALIGN_BOTTOM|ALIGN_LEFT|ALIGN_RIGHT);
+	oscWindow.setConfigPane(&configPane);
+	input.initialize(oscWindow.getNumChannels());
+	lastInputTry= getTime();
+	oscWindow.setSamplingRate(input.getSamplingRate());
+	processor.setRingBuffer(input.getRingBuffer());
+	if(recordDir && recorder.start(input.getSamplingRate(), oscWindow.getNumChannels()))
+		processor.addSampleSink(&recorder);
+	if(historyDir && history.start(input.getSamplingRate(), oscWindow.getNumChannels()))
+		processor.addSampleSink(&history);
+	uint32_t lastRecordDrops= 0, lastHistoryDrops= 0;
+	bool recordFailed= false;
+	processor.start();
+
+	while(!doQuit)
+	{
+		// sleeps until there is a new display frame, or for the input poll interval. once there has been
+		// no input for a second, events are polled less often.
+		scheduler.wait(lastTime-lastEventTime>1.0? 0.05: 0.01);
+
+		time= getTime();
+		gTime+= time-lastTime;
+		lastTime= time;
+
+		SDL_Event ev;
+		while(SDL_PollEvent(&ev))
+		{
+			scheduler.markGuiDirty();
+			lastEventTime= time;
+			switch(ev.type)
+			{
+				case SDL_KEYDOWN:
+					if(ev.key.keysym.sym==SDLK_ESCAPE)
+						doQuit= true;
+					else
+						flux_keyboard_event(true, ev.key.keysym.scancode, ev.key.keysym.sym);
+					break;
+				case SDL_QUIT:
+					doQuit= true;
+					break;
+				case SDL_MOUSEBUTTONDOWN:
+					flux_mouse_button_event(SDLMouseButtonToFluxMouseButton(ev.button.button), ev.button.state);
+					break;
+				case SDL_MOUSEBUTTONUP:
+					flux_mouse_button_event(SDLMouseButtonToFluxMouseButton(ev.button.button), ev.button.state);
+					break;
+				case SDL_MOUSEMOTION:
+					flux_mouse_move_event(ev.motion.xrel, ev.motion.yrel);
+					break;
+				case SDL_VIDEORESIZE:
+					setVideoMode(ev.resize.w, ev.resize.h, vsync);
+					break;
+			}
+		}
+
+		if(SampleRingBuffer *ringBuffer= input.getRingBuffer())
+		{
+			if(ringBuffer->getOverflowCount()!=lastOverflowCount)
+			{
+				lastOverflowCount= ringBuffer->getOverflowCount();
+				printf("ring buffer overflow: %u periods (%u frames) dropped\n",
+					   lastOverflowCount, ringBuffer->getDroppedFrames());
+			}
+		}
+
+		if(recorder.isRecording())
+		{
+			if(recorder.getDroppedFrames()!=lastRecordDrops)
+			{
+				lastRecordDrops= recorder.getDroppedFrames();
+				printf("recording: %u frames dropped\n", lastRecordDrops);
+			}
+			if(recorder.hasFailed() && !recordFailed)
+			{
+				recordFailed= true;
+				printf("recording stopped\n");
+			}
+		}
+
+		if(history.getDroppedFrames()!=lastHistoryDrops)
+		{
+			lastHistoryDrops= history.getDroppedFrames();
+			printf("history: %u frames dropped\n", lastHistoryDrops);
+		}
+
+		if(headlessOptions.maskCaptureDest)
+			saveMaskFailures(headlessOptions.maskCaptureDest, maskFailures, maskFailure, nMaskFailures);
+
+		if(!input.isRunning() && !input.isFinished() && time-lastInputTry>5.0)
+		{
+			lastInputTry= time;
+			processor.setRingBuffer(0);
+			input.initialize(oscWindow.getNumChannels());
+			processor.setRingBuffer(input.getRingBuffer());
+			oscWindow.setSamplingRate(input.getSamplingRate());
+			lastOverflowCount= 0;
+		}
+
+		flux_tick();
+		if(scheduler.beginFrame())
+		{
+			flux_redraw();
+			SDL_GL_SwapBuffers();
+			scheduler.endFrame(processor.getDisplayFrame());
+		}
+
+		if(showStats && time-lastStatsTime>=1.0)
+		{
+			lastStatsTime= time;
+			RenderScheduler::printStats(scheduler.takeStats());
+		}
+	}
+
+	createConfigFile();
+	if(!gConfigHandler.writeToFile(getConfigFilename().c_str()))
+		printf("couldn't write to config file %s\n", getConfigFilename().c_str());
+
+	processor.stop();
+	processor.removeSampleSink(&recorder);
+	processor.removeSampleSink(&history);
+	recorder.stop();
+	history.stop();
+	input.shutdown();
+	flux_shutdown();
+	SDL_Quit();
+    return 0;
+}